@@ -7,12 +7,30 @@
 //============================================================================
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <assert.h>
 using namespace std;
 
 #include "filters/filter.h"
 #include "filters/rank_filter.h"
 #include "filters/moving_average_filter.h"
+#include "filters/filter_stats.h"
+#include "filters/filter_pipeline.h"
+#include "filters/exp_moving_average_filter.h"
+#include "filters/weighted_moving_average_filter.h"
+#include "filters/trimmed_mean_filter.h"
+#include "filters/hampel_filter.h"
+#include "filters/rolling_stats_filter.h"
+#include "filters/prefix_sum_index.h"
+#include "filters/wavelet_index.h"
+#include "filters/approx_rank_filter.h"
+#include "filters/sliding_dft_filter.h"
+#include "filters/resampler.h"
+#include "filters/spatial_filter.h"
+#include "filters/sort_network.h"
+#include "filters/filter_autotune.h"
 
 
 #define FILTER_ASSERT(status) 	if(status != FilterOK) {cout << "Error at: " << __FILE__ << " " << __LINE__ << "\r\n";}
@@ -94,6 +112,52 @@ static void test_moving_average_ring_buffer_fifo(void)
 
 
 
+static void test_moving_average_resync(void)
+{
+	FilterStatus_t 	status;
+	MovingAverageFilter_t average;
+
+	const uint32_t window_size = 3;
+	const uint32_t samples_buf_size = 16;
+	const uint16_t output_length = 14;
+
+	int16_t fifo_buffer[window_size];
+
+	int16_t samples_buf[samples_buf_size] = {5, 2, 1, 5, 10, 14, 32, 65, 13, 18, -10, -25, -30, 13, 1, 1};
+	int16_t filtered[output_length] = {2, 2, 5, 9, 18, 37, 36, 32, 7, -5, -21, -14, -5, 5};
+
+	int16_t sample;
+	uint32_t resync_count, resync_corrections;
+
+	status = moving_avg_init(&average, FilterLowPass, fifo_buffer, window_size);
+	FILTER_ASSERT(status);
+
+	moving_avg_set_resync(&average, 1);
+
+	status = moving_avg_fill_buffer(&average, samples_buf, &sample);
+	FILTER_ASSERT(status);
+
+	/* Corrupt running sum. It must be repaired after one window */
+	average.prev_acc += 1000;
+
+	for(uint16_t i=window_size; i<samples_buf_size; i++)
+	{
+		status = moving_avg_filter_sample(&average, samples_buf[i], &sample);
+		FILTER_ASSERT(status);
+
+		if(i >= 2*window_size - 1)
+		{
+			assert(filtered[i - window_size + 1] == sample);
+		}
+	}
+
+	moving_avg_get_resync_stats(&average, &resync_count, &resync_corrections);
+	assert(resync_count == (samples_buf_size - window_size) / window_size);
+	assert(resync_corrections == 1);
+}
+
+
+
 static void test_rank_filter_simple_buffer(void)
 {
 	FilterStatus_t 	status;
@@ -122,6 +186,41 @@ static void test_rank_filter_simple_buffer(void)
 }
 
 
+static void test_rank_filter_small_windows(void)
+{
+	FilterStatus_t 	status;
+
+	const uint16_t buf_size = 100;
+	int16_t buffer[buf_size];
+	int16_t out_data[buf_size];
+	uint16_t output_len;
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		buffer[i] = (int16_t)((i * 7919u) % 65536u);
+	}
+
+	for(uint16_t window_size=3; window_size<=9; window_size+=2)
+	for(uint16_t size=window_size; size<=buf_size; size+=13)
+	for(uint16_t rank=0; rank<window_size; rank++)
+	{
+		status = rank_filter_filter_sequence(buffer, size, window_size, rank, out_data, &output_len);
+		FILTER_ASSERT(status);
+		assert(output_len == size - window_size + 1);
+
+		for(unsigned int i=0; i<output_len; i++)
+		{
+			int16_t window[window_size];
+
+			std::copy(buffer + i, buffer + i + window_size, window);
+			std::sort(window, window + window_size);
+
+			assert(out_data[i] == window[rank]);
+		}
+	}
+}
+
+
 static void test_rank_filter_ring_buffer(void)
 {
 	FilterStatus_t 	status;
@@ -158,28 +257,2325 @@ static void test_rank_filter_ring_buffer(void)
 
 
 
-int main() {
-	cout << "Filters test" << endl; // prints !!!Hello World!!!
+static void test_rank_filter_multi_rank(void)
+{
+	FilterStatus_t 	status;
+	RankFilter_t multi_filter;
 
-	cout << "\n***Testing moving average filter***" << endl;
+	const uint32_t window_size = 5;
+	const uint32_t buf_size = 16;
+	const uint16_t ranks_num = 3;
+	const uint16_t ranks[ranks_num] = {0, 2, 4};
 
-	cout << "\nTesting moving average with simple buffer" << endl;
-	test_moving_average_simple_buffer();
-	cout << "Simple buffer successfully tested" << endl;
+	int16_t buffer[buf_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25, 30, -40, 50, 1};
+	int16_t fifo_buffer[window_size];
+	int16_t expected[ranks_num][buf_size];
+	int16_t samples[ranks_num];
+	uint16_t output_len;
 
-	cout << "\nTesting moving average with fifo" << endl;
-	test_moving_average_ring_buffer_fifo();
-	cout << "Ring buffer successfully tested" << endl;
+	for(uint16_t r=0; r<ranks_num; r++)
+	{
+		status = rank_filter_filter_sequence(buffer, buf_size, window_size, ranks[r], expected[r], &output_len);
+		FILTER_ASSERT(status);
+	}
 
-	cout << "\n***Testing rank filter***" << endl;
+	status = rank_filter_multi_init(&multi_filter, fifo_buffer, window_size, ranks, ranks_num);
+	FILTER_ASSERT(status);
 
-	cout << "\nTesting rank filter with simple buffer" << endl;
-	test_rank_filter_simple_buffer();
-	cout << "Successfully tested simple buffer" << endl;
+	status = rank_filter_multi_fill_buffer(&multi_filter, buffer, samples);
+	FILTER_ASSERT(status);
 
-	cout << "\nTesting rank filter with ring buffer" << endl;
-	test_rank_filter_ring_buffer();
-	cout << "Successfully tested ring buffer" << endl;
+	for(uint16_t r=0; r<ranks_num; r++)
+	{
+		assert(samples[r] == expected[r][0]);
+	}
+
+	for(unsigned int i=window_size; i<buf_size; i++)
+	{
+		status = rank_filter_multi_filter_sample(&multi_filter, buffer[i], samples);
+		FILTER_ASSERT(status);
+
+		for(uint16_t r=0; r<ranks_num; r++)
+		{
+			assert(samples[r] == expected[r][i - window_size + 1]);
+		}
+	}
+}
+
+
+
+static void test_filter_warmup(void)
+{
+	FilterStatus_t 	status;
+	MovingAverageFilter_t average;
+	RankFilter_t median;
+
+	const uint32_t window_size = 5;
+	const uint32_t buf_size = 16;
+
+	int16_t buffer[buf_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25, 30, -40, 50, 1};
+	int16_t avg_fifo[window_size];
+	int16_t rank_fifo[window_size];
+	int16_t avg_expected[buf_size];
+	int16_t rank_expected[buf_size];
+	int16_t output[buf_size];
+	int16_t sample;
+	uint16_t output_len;
+
+	status = moving_avg_filter_sequence(buffer, buf_size, window_size, avg_expected + window_size - 1, &output_len);
+	FILTER_ASSERT(status);
+
+	status = rank_filter_filter_sequence(buffer, buf_size, window_size, window_size/2, rank_expected + window_size - 1, &output_len);
+	FILTER_ASSERT(status);
+
+	/* Partial windows: average of collected samples, proportional rank */
+	for(uint32_t i=0; i<window_size-1; i++)
+	{
+		int32_t sum = 0;
+		int16_t sorted[window_size];
+
+		for(uint32_t j=0; j<=i; j++)
+		{
+			sum += buffer[j];
+			sorted[j] = buffer[j];
+		}
+
+		sort(sorted, sorted + i + 1);
+		avg_expected[i] = sum / (int32_t)(i + 1);
+		rank_expected[i] = sorted[(window_size/2) * i / (window_size - 1)];
+	}
+
+	status = moving_avg_init(&average, FilterLowPass, avg_fifo, window_size);
+	FILTER_ASSERT(status);
+
+	status = rank_filter_init(&median, rank_fifo, window_size, window_size/2);
+	FILTER_ASSERT(status);
+
+	assert(moving_avg_filter_sample(&average, buffer[0], &sample) == FilterError);
+	moving_avg_flush(&average);
+
+	moving_avg_set_warmup(&average, 1);
+	rank_filter_set_warmup(&median, 1);
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		status = moving_avg_filter_sample(&average, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(sample == avg_expected[i]);
+
+		status = rank_filter_filter_sample(&median, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(sample == rank_expected[i]);
+	}
+
+	/* Block API emits warm-up outputs too */
+	moving_avg_flush(&average);
+	rank_filter_flush(&median);
+
+	status = moving_avg_filter_block(&average, buffer, buf_size, output, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == buf_size);
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		assert(output[i] == avg_expected[i]);
+	}
+
+	status = rank_filter_filter_block(&median, buffer, buf_size, output, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == buf_size);
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		assert(output[i] == rank_expected[i]);
+	}
+}
+
+
+
+static void test_filter_resize(void)
+{
+	FilterStatus_t 	status;
+	MovingAverageFilter_t average;
+	RankFilter_t rank_filter;
+
+	const uint32_t capacity = 8;
+	const uint32_t buf_size = 24;
+
+	int16_t buffer[buf_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25,
+			30, -40, 50, 1, 7, 7, -3, 18, 90, -60, 4, 2};
+	int16_t avg_fifo[capacity];
+	int16_t rank_fifo[capacity];
+	int16_t sample;
+
+	uint16_t window_size = 3;
+	uint16_t rank = 1;
+	uint16_t count = 0;
+
+	status = moving_avg_init_capacity(&average, FilterLowPass, avg_fifo, capacity, window_size);
+	FILTER_ASSERT(status);
+
+	status = rank_filter_init_capacity(&rank_filter, rank_fifo, capacity, window_size, rank);
+	FILTER_ASSERT(status);
+
+	assert(moving_avg_resize(&average, capacity + 1) == FilterError);
+	assert(rank_filter_resize(&rank_filter, capacity + 1) == FilterError);
+	assert(rank_filter_set_rank(&rank_filter, window_size) == FilterError);
+
+	moving_avg_set_warmup(&average, 1);
+	rank_filter_set_warmup(&rank_filter, 1);
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		if(i == 6)
+		{
+			/* Grow: outputs are computed over collected samples until the window is full */
+			window_size = 6;
+			rank = 4;
+		}
+		else if(i == 12)
+		{
+			/* Shrink: the oldest samples are dropped */
+			window_size = 4;
+			rank = 2;
+		}
+		else if(i == 18)
+		{
+			window_size = 8;
+			rank = 0;
+		}
+
+		if(i == 6 || i == 12 || i == 18)
+		{
+			status = moving_avg_resize(&average, window_size);
+			FILTER_ASSERT(status);
+
+			/* Rank must fit into the window at any moment */
+			if(window_size < rank_filter.window_size)
+			{
+				status = rank_filter_set_rank(&rank_filter, rank);
+				FILTER_ASSERT(status);
+
+				status = rank_filter_resize(&rank_filter, window_size);
+				FILTER_ASSERT(status);
+			}
+			else
+			{
+				status = rank_filter_resize(&rank_filter, window_size);
+				FILTER_ASSERT(status);
+
+				status = rank_filter_set_rank(&rank_filter, rank);
+				FILTER_ASSERT(status);
+			}
+
+			count = min(count, window_size);
+		}
+
+		count = min((uint16_t)(count + 1), window_size);
+
+		int32_t sum = 0;
+		int16_t sorted[capacity];
+
+		for(uint32_t j=0; j<count; j++)
+		{
+			sum += buffer[i - j];
+			sorted[j] = buffer[i - j];
+		}
+
+		sort(sorted, sorted + count);
+		uint16_t current_rank = (count < window_size) ? rank * (count - 1) / (window_size - 1) : rank;
+
+		status = moving_avg_filter_sample(&average, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(sample == sum / (int32_t)count);
+
+		status = rank_filter_filter_sample(&rank_filter, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(sample == sorted[current_rank]);
+	}
+}
+
+
+
+static void test_trimmed_mean(void)
+{
+	FilterStatus_t 	status;
+	TrimmedMeanFilter_t trimmed;
+
+	const uint32_t max_window_size = 9;
+	const uint32_t buf_size = 64;
+
+	int16_t buffer[buf_size];
+	int16_t fifo_buffer[max_window_size];
+	int16_t output[buf_size];
+	int16_t block_output[buf_size];
+	int16_t sample;
+	uint16_t output_len, block_len;
+
+	/* Narrow range to get many equal samples */
+	srand(5);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		buffer[i] = (rand() % 21) - 10;
+	}
+
+	for(uint16_t window_size=1; window_size<=max_window_size; window_size++)
+	{
+		assert(trimmed_mean_init(&trimmed, fifo_buffer, window_size, (window_size + 1) / 2) == FilterError);
+
+		for(uint16_t trim=0; 2*trim<window_size; trim++)
+		{
+			status = trimmed_mean_filter_sequence(buffer, buf_size, window_size, trim, output, &output_len);
+			FILTER_ASSERT(status);
+			assert(output_len == buf_size - window_size + 1);
+
+			for(uint32_t i=0; i<output_len; i++)
+			{
+				int16_t sorted[max_window_size];
+				int32_t sum = 0;
+
+				memcpy(sorted, buffer + i, window_size * sizeof *buffer);
+				sort(sorted, sorted + window_size);
+
+				for(uint16_t r=trim; r<window_size-trim; r++)
+				{
+					sum += sorted[r];
+				}
+
+				assert(output[i] == sum / (int32_t)(window_size - 2*trim));
+			}
+
+			status = trimmed_mean_init(&trimmed, fifo_buffer, window_size, trim);
+			FILTER_ASSERT(status);
+
+			status = trimmed_mean_fill_buffer(&trimmed, buffer, &sample);
+			FILTER_ASSERT(status);
+			assert(sample == output[0]);
+
+			for(uint32_t i=window_size; i<buf_size; i++)
+			{
+				status = trimmed_mean_filter_sample(&trimmed, buffer[i], &sample);
+				FILTER_ASSERT(status);
+				assert(sample == output[i - window_size + 1]);
+			}
+
+			trimmed_mean_flush(&trimmed);
+
+			status = trimmed_mean_filter_block(&trimmed, buffer, buf_size, block_output, &block_len);
+			FILTER_ASSERT(status);
+			assert(block_len == output_len);
+			assert(memcmp(block_output, output, output_len * sizeof *output) == 0);
+		}
+	}
+}
+
+
+
+static void test_hampel(void)
+{
+	FilterStatus_t 	status;
+	HampelFilter_t hampel;
+
+	const uint32_t max_window_size = 11;
+	const uint32_t buf_size = 96;
+	const uint16_t threshold = HAMPEL_DEFAULT_THRESHOLD_Q8;
+
+	int16_t buffer[buf_size];
+	int16_t fifo_buffer[max_window_size];
+	int16_t output[buf_size];
+	int16_t block_output[buf_size];
+	uint8_t flags[(buf_size + 7) / 8];
+	uint8_t block_flags[(buf_size + 7) / 8];
+	int16_t sample;
+	uint8_t outlier;
+	uint16_t output_len, block_len;
+
+	/* Noise with spikes */
+	srand(7);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		buffer[i] = 100 + (rand() % 9) - 4;
+
+		if(rand() % 10 == 0)
+		{
+			buffer[i] += (rand() % 2) ? 3000 : -3000;
+		}
+	}
+
+	for(uint16_t window_size=1; window_size<=max_window_size; window_size++)
+	{
+		uint32_t outliers_num = 0;
+
+		status = hampel_filter_sequence(buffer, buf_size, window_size, threshold, output, flags, &output_len);
+		FILTER_ASSERT(status);
+		assert(output_len == buf_size - window_size + 1);
+
+		for(uint32_t i=0; i<output_len; i++)
+		{
+			int16_t sorted[max_window_size];
+			int32_t deviations[max_window_size];
+			uint16_t m = (window_size - 1) / 2;
+
+			memcpy(sorted, buffer + i, window_size * sizeof *buffer);
+			sort(sorted, sorted + window_size);
+
+			for(uint16_t j=0; j<window_size; j++)
+			{
+				deviations[j] = abs(sorted[j] - sorted[m]);
+			}
+
+			sort(deviations, deviations + window_size);
+
+			int16_t middle = buffer[i + m];
+			bool expected_outlier = ((int64_t)abs(middle - sorted[m]) << 16) >
+					(int64_t)threshold * HAMPEL_MAD_SCALE_Q8 * deviations[m];
+
+			assert(((flags[i / 8] >> (i % 8)) & 1) == expected_outlier);
+			assert(output[i] == (expected_outlier ? sorted[m] : middle));
+
+			outliers_num += expected_outlier;
+		}
+
+		if(window_size >= 5)
+		{
+			assert(outliers_num > 0);
+		}
+
+		status = hampel_init(&hampel, fifo_buffer, window_size, threshold);
+		FILTER_ASSERT(status);
+
+		status = hampel_fill_buffer(&hampel, buffer, &sample, &outlier);
+		FILTER_ASSERT(status);
+		assert(sample == output[0] && outlier == (flags[0] & 1));
+
+		for(uint32_t i=window_size; i<buf_size; i++)
+		{
+			uint32_t id = i - window_size + 1;
+
+			status = hampel_filter_sample(&hampel, buffer[i], &sample, &outlier);
+			FILTER_ASSERT(status);
+			assert(sample == output[id] && outlier == ((flags[id / 8] >> (id % 8)) & 1));
+		}
+
+		/* Blocks of odd size */
+		hampel_flush(&hampel);
+		memset(block_flags, 0xFF, sizeof block_flags);
+
+		uint32_t produced = 0;
+		for(uint32_t i=0; i<buf_size; i+=7)
+		{
+			uint8_t part_flags[2];
+			uint16_t len = (buf_size - i < 7) ? buf_size - i : 7;
+
+			status = hampel_filter_block(&hampel, buffer + i, len, block_output + produced, part_flags, &block_len);
+			FILTER_ASSERT(status);
+
+			for(uint16_t j=0; j<block_len; j++, produced++)
+			{
+				uint8_t flag = (part_flags[j / 8] >> (j % 8)) & 1;
+				assert(flag == ((flags[produced / 8] >> (produced % 8)) & 1));
+			}
+		}
+
+		assert(produced == output_len);
+		assert(memcmp(block_output, output, output_len * sizeof *output) == 0);
+	}
+}
+
+
+
+static bool rolling_stats_equal(const RollingStatsOutput_t *a, const RollingStatsOutput_t *b, uint32_t len)
+{
+	for(uint32_t i=0; i<len; i++)
+	{
+		if(a[i].mean != b[i].mean || a[i].variance != b[i].variance || a[i].min != b[i].min || a[i].max != b[i].max)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void test_rolling_stats(void)
+{
+	FilterStatus_t 	status;
+	RollingStatsFilter_t stats;
+
+	const uint32_t max_window_size = 33;
+	const uint32_t buf_size = 200;
+
+	int16_t buffer[buf_size];
+	int16_t fifo_buffer[max_window_size];
+	RollingStatsOutput_t output[buf_size];
+	RollingStatsOutput_t block_output[buf_size];
+	RollingStatsOutput_t item;
+	uint16_t output_len, block_len;
+
+	srand(17);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		/* Full range samples with runs to exercise both deques */
+		buffer[i] = (i % 40 < 20) ? (int16_t)(rand() & 0xFFFF) : (int16_t)(1000 - i);
+	}
+
+	for(uint16_t window_size=1; window_size<=max_window_size; window_size+=4)
+	{
+		status = rolling_stats_filter_sequence(buffer, buf_size, window_size, output, &output_len);
+		FILTER_ASSERT(status);
+		assert(output_len == buf_size - window_size + 1);
+
+		for(uint32_t i=0; i<output_len; i++)
+		{
+			int64_t sum = 0, sum_squares = 0;
+			int16_t min = INT16_MAX, max = INT16_MIN;
+
+			for(uint16_t j=0; j<window_size; j++)
+			{
+				int16_t x = buffer[i + j];
+
+				sum += x;
+				sum_squares += (int64_t)x * x;
+				min = std::min(min, x);
+				max = std::max(max, x);
+			}
+
+			assert(output[i].mean == sum / window_size);
+			assert(output[i].variance == (uint32_t)((window_size * sum_squares - sum * sum) /
+					((int64_t)window_size * window_size)));
+			assert(output[i].min == min && output[i].max == max);
+		}
+
+		status = rolling_stats_init(&stats, fifo_buffer, window_size);
+		FILTER_ASSERT(status);
+
+		status = rolling_stats_fill_buffer(&stats, buffer, &item);
+		FILTER_ASSERT(status);
+		assert(rolling_stats_equal(&item, &output[0], 1));
+
+		for(uint32_t i=window_size; i<buf_size; i++)
+		{
+			status = rolling_stats_filter_sample(&stats, buffer[i], &item);
+			FILTER_ASSERT(status);
+			assert(rolling_stats_equal(&item, &output[i - window_size + 1], 1));
+		}
+
+		/* Block API collects the first window itself and keeps state between calls */
+		rolling_stats_flush(&stats);
+
+		uint16_t produced = 0;
+		for(uint32_t offset=0; offset<buf_size; offset+=7)
+		{
+			uint16_t len = std::min<uint32_t>(7, buf_size - offset);
+
+			status = rolling_stats_filter_block(&stats, buffer + offset, len, block_output + produced, &block_len);
+			FILTER_ASSERT(status);
+			produced += block_len;
+		}
+
+		assert(produced == output_len);
+		assert(rolling_stats_equal(block_output, output, output_len));
+
+		rolling_stats_deinit(&stats);
+	}
+}
+
+
+
+static void test_prefix_sum_index(void)
+{
+	FilterStatus_t 	status;
+	PrefixSumIndex_t index;
+
+	const uint32_t buf_size = 1000;
+	const uint32_t queries_num = 300;
+
+	static int16_t buffer[buf_size];
+	static int64_t prefix[buf_size + 1];
+	int16_t output[buf_size];
+	int16_t expected[buf_size];
+	uint32_t begins[queries_num], ends[queries_num];
+	int16_t means[queries_num];
+	uint32_t output_len;
+	uint16_t expected_len;
+
+	srand(23);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		buffer[i] = (int16_t)(rand() & 0xFFFF);
+	}
+
+	for(uint32_t q=0; q<queries_num; q++)
+	{
+		begins[q] = rand() % buf_size;
+		ends[q] = begins[q] + 1 + rand() % (buf_size - begins[q]);
+	}
+
+	for(uint8_t block_shift=0; block_shift<=4; block_shift+=2)
+	{
+		assert(prefix_sum_index_get_storage_len(buf_size, block_shift) <= buf_size + 1);
+
+		status = prefix_sum_index_build(&index, buffer, buf_size, block_shift, prefix);
+		FILTER_ASSERT(status);
+
+		status = prefix_sum_index_range_means(&index, begins, ends, queries_num, means);
+		FILTER_ASSERT(status);
+
+		for(uint32_t q=0; q<queries_num; q++)
+		{
+			int64_t sum = 0;
+			int16_t mean;
+
+			for(uint32_t i=begins[q]; i<ends[q]; i++)
+			{
+				sum += buffer[i];
+			}
+
+			assert(means[q] == sum / (int64_t)(ends[q] - begins[q]));
+
+			status = prefix_sum_index_range_mean(&index, begins[q], ends[q], &mean);
+			FILTER_ASSERT(status);
+			assert(mean == means[q]);
+		}
+
+		/* Odd windows match moving average filter */
+		for(uint32_t window_size=1; window_size<=101; window_size+=10)
+		{
+			status = prefix_sum_index_moving_avg(&index, window_size, output, &output_len);
+			FILTER_ASSERT(status);
+
+			status = moving_avg_filter_sequence(buffer, buf_size, window_size, expected, &expected_len);
+			FILTER_ASSERT(status);
+
+			assert(output_len == expected_len);
+			assert(memcmp(output, expected, output_len * sizeof *output) == 0);
+		}
+
+		assert(prefix_sum_index_range_mean(&index, 5, 5, means) == FilterError);
+		assert(prefix_sum_index_range_mean(&index, 0, buf_size + 1, means) == FilterError);
+		assert(prefix_sum_index_moving_avg(&index, buf_size + 1, output, &output_len) == FilterError);
+	}
+}
+
+
+
+static void test_wavelet_index(void)
+{
+	FilterStatus_t 	status;
+	WaveletIndex_t index, attached;
+
+	const uint32_t buf_size = 3000;
+	const uint32_t queries_num = 400;
+
+	static int16_t buffer[buf_size];
+	static int16_t sorted[buf_size];
+	int16_t sample, attached_sample;
+
+	srand(29);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		/* Full range with repeated values */
+		buffer[i] = (i % 3 == 0) ? (int16_t)(rand() & 0xFFFF) : (int16_t)(rand() % 50 - 25);
+	}
+
+	uint32_t blob_size = wavelet_index_get_blob_size(buf_size);
+	uint64_t *blob = (uint64_t*)malloc(blob_size);
+	uint64_t *blob_copy = (uint64_t*)malloc(blob_size);
+
+	status = wavelet_index_build(&index, buffer, buf_size, blob, blob_size);
+	FILTER_ASSERT(status);
+
+	/* Copy of blob stands for memory mapped file */
+	memcpy(blob_copy, blob, blob_size);
+	status = wavelet_index_attach(&attached, blob_copy, blob_size);
+	FILTER_ASSERT(status);
+
+	for(uint32_t q=0; q<queries_num; q++)
+	{
+		uint32_t begin = rand() % buf_size;
+		uint32_t end = begin + 1 + rand() % (buf_size - begin);
+		uint32_t len = end - begin;
+		uint32_t k = (q % 4 == 0) ? (len - 1) / 2 : rand() % len;
+
+		memcpy(sorted, buffer + begin, len * sizeof *buffer);
+		nth_element(sorted, sorted + k, sorted + len);
+
+		status = wavelet_index_range_quantile(&index, begin, end, k, &sample);
+		FILTER_ASSERT(status);
+		assert(sample == sorted[k]);
+
+		status = wavelet_index_range_quantile(&attached, begin, end, k, &attached_sample);
+		FILTER_ASSERT(status);
+		assert(attached_sample == sample);
+	}
+
+	assert(wavelet_index_range_quantile(&index, 10, 10, 0, &sample) == FilterError);
+	assert(wavelet_index_range_quantile(&index, 10, 20, 10, &sample) == FilterError);
+	assert(wavelet_index_attach(&attached, blob_copy, blob_size - 8) == FilterError);
+
+	blob_copy[0] ^= 1;
+	assert(wavelet_index_attach(&attached, blob_copy, blob_size) == FilterError);
+
+	free(blob);
+	free(blob_copy);
+}
+
+
+
+static void test_moving_avg_multi_window(void)
+{
+	FilterStatus_t 	status;
+	MovingAverageMultiWindow_t multi;
+
+	const uint16_t window_sizes[] = {1, 4, 7, 16, 33, 2};
+	const uint16_t windows_num = sizeof window_sizes / sizeof window_sizes[0];
+	const uint16_t max_window = 33;
+	const uint16_t buf_size = 1300;
+
+	static int16_t buffer[buf_size];
+	static int16_t outputs[windows_num][buf_size];
+	static int16_t frames[buf_size * windows_num];
+	int16_t fifo_buffer[max_window];
+	int16_t *y[windows_num];
+	uint16_t y_lens[windows_num];
+	uint16_t frames_num;
+
+	srand(31);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		buffer[i] = (int16_t)(rand() & 0xFFFF);
+	}
+
+	for(uint16_t k=0; k<windows_num; k++)
+	{
+		y[k] = outputs[k];
+	}
+
+	status = moving_avg_multi_window_filter_sequence(buffer, buf_size, window_sizes, windows_num, y, y_lens);
+	FILTER_ASSERT(status);
+
+	for(uint16_t k=0; k<windows_num; k++)
+	{
+		assert(y_lens[k] == buf_size - window_sizes[k] + 1);
+
+		for(uint32_t i=0; i<y_lens[k]; i++)
+		{
+			int32_t sum = 0;
+
+			for(uint16_t j=0; j<window_sizes[k]; j++)
+			{
+				sum += buffer[i + j];
+			}
+
+			assert(outputs[k][i] == sum / window_sizes[k]);
+		}
+	}
+
+	/* Windows longer than one tile */
+	{
+		const uint16_t long_windows[] = {513, 1300, 600};
+		int64_t prefix[buf_size + 1] = {0};
+
+		for(uint32_t i=0; i<buf_size; i++)
+		{
+			prefix[i + 1] = prefix[i] + buffer[i];
+		}
+
+		status = moving_avg_multi_window_filter_sequence(buffer, buf_size, long_windows, 3, y, y_lens);
+		FILTER_ASSERT(status);
+
+		for(uint16_t k=0; k<3; k++)
+		{
+			assert(y_lens[k] == buf_size - long_windows[k] + 1);
+
+			for(uint32_t i=0; i<y_lens[k]; i++)
+			{
+				assert(outputs[k][i] == (prefix[i + long_windows[k]] - prefix[i]) / long_windows[k]);
+			}
+		}
+
+		/* Restore outputs of short windows for streaming check */
+		status = moving_avg_multi_window_filter_sequence(buffer, buf_size, window_sizes, windows_num, y, y_lens);
+		FILTER_ASSERT(status);
+	}
+
+	/* Streaming frames hold averages of all windows ending at the same sample */
+	status = moving_avg_multi_window_init(&multi, fifo_buffer, window_sizes, windows_num);
+	FILTER_ASSERT(status);
+
+	uint16_t produced = 0;
+	for(uint32_t offset=0; offset<buf_size; offset+=100)
+	{
+		status = moving_avg_multi_window_filter_block(&multi, buffer + offset, 100,
+				frames + produced * windows_num, &frames_num);
+		FILTER_ASSERT(status);
+		produced += frames_num;
+	}
+
+	assert(produced == buf_size - max_window + 1);
+
+	for(uint32_t f=0; f<produced; f++)
+	{
+		uint32_t end = f + max_window - 1;
+
+		for(uint16_t k=0; k<windows_num; k++)
+		{
+			assert(frames[f * windows_num + k] == outputs[k][end + 1 - window_sizes[k]]);
+		}
+	}
+
+	const uint16_t bad_windows[] = {3, 0};
+	assert(moving_avg_multi_window_init(&multi, fifo_buffer, bad_windows, 2) == FilterError);
+	assert(moving_avg_multi_window_filter_sequence(buffer, 20, window_sizes, windows_num, y, y_lens) == FilterError);
+}
+
+
+
+static void test_approx_rank_filter(void)
+{
+	FilterStatus_t 	status;
+	ApproxRankFilter_t approx;
+
+	/* Small windows take less memory in exact RankFilter_t */
+	assert(approx_rank_filter_init(&approx, 15, 7, 1) == FilterError);
+	assert(approx_rank_filter_init(&approx, 50000, 25000, 20) == FilterError);
+	assert(approx_rank_filter_get_memory_size(50000, 20) >= 2 * 50000 * sizeof(int16_t));
+
+	/* Memory grows with window through the current block of error * window_size / 2 samples */
+	assert(approx_rank_filter_get_memory_size(10000000, 20) - approx_rank_filter_get_memory_size(1000000, 20) >=
+			(10000000 - 1000000) / 100 * sizeof(int16_t));
+
+	/* Summaries of 4 / error^2 samples dominate at small error */
+	assert(approx_rank_filter_get_memory_size(100000000, 1) > 4000000 * sizeof(int16_t));
+
+	/* Large window, output rank must be within error bound */
+	{
+		const uint32_t window_size = 200000;
+		const uint32_t data_size = 600000;
+		const uint16_t error_permille = 20;
+		const uint32_t rank = window_size / 2;
+
+		int16_t *data = (int16_t*)malloc(data_size * sizeof *data);
+		int32_t level = 0;
+
+		assert(approx_rank_filter_get_memory_size(window_size, error_permille) < window_size * sizeof *data);
+
+		srand(41);
+		for(uint32_t i=0; i<data_size; i++)
+		{
+			level += rand() % 21 - 10;
+			level = std::max(-20000, std::min(20000, level));
+			data[i] = level + rand() % 2001 - 1000;
+		}
+
+		status = approx_rank_filter_init(&approx, window_size, rank, error_permille);
+		FILTER_ASSERT(status);
+
+		/* Block point error is added to the bound */
+		const uint32_t max_error = window_size * error_permille / 1000 +
+				approx.block_size / approx.summary_len + 1;
+
+		for(uint32_t i=0; i<data_size; i++)
+		{
+			int16_t sample;
+
+			status = approx_rank_filter_filter_sample(&approx, data[i], &sample);
+			FILTER_ASSERT(status);
+
+			if(i + 1 >= window_size && i % 5000 == 0)
+			{
+				uint32_t less = 0, less_equal = 0;
+
+				for(uint32_t j=i+1-window_size; j<=i; j++)
+				{
+					less += data[j] < sample;
+					less_equal += data[j] <= sample;
+				}
+
+				assert(less <= rank + max_error);
+				assert(less_equal + max_error > rank);
+			}
+		}
+
+		approx_rank_filter_deinit(&approx);
+		free(data);
+	}
+
+	assert(approx_rank_filter_init(&approx, 100, 100, 10) == FilterError);
+	assert(approx_rank_filter_init(&approx, 100, 50, 0) == FilterError);
+}
+
+
+
+static void sliding_dft_direct(const int16_t *frames, uint32_t last, uint16_t window_size, uint16_t channels,
+		uint16_t channel, uint16_t bin, double *re, double *im)
+{
+	*re = 0;
+	*im = 0;
+
+	for(uint32_t i=0; i<window_size; i++)
+	{
+		double x = frames[(last + 1 - window_size + i) * channels + channel];
+		double angle = 2.0 * FILTER_PI * bin * i / window_size;
+
+		*re += x * cos(angle);
+		*im -= x * sin(angle);
+	}
+}
+
+
+static void test_sliding_dft(void)
+{
+	FilterStatus_t 	status;
+	SlidingDftFilter_t sdft;
+
+	const uint16_t window_size = 64;
+	const uint16_t channels = 3;
+	const uint16_t frames_num = 500;
+	const uint16_t bins[] = {0, 1, 5, 63};
+	const uint16_t bins_num = sizeof bins / sizeof *bins;
+	const int16_t amplitude = 10000;
+
+	int16_t buffer[window_size * channels];
+	int16_t frames[frames_num * channels];
+
+	srand(43);
+	for(uint32_t i=0; i<frames_num * channels; i++)
+	{
+		frames[i] = rand() % (2 * amplitude + 1) - amplitude;
+	}
+
+	/* Fixed point block against direct DFT, twiddle rounding bounds the error */
+	{
+		SlidingDftBin_t *output = (SlidingDftBin_t*)malloc(frames_num * bins_num * channels * sizeof *output);
+		uint16_t output_len;
+
+		const double tolerance = 2.0 * window_size * amplitude / 32767 + 2;
+
+		status = sliding_dft_init(&sdft, SlidingDftFixed, buffer, window_size, channels, bins, bins_num);
+		FILTER_ASSERT(status);
+
+		status = sliding_dft_filter_block(&sdft, frames, frames_num, output, &output_len);
+		FILTER_ASSERT(status);
+		assert(output_len == filter_windowed_get_expected_output_len(frames_num, window_size));
+
+		for(uint32_t n=0; n<output_len; n++)
+		{
+			for(uint16_t b=0; b<bins_num; b++)
+			{
+				for(uint16_t ch=0; ch<channels; ch++)
+				{
+					double re, im;
+					const SlidingDftBin_t *y = &output[(n * bins_num + b) * channels + ch];
+
+					sliding_dft_direct(frames, n + window_size - 1, window_size, channels, ch, bins[b], &re, &im);
+					assert(fabs(y->re - re) <= tolerance && fabs(y->im - im) <= tolerance);
+				}
+			}
+		}
+
+		/* Channels are independent, the middle one alone gives the same bins */
+		SlidingDftFilter_t single;
+		int16_t single_buffer[window_size];
+		uint8_t ready;
+
+		status = sliding_dft_init(&single, SlidingDftFixed, single_buffer, window_size, 1, bins, bins_num);
+		FILTER_ASSERT(status);
+
+		for(uint32_t i=0; i<frames_num; i++)
+		{
+			SlidingDftBin_t y[bins_num];
+
+			status = sliding_dft_filter_sample(&single, &frames[i * channels + 1], y, &ready);
+			FILTER_ASSERT(status);
+			assert(ready == (i + 1 >= window_size));
+
+			for(uint16_t b=0; ready && b<bins_num; b++)
+			{
+				const SlidingDftBin_t *expected = &output[((i + 1 - window_size) * bins_num + b) * channels + 1];
+				assert(y[b].re == expected->re && y[b].im == expected->im);
+			}
+		}
+
+		/* Flush restarts window collection */
+		sliding_dft_flush(&sdft);
+
+		status = sliding_dft_filter_block(&sdft, frames, window_size - 1, output, &output_len);
+		FILTER_ASSERT(status);
+		assert(output_len == 0);
+
+		/* Wrong variant of API */
+		SlidingDftBinF_t y_f[bins_num * channels];
+		assert(sliding_dft_filter_sample_f(&sdft, frames, y_f, &ready) == FilterError);
+
+		sliding_dft_deinit(&single);
+		sliding_dft_deinit(&sdft);
+		free(output);
+	}
+
+	/* Float variant on a long run with large offset, resync keeps the error of a single window */
+	{
+		const uint32_t run_len = 200000;
+		const uint16_t check_every = 9973;
+		const double tolerance = 1e-5 * window_size * 32767;
+
+		int16_t run_frames[2 * channels];
+		SlidingDftBinF_t y[bins_num * channels];
+		uint8_t ready;
+
+		status = sliding_dft_init(&sdft, SlidingDftFloat, buffer, window_size, channels, bins, bins_num);
+		FILTER_ASSERT(status);
+
+		srand(47);
+		for(uint32_t n=0; n<run_len; n++)
+		{
+			int16_t *frame = &run_frames[(n & 1) * channels];
+
+			for(uint16_t ch=0; ch<channels; ch++)
+			{
+				frame[ch] = 30000 + rand() % 2001 - 1000;
+			}
+
+			status = sliding_dft_filter_sample_f(&sdft, frame, y, &ready);
+			FILTER_ASSERT(status);
+
+			if(ready && n % check_every == 0)
+			{
+				/* Window is kept in filter buffer, the oldest frame is the next one to be read */
+				int16_t window[window_size * channels];
+				FIFO_peek(&sdft.fifo, window, 0, window_size);
+
+				for(uint16_t b=0; b<bins_num; b++)
+				{
+					for(uint16_t ch=0; ch<channels; ch++)
+					{
+						double re, im;
+
+						sliding_dft_direct(window, window_size - 1, window_size, channels, ch, bins[b], &re, &im);
+						assert(fabs(y[b * channels + ch].re - re) <= tolerance);
+						assert(fabs(y[b * channels + ch].im - im) <= tolerance);
+					}
+				}
+			}
+		}
+
+		assert(sliding_dft_get_resync_count(&sdft) == run_len / window_size);
+
+		sliding_dft_deinit(&sdft);
+	}
+
+	/* Invalid parameters */
+	const uint16_t bad_bins[] = {1, window_size};
+
+	assert(sliding_dft_init(&sdft, SlidingDftFixed, buffer, window_size, channels, bad_bins, 2) == FilterError);
+	assert(sliding_dft_init(&sdft, SlidingDftFixed, buffer, window_size, channels, bins, 0) == FilterError);
+	assert(sliding_dft_init(&sdft, SlidingDftFixed, buffer, 0, channels, bins, bins_num) == FilterError);
+	assert(sliding_dft_init(&sdft, SlidingDftFixed, buffer, 32768, 1, bins, bins_num) == FilterError);
+}
+
+
+
+static void test_resampler(void)
+{
+	FilterStatus_t 	status;
+	Resampler_t resampler;
+
+	const uint16_t ratios[][2] = {{3, 2}, {2, 5}, {160, 147}, {1, 1}};
+	const uint16_t data_size = 3000;
+	const uint16_t fifo_size = 8000;
+
+	int16_t data[data_size];
+	int16_t fifo_buffer[fifo_size];
+	int16_t output[fifo_size];
+	FIFO_t fifo;
+
+	srand(53);
+	for(uint32_t i=0; i<data_size; i++)
+	{
+		data[i] = rand() % 20001 - 10000;
+	}
+
+	/* Output must be the zero stuffed, filtered and decimated input */
+	for(uint32_t r=0; r<sizeof ratios / sizeof *ratios; r++)
+	{
+		const uint16_t up = ratios[r][0];
+		const uint16_t down = ratios[r][1];
+		const uint16_t taps_num = up * 16 - 3;
+
+		int16_t *coeffs = (int16_t*)malloc(taps_num * sizeof *coeffs);
+
+		status = resampler_design_lowpass(up, down, taps_num, coeffs);
+		FILTER_ASSERT(status);
+
+		FIFO_init(&fifo, (uint8_t*)fifo_buffer, fifo_size, sizeof *fifo_buffer, FIFO_NO_FLAGS);
+
+		status = resampler_init(&resampler, up, down, coeffs, taps_num, &fifo);
+		FILTER_ASSERT(status);
+
+		/* Uneven blocks */
+		uint32_t pos = 0, total_len = 0;
+		for(uint16_t block_len=1; pos<data_size; block_len=block_len*3+1)
+		{
+			uint16_t len = std::min<uint32_t>(block_len, data_size - pos);
+			uint32_t y_len;
+
+			status = resampler_filter_block(&resampler, &data[pos], len, &y_len);
+			FILTER_ASSERT(status);
+			assert(y_len <= resampler_get_max_output_len(&resampler, len));
+
+			pos += len;
+			total_len += y_len;
+		}
+
+		const uint32_t expected_len = ((uint32_t)data_size * up + down - 1) / down;
+		assert(total_len == expected_len && FIFO_get_data_count(&fifo) == expected_len);
+
+		FIFO_ASSERT(FIFO_read(&fifo, output, total_len, NULL));
+
+		for(uint32_t m=0; m<total_len; m++)
+		{
+			int64_t acc = 0;
+			uint64_t t = (uint64_t)m * down;
+
+			for(uint32_t k=0; k<taps_num && k<=t; k++)
+			{
+				if((t - k) % up == 0)
+				{
+					acc += (int32_t)coeffs[k] * data[(t - k) / up];
+				}
+			}
+
+			int32_t expected = (int32_t)((acc + (1 << 14)) >> 15);
+			expected = std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, expected));
+
+			assert(output[m] == expected);
+		}
+
+		/* Constant input settles at the same level */
+		resampler_flush(&resampler);
+
+		int16_t level[200];
+		uint32_t y_len;
+
+		std::fill(level, level + 200, 1000);
+
+		status = resampler_filter_block(&resampler, level, 200, &y_len);
+		FILTER_ASSERT(status);
+
+		FIFO_ASSERT(FIFO_read(&fifo, output, y_len, NULL));
+		assert(abs(output[y_len - 1] - 1000) <= 10);
+
+		resampler_deinit(&resampler);
+		free(coeffs);
+	}
+
+	/* Downstream FIFO overflow */
+	{
+		const int16_t coeffs[] = {16384, 16384, 16384, 16384};
+		uint32_t y_len;
+
+		FIFO_init(&fifo, (uint8_t*)fifo_buffer, 10, sizeof *fifo_buffer, FIFO_NO_FLAGS);
+
+		status = resampler_init(&resampler, 2, 1, coeffs, 4, &fifo);
+		FILTER_ASSERT(status);
+
+		Resampler_t reference;
+		FIFO_t reference_fifo;
+		int16_t reference_buffer[16], reference_output[16];
+
+		FIFO_init(&reference_fifo, (uint8_t*)reference_buffer, 16, sizeof *reference_buffer, FIFO_NO_FLAGS);
+		status = resampler_init(&reference, 2, 1, coeffs, 4, &reference_fifo);
+		FILTER_ASSERT(status);
+		status = resampler_filter_block(&reference, data, 8, &y_len);
+		FILTER_ASSERT(status);
+		FIFO_ASSERT(FIFO_read(&reference_fifo, reference_output, y_len, NULL));
+
+		/* Block which does not fit is rejected as a whole and nothing is consumed */
+		assert(resampler_filter_block(&resampler, data, 4, &y_len) == FilterOK && y_len == 8);
+		assert(resampler_filter_block(&resampler, data + 4, 2, &y_len) == FilterError && y_len == 0);
+		assert(FIFO_get_data_count(&fifo) == 8);
+
+		assert(resampler_filter_block(&resampler, data + 4, 1, &y_len) == FilterOK && y_len == 2);
+		assert(resampler_filter_block(&resampler, data + 5, 1, &y_len) == FilterError && y_len == 0);
+
+		FIFO_ASSERT(FIFO_read(&fifo, output, 10, NULL));
+		assert(resampler_filter_block(&resampler, data + 5, 3, &y_len) == FilterOK && y_len == 6);
+		FIFO_ASSERT(FIFO_read(&fifo, output + 10, 6, NULL));
+
+		assert(memcmp(output, reference_output, 16 * sizeof *output) == 0);
+
+		resampler_deinit(&resampler);
+		resampler_deinit(&reference);
+	}
+
+	/* Invalid parameters */
+	FIFO_t byte_fifo;
+	uint8_t byte_buffer[16];
+	const int16_t coeffs[] = {32767};
+
+	FIFO_init(&byte_fifo, byte_buffer, 16, 1, FIFO_NO_FLAGS);
+
+	assert(resampler_init(&resampler, 0, 1, coeffs, 1, &fifo) == FilterError);
+	assert(resampler_init(&resampler, 1, 0, coeffs, 1, &fifo) == FilterError);
+	assert(resampler_init(&resampler, 1, 1, coeffs, 0, &fifo) == FilterError);
+	assert(resampler_init(&resampler, 1, 1, coeffs, 1, &byte_fifo) == FilterError);
+}
+
+
+
+static void test_spatial_filter(void)
+{
+	FilterStatus_t 	status;
+
+	const uint16_t channels_list[] = {1, 2, 3, 4, 5, 8, 9, 12, 40};
+	const uint32_t frames_nums[] = {5, 37};
+	const uint16_t max_channels = 40;
+	const uint32_t max_frames = 37;
+
+	int16_t frames[max_frames * max_channels];
+	int16_t output[max_frames];
+
+	srand(59);
+	for(uint32_t i=0; i<max_frames * max_channels; i++)
+	{
+		frames[i] = (int16_t)(rand() & 0xFFFF);
+	}
+
+	/* Optimal and generated network paths against sorted frames */
+	for(uint32_t n=0; n<sizeof frames_nums / sizeof *frames_nums; n++)
+	{
+		const uint32_t frames_num = frames_nums[n];
+
+		for(uint32_t ci=0; ci<sizeof channels_list / sizeof *channels_list; ci++)
+		{
+			const uint16_t channels = channels_list[ci];
+
+			for(uint16_t rank=0; rank<channels; rank++)
+			{
+				status = spatial_filter_rank(frames, frames_num, channels, rank, output);
+				FILTER_ASSERT(status);
+
+				for(uint32_t i=0; i<frames_num; i++)
+				{
+					int16_t frame[max_channels];
+
+					memcpy(frame, &frames[i * channels], channels * sizeof *frame);
+					std::sort(frame, frame + channels);
+
+					assert(output[i] == frame[rank]);
+				}
+			}
+
+			status = spatial_filter_median(frames, frames_num, channels, output);
+			FILTER_ASSERT(status);
+
+			for(uint32_t i=0; i<frames_num; i++)
+			{
+				int16_t frame[max_channels];
+
+				memcpy(frame, &frames[i * channels], channels * sizeof *frame);
+				std::sort(frame, frame + channels);
+
+				assert(output[i] == frame[(channels - 1) / 2]);
+			}
+
+			status = spatial_filter_mean(frames, frames_num, channels, output);
+			FILTER_ASSERT(status);
+
+			for(uint32_t i=0; i<frames_num; i++)
+			{
+				int32_t sum = 0;
+
+				for(uint16_t c=0; c<channels; c++)
+				{
+					sum += frames[i * channels + c];
+				}
+
+				assert(output[i] == sum / channels);
+			}
+		}
+	}
+
+	/* Generated networks and qsort beyond SPATIAL_FILTER_NETWORK_MAX_CHANNELS against nth_element */
+	{
+		const uint16_t large_channels[] = {16, 33, 100, SPATIAL_FILTER_NETWORK_MAX_CHANNELS,
+				SPATIAL_FILTER_NETWORK_MAX_CHANNELS + 1, 1500};
+		const uint32_t large_frames_nums[] = {3, 16, 50};
+		const uint32_t large_max_frames = 50;
+
+		int16_t *large_frames = (int16_t*)malloc(large_max_frames * 1500 * sizeof *large_frames);
+		int16_t *frame = (int16_t*)malloc(1500 * sizeof *frame);
+		int16_t large_output[large_max_frames];
+
+		for(uint32_t i=0; i<large_max_frames * 1500; i++)
+		{
+			large_frames[i] = (int16_t)(rand() & 0xFFFF);
+		}
+
+		for(uint32_t n=0; n<sizeof large_frames_nums / sizeof *large_frames_nums; n++)
+		{
+			const uint32_t frames_num = large_frames_nums[n];
+
+			for(uint32_t ci=0; ci<sizeof large_channels / sizeof *large_channels; ci++)
+			{
+				const uint16_t channels = large_channels[ci];
+				const uint16_t ranks[] = {0, 1, (uint16_t)((channels - 1) / 2), (uint16_t)(channels - 1)};
+
+				for(uint32_t r=0; r<4; r++)
+				{
+					status = spatial_filter_rank(large_frames, frames_num, channels, ranks[r], large_output);
+					FILTER_ASSERT(status);
+
+					for(uint32_t i=0; i<frames_num; i++)
+					{
+						memcpy(frame, &large_frames[i * channels], channels * sizeof *frame);
+						std::nth_element(frame, frame + ranks[r], frame + channels);
+
+						assert(large_output[i] == frame[ranks[r]]);
+					}
+				}
+			}
+		}
+
+		free(large_frames);
+		free(frame);
+	}
+
+	/* Generated networks sort every 0-1 input, so they sort any input */
+	for(uint16_t size=1; size<=16; size++)
+	{
+		SortNetwork_t network;
+		int16_t bits[16];
+
+		status = sort_network_init_batcher(&network, size);
+		FILTER_ASSERT(status);
+
+		for(uint32_t input=0; input<(1u << size); input++)
+		{
+			uint32_t ones = 0;
+
+			for(uint16_t b=0; b<size; b++)
+			{
+				bits[b] = (input >> b) & 1;
+				ones += bits[b];
+			}
+
+			sort_network_sort(&network, bits);
+
+			for(uint16_t b=0; b<size; b++)
+			{
+				assert(bits[b] == (b >= size - ones));
+			}
+		}
+
+		sort_network_deinit(&network);
+	}
+
+	/* Even number of channels with INT16_MAX samples */
+	const int16_t max_frame[] = {INT16_MAX, INT16_MAX, 7, INT16_MAX};
+
+	status = spatial_filter_rank(max_frame, 1, 4, 3, output);
+	FILTER_ASSERT(status);
+	assert(output[0] == INT16_MAX);
+
+	status = spatial_filter_rank(max_frame, 1, 4, 0, output);
+	FILTER_ASSERT(status);
+	assert(output[0] == 7);
+
+	assert(spatial_filter_rank(frames, 1, 4, 4, output) == FilterError);
+	assert(spatial_filter_median(frames, 1, 0, output) == FilterError);
+	assert(spatial_filter_mean(frames, 1, 0, output) == FilterError);
+}
+
+
+
+static void test_rank_filter_decimated(void)
+{
+	FilterStatus_t 	status;
+	RankFilter_t rank_filter;
+
+	const uint16_t window_size = 33;
+	const uint16_t buf_size = 1000;
+	const uint16_t decimations[] = {1, 3, 8, 32, 33};
+
+	int16_t buffer[window_size];
+	int16_t data[buf_size];
+	int16_t expected[buf_size];
+	int16_t output[buf_size];
+	uint16_t expected_len, output_len;
+
+	/* Many equal samples */
+	srand(61);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		data[i] = rand() % 16 - 8;
+	}
+
+	for(uint32_t d=0; d<sizeof decimations / sizeof *decimations; d++)
+	{
+		const uint16_t decimation = decimations[d];
+
+		for(uint16_t rank=0; rank<window_size; rank+=8)
+		{
+			status = rank_filter_filter_sequence(data, buf_size, window_size, rank, expected, &expected_len);
+			FILTER_ASSERT(status);
+
+			status = rank_filter_decimated_init(&rank_filter, buffer, window_size, rank, decimation);
+			FILTER_ASSERT(status);
+
+			/* Blocks do not need to be aligned to decimation */
+			uint16_t pos = 0, produced = 0;
+			for(uint16_t block_len=5; pos<buf_size; block_len+=7)
+			{
+				uint16_t len = std::min<uint16_t>(block_len, buf_size - pos);
+
+				status = rank_filter_decimated_filter_block(&rank_filter, &data[pos], len, &output[produced],
+						&output_len);
+				FILTER_ASSERT(status);
+
+				pos += len;
+				produced += output_len;
+			}
+
+			assert(produced == (expected_len - 1) / decimation + 1);
+
+			for(uint16_t i=0; i<produced; i++)
+			{
+				assert(output[i] == expected[i * decimation]);
+			}
+
+			/* Flush drops pending batch */
+			rank_filter_flush(&rank_filter);
+
+			uint8_t ready;
+			for(uint16_t i=0; i<window_size; i++)
+			{
+				status = rank_filter_decimated_filter_sample(&rank_filter, data[i], &output[0], &ready);
+				FILTER_ASSERT(status);
+				assert(ready == (i + 1 == window_size));
+			}
+
+			assert(output[0] == expected[0]);
+
+			rank_filter_deinit(&rank_filter);
+		}
+	}
+
+	assert(rank_filter_decimated_init(&rank_filter, buffer, window_size, 0, 0) == FilterError);
+	assert(rank_filter_decimated_init(&rank_filter, buffer, window_size, 0, window_size + 1) == FilterError);
+}
+
+
+
+static void test_filter_backends(void)
+{
+	FilterStatus_t 	status;
+
+	const uint16_t buf_size = 2000;
+	int16_t data[buf_size];
+	int16_t output[buf_size];
+	int16_t expected[buf_size];
+	uint16_t output_len, expected_len;
+
+	/* Many equal samples */
+	srand(67);
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		data[i] = rand() % 64 - 32;
+	}
+
+	/* Rank filter, binary search backend switched on in the middle of stream */
+	{
+		const uint16_t window_sizes[] = {1, 5, 63, 200};
+
+		for(uint32_t w=0; w<sizeof window_sizes / sizeof *window_sizes; w++)
+		{
+			const uint16_t window_size = window_sizes[w];
+			int16_t buffer[window_size];
+
+			for(uint16_t rank=0; rank<window_size; rank+=std::max(1, window_size / 3))
+			{
+				RankFilter_t rank_filter;
+
+				status = rank_filter_filter_sequence(data, buf_size, window_size, rank, expected, &expected_len);
+				FILTER_ASSERT(status);
+
+				status = rank_filter_init(&rank_filter, buffer, window_size, rank);
+				FILTER_ASSERT(status);
+				assert(rank_filter.backend == RankFilterLinearScan);
+
+				status = rank_filter_filter_block(&rank_filter, data, buf_size / 2, output, &output_len);
+				FILTER_ASSERT(status);
+
+				uint16_t first_len = output_len;
+				rank_filter_set_backend(&rank_filter, RankFilterBinarySearch);
+
+				status = rank_filter_filter_block(&rank_filter, data + buf_size / 2, buf_size / 2,
+						output + first_len, &output_len);
+				FILTER_ASSERT(status);
+
+				assert(first_len + output_len == expected_len);
+				assert(memcmp(output, expected, expected_len * sizeof *output) == 0);
+
+				rank_filter_deinit(&rank_filter);
+			}
+		}
+	}
+
+	/* Moving average, direct ring backend with ring larger than window */
+	for(uint32_t t=0; t<2; t++)
+	{
+		const FilterType_t ftype = (t == 0) ? FilterLowPass : FilterHighPass;
+		const uint16_t ring_size = 37;
+		const uint16_t window_size = 16;
+
+		MovingAverageFilter_t fifo_filter, ring_filter;
+		int16_t fifo_buffer[ring_size], ring_buffer[ring_size];
+
+		status = moving_avg_init_capacity(&fifo_filter, ftype, fifo_buffer, ring_size, window_size);
+		FILTER_ASSERT(status);
+		status = moving_avg_init_capacity(&ring_filter, ftype, ring_buffer, ring_size, window_size);
+		FILTER_ASSERT(status);
+
+		assert(ring_filter.backend == MovingAverageFifo);
+		moving_avg_set_backend(&ring_filter, MovingAverageDirectRing);
+
+		status = moving_avg_filter_block(&fifo_filter, data, buf_size / 2, expected, &expected_len);
+		FILTER_ASSERT(status);
+		status = moving_avg_filter_block(&ring_filter, data, buf_size / 2, output, &output_len);
+		FILTER_ASSERT(status);
+
+		assert(output_len == expected_len);
+		assert(memcmp(output, expected, expected_len * sizeof *output) == 0);
+
+		/* FIFO stays consistent for the rest of API */
+		FILTER_ASSERT(moving_avg_resize(&fifo_filter, 9));
+		FILTER_ASSERT(moving_avg_resize(&ring_filter, 9));
+
+		status = moving_avg_filter_block(&fifo_filter, data + buf_size / 2, buf_size / 2, expected, &expected_len);
+		FILTER_ASSERT(status);
+		status = moving_avg_filter_block(&ring_filter, data + buf_size / 2, buf_size / 2, output, &output_len);
+		FILTER_ASSERT(status);
+
+		assert(output_len == expected_len);
+		assert(memcmp(output, expected, expected_len * sizeof *output) == 0);
+	}
+}
+
+
+
+#ifdef FILTER_AUTOTUNE_ENABLE
+static void test_filter_autotune(void)
+{
+	const char *cache_path = "filter_autotune_test.cache";
+
+	RankFilterBackend_t rank_backend, cached_rank_backend;
+	MovingAverageBackend_t avg_backend, cached_avg_backend;
+
+	filter_autotune_reset();
+	assert(filter_autotune_lookup_rank(63, 31, &rank_backend) == FilterError);
+
+	FILTER_ASSERT(filter_autotune_rank(63, 31, &rank_backend));
+	FILTER_ASSERT(filter_autotune_moving_avg(64, FilterHighPass, &avg_backend));
+	assert(filter_autotune_rank(63, 63, &rank_backend) == FilterError);
+
+	FILTER_ASSERT(filter_autotune_save(cache_path));
+
+	/* The next startup takes backends from cache */
+	filter_autotune_reset();
+	FILTER_ASSERT(filter_autotune_load(cache_path));
+
+	FILTER_ASSERT(filter_autotune_lookup_rank(63, 31, &cached_rank_backend));
+	FILTER_ASSERT(filter_autotune_lookup_moving_avg(64, FilterHighPass, &cached_avg_backend));
+	assert(cached_rank_backend == rank_backend && cached_avg_backend == avg_backend);
+	assert(filter_autotune_lookup_moving_avg(64, FilterLowPass, &cached_avg_backend) == FilterError);
+
+	RankFilter_t rank_filter;
+	MovingAverageFilter_t avg_filter;
+	int16_t rank_buffer[63], avg_buffer[64];
+
+	FILTER_ASSERT(rank_filter_init(&rank_filter, rank_buffer, 63, 31));
+	FILTER_ASSERT(moving_avg_init(&avg_filter, FilterHighPass, avg_buffer, 64));
+	assert(rank_filter.backend == rank_backend && avg_filter.backend == avg_backend);
+	rank_filter_deinit(&rank_filter);
+
+	/* Cache of another library version is not used */
+	FILE *file = fopen(cache_path, "w");
+	fprintf(file, "filter_autotune 0.0.0\ncpu unknown\nrank 63 31 1\n");
+	fclose(file);
+
+	assert(filter_autotune_load(cache_path) == FilterError);
+	assert(filter_autotune_lookup_rank(63, 31, &cached_rank_backend) == FilterError);
+
+	remove(cache_path);
+}
+#endif
+
+
+
+static void test_filter_2d(void)
+{
+	FilterStatus_t 	status;
+
+	const uint16_t width = 150;
+	const uint16_t height = 70;
+	const uint16_t kernels[][2] = {{1, 1}, {3, 3}, {5, 3}, {2, 7}, {12, 5}, {9, 9}};
+
+	static int16_t frame[width * height];
+	static int16_t output[width * height];
+	uint16_t y_width, y_height;
+
+	/* Narrow range frame is filtered with column histograms, full range one sorts windows */
+	for(uint16_t pass=0; pass<2; pass++)
+	{
+		srand(11 + pass);
+		for(uint32_t i=0; i<(uint32_t)width * height; i++)
+		{
+			frame[i] = (pass == 0) ? 1000 + (rand() % 3000) : (int16_t)(rand() & 0xFFFF);
+		}
+
+		for(uint16_t k=0; k<sizeof kernels / sizeof kernels[0]; k++)
+		{
+			uint16_t kernel_width = kernels[k][0];
+			uint16_t kernel_height = kernels[k][1];
+			uint32_t area = kernel_width * kernel_height;
+
+			status = filter_2d_get_output_size(width, height, kernel_width, kernel_height, &y_width, &y_height);
+			FILTER_ASSERT(status);
+
+			status = rank_filter_filter_2d(frame, width, height, kernel_width, kernel_height, (area - 1) / 2, output);
+			FILTER_ASSERT(status);
+
+			for(uint16_t r=0; r<y_height; r++)
+			{
+				for(uint16_t x=0; x<y_width; x++)
+				{
+					int16_t window[81];
+
+					for(uint16_t j=0; j<kernel_height; j++)
+					{
+						memcpy(window + j*kernel_width, frame + (r+j)*width + x, kernel_width * sizeof *window);
+					}
+
+					nth_element(window, window + (area - 1) / 2, window + area);
+					assert(output[r*y_width + x] == window[(area - 1) / 2]);
+				}
+			}
+
+			status = moving_avg_filter_2d(frame, width, height, kernel_width, kernel_height, output);
+			FILTER_ASSERT(status);
+
+			for(uint16_t r=0; r<y_height; r++)
+			{
+				for(uint16_t x=0; x<y_width; x++)
+				{
+					int32_t sum = 0;
+
+					for(uint16_t j=0; j<kernel_height; j++)
+					{
+						for(uint16_t i=0; i<kernel_width; i++)
+						{
+							sum += frame[(r+j)*width + x + i];
+						}
+					}
+
+					assert(output[r*y_width + x] == sum / (int32_t)area);
+				}
+			}
+		}
+	}
+
+	/* Kernel area above 16 bits, both narrow and full range */
+	{
+		const uint16_t large_width = 300;
+		const uint16_t large_height = 280;
+		const uint16_t kernel_width = 290;
+		const uint16_t kernel_height = 260;
+		const uint32_t area = (uint32_t)kernel_width * kernel_height;
+		const uint32_t ranks[] = {0, (area - 1) / 2, area - 7};
+
+		static int16_t large_frame[large_width * large_height];
+		static int16_t large_output[large_width * large_height];
+		static int16_t window[kernel_width * kernel_height];
+
+		status = filter_2d_get_output_size(large_width, large_height, kernel_width, kernel_height, &y_width, &y_height);
+		FILTER_ASSERT(status);
+
+		for(uint16_t pass=0; pass<2; pass++)
+		{
+			srand(39 + pass);
+			for(uint32_t i=0; i<(uint32_t)large_width * large_height; i++)
+			{
+				large_frame[i] = (pass == 0) ? rand() % 200 - 100 : (int16_t)(rand() & 0xFFFF);
+			}
+
+			for(uint32_t k=0; k<sizeof ranks / sizeof *ranks; k++)
+			{
+				status = rank_filter_filter_2d(large_frame, large_width, large_height, kernel_width, kernel_height,
+						ranks[k], large_output);
+				FILTER_ASSERT(status);
+
+				for(uint16_t r=0; r<y_height; r++)
+				{
+					for(uint16_t x=0; x<y_width; x++)
+					{
+						for(uint16_t j=0; j<kernel_height; j++)
+						{
+							memcpy(window + j*kernel_width, large_frame + (r+j)*large_width + x,
+									kernel_width * sizeof *window);
+						}
+
+						nth_element(window, window + ranks[k], window + area);
+						assert(large_output[r*y_width + x] == window[ranks[k]]);
+					}
+				}
+			}
+		}
+	}
+
+	assert(rank_filter_filter_2d(frame, width, height, 3, 3, 9, output) == FilterError);
+	assert(moving_avg_filter_2d(frame, width, height, width + 1, 3, output) == FilterError);
+}
+
+
+
+static void test_filter_state_checkpoint(void)
+{
+	FilterStatus_t 	status;
+	MovingAverageFilter_t average, average_restored;
+	RankFilter_t rank_filter, rank_restored;
+
+	const uint32_t window_size = 5;
+	const uint32_t buf_size = 16;
+	const uint32_t checkpoint_at = 9;
+
+	int16_t buffer[buf_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25, 30, -40, 50, 1};
+	int16_t avg_fifo[window_size], avg_restored_fifo[window_size];
+	int16_t rank_fifo[window_size], rank_restored_fifo[window_size];
+
+	uint8_t avg_state[128], rank_state[128];
+	uint32_t avg_state_size, rank_state_size;
+	int16_t sample, sample_restored;
+
+	status = moving_avg_init(&average, FilterHighPass, avg_fifo, window_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_init(&rank_filter, rank_fifo, window_size, 1);
+	FILTER_ASSERT(status);
+
+	status = moving_avg_fill_buffer(&average, buffer, &sample);
+	FILTER_ASSERT(status);
+	status = rank_filter_fill_buffer(&rank_filter, buffer, &sample);
+	FILTER_ASSERT(status);
+
+	for(unsigned int i=window_size; i<checkpoint_at; i++)
+	{
+		moving_avg_filter_sample(&average, buffer[i], &sample);
+		rank_filter_filter_sample(&rank_filter, buffer[i], &sample);
+	}
+
+	status = moving_avg_save_state(&average, avg_state, sizeof avg_state, &avg_state_size);
+	FILTER_ASSERT(status);
+	assert(avg_state_size == moving_avg_get_state_size(&average));
+	status = rank_filter_save_state(&rank_filter, rank_state, sizeof rank_state, &rank_state_size);
+	FILTER_ASSERT(status);
+
+	/* Standby filters */
+	status = moving_avg_init(&average_restored, FilterLowPass, avg_restored_fifo, window_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_init(&rank_restored, rank_restored_fifo, window_size, 0);
+	FILTER_ASSERT(status);
+
+	assert(moving_avg_restore_state(&average_restored, rank_state, rank_state_size) == FilterError);
+	assert(moving_avg_restore_state(&average_restored, avg_state, avg_state_size - 1) == FilterError);
+
+	status = moving_avg_restore_state(&average_restored, avg_state, avg_state_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_restore_state(&rank_restored, rank_state, rank_state_size);
+	FILTER_ASSERT(status);
+
+	for(unsigned int i=checkpoint_at; i<buf_size; i++)
+	{
+		moving_avg_filter_sample(&average, buffer[i], &sample);
+		status = moving_avg_filter_sample(&average_restored, buffer[i], &sample_restored);
+		FILTER_ASSERT(status);
+		assert(sample == sample_restored);
+
+		rank_filter_filter_sample(&rank_filter, buffer[i], &sample);
+		status = rank_filter_filter_sample(&rank_restored, buffer[i], &sample_restored);
+		FILTER_ASSERT(status);
+		assert(sample == sample_restored);
+	}
+
+	/* Checkpoint of filter which is still growing after resize */
+	const uint32_t grown_size = 8;
+	int16_t avg_capacity[grown_size], rank_capacity[grown_size];
+	int16_t avg_grown_fifo[grown_size], rank_grown_fifo[grown_size];
+
+	status = moving_avg_init_capacity(&average, FilterHighPass, avg_capacity, grown_size, window_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_init_capacity(&rank_filter, rank_capacity, grown_size, window_size, 1);
+	FILTER_ASSERT(status);
+
+	status = moving_avg_fill_buffer(&average, buffer, &sample);
+	FILTER_ASSERT(status);
+	status = rank_filter_fill_buffer(&rank_filter, buffer, &sample);
+	FILTER_ASSERT(status);
+
+	FILTER_ASSERT(moving_avg_resize(&average, grown_size));
+	FILTER_ASSERT(rank_filter_resize(&rank_filter, grown_size));
+
+	moving_avg_filter_sample(&average, buffer[window_size], &sample);
+	rank_filter_filter_sample(&rank_filter, buffer[window_size], &sample);
+
+	status = moving_avg_save_state(&average, avg_state, sizeof avg_state, &avg_state_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_save_state(&rank_filter, rank_state, sizeof rank_state, &rank_state_size);
+	FILTER_ASSERT(status);
+
+	status = moving_avg_init(&average_restored, FilterLowPass, avg_grown_fifo, grown_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_init(&rank_restored, rank_grown_fifo, grown_size, 0);
+	FILTER_ASSERT(status);
+
+	status = moving_avg_restore_state(&average_restored, avg_state, avg_state_size);
+	FILTER_ASSERT(status);
+	status = rank_filter_restore_state(&rank_restored, rank_state, rank_state_size);
+	FILTER_ASSERT(status);
+
+	for(unsigned int i=window_size+1; i<buf_size; i++)
+	{
+		status = moving_avg_filter_sample(&average, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		status = moving_avg_filter_sample(&average_restored, buffer[i], &sample_restored);
+		FILTER_ASSERT(status);
+		assert(sample == sample_restored);
+
+		status = rank_filter_filter_sample(&rank_filter, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		status = rank_filter_filter_sample(&rank_restored, buffer[i], &sample_restored);
+		FILTER_ASSERT(status);
+		assert(sample == sample_restored);
+	}
+}
+
+
+
+static void test_padded_sequences(void)
+{
+	FilterStatus_t 	status;
+	FilterEdgeConfig_t edge;
+
+	const uint16_t data_size = 16;
+	int16_t data[data_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25, 30, -40, 50, 1};
+	int16_t out_avg[data_size];
+	int16_t out_rank[data_size];
+
+	const FilterPadding_t paddings[] = {FilterPadReflect, FilterPadReplicate, FilterPadConstant, FilterPadWrap};
+	const FilterAlignment_t alignments[] = {FilterAlignCausal, FilterAlignCentered};
+	const uint16_t windows[] = {1, 3, 4, 7, 20};
+
+	edge.pad_value = -7;
+
+	for(unsigned int p=0; p<4; p++)
+	for(unsigned int a=0; a<2; a++)
+	for(unsigned int w=0; w<5; w++)
+	{
+		uint16_t window_size = windows[w];
+		uint16_t rank = window_size / 2;
+
+		edge.padding = paddings[p];
+		edge.alignment = alignments[a];
+
+		status = moving_avg_filter_sequence_padded(data, data_size, window_size, &edge, out_avg);
+		FILTER_ASSERT(status);
+		status = rank_filter_filter_sequence_padded(data, data_size, window_size, rank, &edge, out_rank);
+		FILTER_ASSERT(status);
+
+		int32_t left = filter_edge_get_left_len(window_size, edge.alignment);
+
+		for(int32_t i=0; i<data_size; i++)
+		{
+			int16_t window[window_size];
+			int32_t acc = 0;
+
+			for(int32_t k=0; k<window_size; k++)
+			{
+				window[k] = filter_edge_get_sample(data, data_size, i - left + k, &edge);
+				acc += window[k];
+			}
+
+			std::sort(window, window + window_size);
+
+			assert(out_avg[i] == acc / window_size);
+			assert(out_rank[i] == window[rank]);
+		}
+	}
+
+	/* Padding policies */
+	edge.padding = FilterPadReflect;
+	assert(filter_edge_get_sample(data, data_size, -2, &edge) == 21);
+	assert(filter_edge_get_sample(data, data_size, 17, &edge) == -40);
+	edge.padding = FilterPadReplicate;
+	assert(filter_edge_get_sample(data, data_size, -2, &edge) == 44);
+	edge.padding = FilterPadWrap;
+	assert(filter_edge_get_sample(data, data_size, -2, &edge) == 50);
+	assert(filter_edge_get_sample(data, data_size, 17, &edge) == 2);
+}
+
+
+
+static void test_weighted_exp_moving_average(void)
+{
+	FilterStatus_t 	status;
+	WeightedMovingAverageFilter_t wma;
+	ExpMovingAverageFilter_t ema, dema;
+
+	const uint32_t window_size = 4;
+	const uint32_t buf_size = 16;
+	const uint16_t norm = window_size * (window_size + 1) / 2;
+
+	int16_t buffer[buf_size] = {44, 2, 21, 5, 11, 14, 32, 65, 13, 11, -10, -25, 30, -40, 50, 1};
+	int16_t fifo_buffer[window_size];
+	int16_t output[buf_size];
+	int16_t sample;
+	uint16_t output_len;
+
+	/* Weighted moving average is exact */
+	status = weighted_moving_avg_filter_sequence(buffer, buf_size, window_size, output, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == buf_size - window_size + 1);
+
+	for(uint32_t i=0; i<output_len; i++)
+	{
+		int32_t weighted_sum = 0;
+
+		for(uint32_t j=0; j<window_size; j++)
+		{
+			weighted_sum += (j + 1) * buffer[i + j];
+		}
+
+		assert(output[i] == weighted_sum / norm);
+	}
+
+	status = weighted_moving_avg_init(&wma, FilterLowPass, fifo_buffer, window_size);
+	FILTER_ASSERT(status);
+
+	assert(weighted_moving_avg_filter_sample(&wma, buffer[0], &sample) == FilterError);
+
+	status = weighted_moving_avg_fill_buffer(&wma, buffer, &sample);
+	FILTER_ASSERT(status);
+	assert(sample == output[0]);
+
+	for(uint32_t i=window_size; i<buf_size; i++)
+	{
+		status = weighted_moving_avg_filter_sample(&wma, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(sample == output[i - window_size + 1]);
+	}
+
+	/* Block path against sequence in blocks shorter and longer than window and FIFO chunk */
+	{
+		const uint16_t data_len = 3000;
+		const uint16_t block_lens[] = {1, 7, 300, 1000, 2, 1690};
+		const uint16_t window_sizes[] = {4, 300};
+
+		int16_t data[data_len], expected[data_len], block_output[data_len];
+		uint16_t expected_len, produced = 0;
+
+		srand(36);
+		for(uint32_t i=0; i<data_len; i++)
+		{
+			data[i] = rand() % 20000 - 10000;
+		}
+
+		for(uint32_t w=0; w<2; w++)
+		{
+			const uint16_t window = window_sizes[w];
+			int16_t block_fifo[window];
+
+			status = weighted_moving_avg_filter_sequence(data, data_len, window, expected, &expected_len);
+			FILTER_ASSERT(status);
+
+			status = weighted_moving_avg_init(&wma, FilterLowPass, block_fifo, window);
+			FILTER_ASSERT(status);
+
+			produced = 0;
+			for(uint32_t b=0, offset=0; b<sizeof block_lens / sizeof *block_lens; offset+=block_lens[b++])
+			{
+				status = weighted_moving_avg_filter_block(&wma, data + offset, block_lens[b],
+						block_output + produced, &output_len);
+				FILTER_ASSERT(status);
+				produced += output_len;
+			}
+
+			assert(produced == expected_len);
+			assert(memcmp(block_output, expected, expected_len * sizeof *expected) == 0);
+
+			/* Filter keeps working sample by sample after blocks */
+			status = weighted_moving_avg_filter_sample(&wma, data[0], &sample);
+			FILTER_ASSERT(status);
+
+			int64_t weighted_sum = window * (int64_t)data[0];
+			for(uint32_t j=1; j<window; j++)
+			{
+				weighted_sum += j * (int64_t)data[data_len - window + j];
+			}
+			assert(sample == weighted_sum / (window * (window + 1) / 2));
+		}
+	}
+
+	/* Full scale data and long windows against integer division, quotients hit integers exactly */
+	{
+		const uint16_t data_len = 65535;
+		const uint16_t window_sizes[] = {65000, 30000, 255, 22};
+		const FilterType_t ftypes[] = {FilterLowPass, FilterHighPass};
+
+		static int16_t data[data_len], block_fifo[30000], block_output[data_len];
+
+		for(uint32_t i=0; i<data_len; i++)
+		{
+			if(i < 30000)
+			{
+				data[i] = 32767;
+			}
+			else if(i < 60000)
+			{
+				data[i] = -32768;
+			}
+			else
+			{
+				/* Runs of equal samples make W an exact multiple of norm for short windows */
+				data[i] = -32768 + ((i - 60000) / 25) * 293;
+			}
+		}
+
+		for(uint32_t w=0; w<4; w++)
+		{
+			for(uint32_t f=0; f<2; f++)
+			{
+				const int64_t window = window_sizes[w];
+
+				/* FIFO byte size is 16 bit, so the longest window goes through sequence path only */
+				if(window > 30000)
+				{
+					if(ftypes[f] == FilterHighPass)
+					{
+						continue;
+					}
+
+					status = weighted_moving_avg_filter_sequence(data, data_len, window, block_output, &output_len);
+				}
+				else
+				{
+					status = weighted_moving_avg_init(&wma, ftypes[f], block_fifo, window);
+					FILTER_ASSERT(status);
+
+					status = weighted_moving_avg_filter_block(&wma, data, data_len, block_output, &output_len);
+				}
+				FILTER_ASSERT(status);
+				assert(output_len == data_len - window + 1);
+
+				int64_t sum = 0, weighted_sum = 0;
+				for(uint32_t j=0; j<window; j++)
+				{
+					sum += data[j];
+					weighted_sum += (j + 1) * (int64_t)data[j];
+				}
+
+				for(uint32_t i=0; i<output_len; i++)
+				{
+					if(i > 0)
+					{
+						weighted_sum += window * data[i + window - 1] - sum;
+						sum += data[i + window - 1] - data[i - 1];
+					}
+
+					int16_t expected = weighted_sum / (window * (window + 1) / 2);
+					if(ftypes[f] == FilterHighPass)
+					{
+						expected = data[i + window - 1] - expected;
+					}
+
+					assert(block_output[i] == expected);
+				}
+			}
+		}
+	}
+
+	/* Exponential averages against floating point reference */
+	uint16_t alpha = exp_moving_avg_alpha_from_window(window_size);
+	double a = alpha / (double)EXP_MOVING_AVG_ALPHA_ONE;
+	double e = buffer[0], e2 = buffer[0];
+
+	status = exp_moving_avg_init(&ema, FilterLowPass, ExpMovingAverageSingle, alpha);
+	FILTER_ASSERT(status);
+
+	status = exp_moving_avg_init(&dema, FilterLowPass, ExpMovingAverageDouble, alpha);
+	FILTER_ASSERT(status);
+
+	assert(exp_moving_avg_init(&ema, FilterLowPass, ExpMovingAverageSingle, 0) == FilterError);
+
+	status = exp_moving_avg_filter_block(&ema, buffer, buf_size / 2, output, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == buf_size / 2);
+
+	status = exp_moving_avg_filter_block(&ema, buffer + buf_size / 2, buf_size / 2, output + buf_size / 2, &output_len);
+	FILTER_ASSERT(status);
+
+	for(uint32_t i=0; i<buf_size; i++)
+	{
+		e += a * (buffer[i] - e);
+		e2 += a * (e - e2);
+
+		assert(abs(output[i] - lround(e)) <= 1);
+
+		status = exp_moving_avg_filter_sample(&dema, buffer[i], &sample);
+		FILTER_ASSERT(status);
+		assert(abs(sample - lround(2*e - e2)) <= 1);
+	}
+
+	status = exp_moving_avg_filter_sequence(buffer, buf_size, ExpMovingAverageSingle, alpha, output, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == buf_size);
+}
+
+
+
+static void test_filter_pipeline(void)
+{
+	FilterStatus_t 	status;
+	FilterPipeline_t pipeline;
+	RankFilter_t rank_filter;
+	MovingAverageFilter_t average;
+
+	const uint16_t data_size = 1200;
+	const uint16_t rank_window = 5;
+	const uint16_t avg_window = 3;
+
+	int16_t rank_buffer[rank_window];
+	int16_t avg_buffer[avg_window];
+
+	int16_t data[data_size];
+	int16_t ranked[data_size];
+	int16_t expected[data_size];
+	int16_t out_data[data_size];
+
+	uint16_t ranked_len, expected_len;
+	uint32_t output_len, out_len;
+
+	for(uint32_t i=0; i<data_size; i++)
+	{
+		data[i] = (int16_t)((i * 7919u) % 2001u) - 1000;
+	}
+
+	/* Reference: two separate passes */
+	status = rank_filter_filter_sequence(data, data_size, rank_window, 2, ranked, &ranked_len);
+	FILTER_ASSERT(status);
+	status = moving_avg_filter_sequence(ranked, ranked_len, avg_window, expected, &expected_len);
+	FILTER_ASSERT(status);
+
+	status = rank_filter_init(&rank_filter, rank_buffer, rank_window, 2);
+	FILTER_ASSERT(status);
+	status = moving_avg_init(&average, FilterLowPass, avg_buffer, avg_window);
+	FILTER_ASSERT(status);
+
+	filter_pipeline_init(&pipeline);
+	status = filter_pipeline_add_rank(&pipeline, &rank_filter);
+	FILTER_ASSERT(status);
+	status = filter_pipeline_add_moving_avg(&pipeline, &average);
+	FILTER_ASSERT(status);
+
+	status = filter_pipeline_get_output_data_len(&pipeline, data_size, &output_len);
+	FILTER_ASSERT(status);
+	assert(output_len == expected_len);
+	assert(filter_pipeline_get_delay(&pipeline) == 3);
+
+	status = filter_pipeline_filter_sequence(&pipeline, data, data_size, out_data, &out_len);
+	FILTER_ASSERT(status);
+	assert(out_len == output_len);
+
+	for(unsigned int i=0; i<out_len; i++)
+	{
+		assert(out_data[i] == expected[i]);
+	}
+
+	/* The same data fed in uneven portions */
+	filter_pipeline_flush(&pipeline);
+
+	uint32_t produced = 0;
+	for(uint32_t offset=0; offset<data_size; offset+=333)
+	{
+		uint32_t len = (data_size - offset < 333) ? data_size - offset : 333;
+
+		status = filter_pipeline_filter_block(&pipeline, data + offset, len, out_data + produced, &out_len);
+		FILTER_ASSERT(status);
+		produced += out_len;
+	}
+
+	assert(produced == output_len);
+	for(unsigned int i=0; i<produced; i++)
+	{
+		assert(out_data[i] == expected[i]);
+	}
+}
+
+
+
+#ifdef FILTER_STATS_ENABLE
+static void test_filter_stats(void)
+{
+	FilterStats_t stats;
+
+	filter_stats_reset();
+
+	test_moving_average_ring_buffer_fifo();
+	test_rank_filter_simple_buffer();
+	test_rank_filter_ring_buffer();
+
+	assert(filter_stats_snapshot(&stats) == FilterOK);
+
+	assert(stats.path[FilterStatsMovingAvgSample].calls == 13);
+	assert(stats.path[FilterStatsRankSequence].calls == 1);
+	assert(stats.path[FilterStatsRankSequence].samples == 14);
+	assert(stats.path[FilterStatsRankSample].calls == 13);
+	assert(stats.rank_scan_len > 0);
+	assert(stats.rank_scan_len_max <= 3);
+	assert(stats.fifo_overflows == 0 && stats.fifo_underflows == 0);
+
+	uint32_t hist_calls = 0;
+	for(unsigned int i=0; i<FILTER_STATS_HIST_BINS; i++)
+	{
+		hist_calls += stats.path[FilterStatsRankSample].cycles_hist[i];
+	}
+	assert(hist_calls == 13);
+}
+#endif
+
+
+
+int main() {
+	cout << "Filters test" << endl; // prints !!!Hello World!!!
+
+	cout << "\n***Testing moving average filter***" << endl;
+
+	cout << "\nTesting moving average with simple buffer" << endl;
+	test_moving_average_simple_buffer();
+	cout << "Simple buffer successfully tested" << endl;
+
+	cout << "\nTesting moving average with fifo" << endl;
+	test_moving_average_ring_buffer_fifo();
+	cout << "Ring buffer successfully tested" << endl;
+
+	cout << "\nTesting moving average accumulator resync" << endl;
+	test_moving_average_resync();
+	cout << "Accumulator resync successfully tested" << endl;
+
+	cout << "\nTesting weighted and exponential moving averages" << endl;
+	test_weighted_exp_moving_average();
+	cout << "Weighted and exponential moving averages successfully tested" << endl;
+
+	cout << "\n***Testing rank filter***" << endl;
+
+	cout << "\nTesting rank filter with simple buffer" << endl;
+	test_rank_filter_simple_buffer();
+	cout << "Successfully tested simple buffer" << endl;
+
+	cout << "\nTesting rank filter with small windows" << endl;
+	test_rank_filter_small_windows();
+	cout << "Successfully tested small windows" << endl;
+
+	cout << "\nTesting rank filter with ring buffer" << endl;
+	test_rank_filter_ring_buffer();
+	cout << "Successfully tested ring buffer" << endl;
+
+	cout << "\nTesting rank filter with multiple ranks" << endl;
+	test_rank_filter_multi_rank();
+	cout << "Successfully tested multiple ranks" << endl;
+
+	cout << "\nTesting trimmed mean filter" << endl;
+	test_trimmed_mean();
+	cout << "Trimmed mean filter successfully tested" << endl;
+
+	cout << "\nTesting Hampel filter" << endl;
+	test_hampel();
+	cout << "Hampel filter successfully tested" << endl;
+
+	cout << "\nTesting multi window moving average" << endl;
+	test_moving_avg_multi_window();
+	cout << "Multi window moving average successfully tested" << endl;
+
+	cout << "\nTesting rolling statistics" << endl;
+	test_rolling_stats();
+	cout << "Rolling statistics successfully tested" << endl;
+
+	cout << "\nTesting prefix sum index" << endl;
+	test_prefix_sum_index();
+	cout << "Prefix sum index successfully tested" << endl;
+
+	cout << "\nTesting wavelet index" << endl;
+	test_wavelet_index();
+	cout << "Wavelet index successfully tested" << endl;
+
+	cout << "\nTesting approximate rank filter" << endl;
+	test_approx_rank_filter();
+	cout << "Approximate rank filter successfully tested" << endl;
+
+	cout << "\nTesting sliding DFT" << endl;
+	test_sliding_dft();
+	cout << "Sliding DFT successfully tested" << endl;
+
+	cout << "\nTesting resampler" << endl;
+	test_resampler();
+	cout << "Resampler successfully tested" << endl;
+
+	cout << "\nTesting spatial filters" << endl;
+	test_spatial_filter();
+	cout << "Spatial filters successfully tested" << endl;
+
+	cout << "\nTesting decimated rank filter" << endl;
+	test_rank_filter_decimated();
+	cout << "Decimated rank filter successfully tested" << endl;
+
+	cout << "\nTesting filter backends" << endl;
+	test_filter_backends();
+	cout << "Filter backends successfully tested" << endl;
+
+	cout << "\nTesting 2D filters" << endl;
+	test_filter_2d();
+	cout << "2D filters successfully tested" << endl;
+
+	cout << "\nTesting warm-up output mode" << endl;
+	test_filter_warmup();
+	cout << "Warm-up output mode successfully tested" << endl;
+
+	cout << "\nTesting runtime window resize" << endl;
+	test_filter_resize();
+	cout << "Runtime window resize successfully tested" << endl;
+
+	cout << "\nTesting filter state checkpoint" << endl;
+	test_filter_state_checkpoint();
+	cout << "Filter state checkpoint successfully tested" << endl;
+
+	cout << "\nTesting padded sequences" << endl;
+	test_padded_sequences();
+	cout << "Padded sequences successfully tested" << endl;
+
+	cout << "\n***Testing filter pipeline***" << endl;
+	test_filter_pipeline();
+	cout << "Filter pipeline successfully tested" << endl;
+
+#ifdef FILTER_STATS_ENABLE
+	cout << "\n***Testing instrumentation***" << endl;
+	test_filter_stats();
+	cout << "Instrumentation successfully tested" << endl;
+#endif
+
+#ifdef FILTER_AUTOTUNE_ENABLE
+	cout << "\n***Testing autotune***" << endl;
+	test_filter_autotune();
+	cout << "Autotune successfully tested" << endl;
+#endif
 
 	return 0;
 }
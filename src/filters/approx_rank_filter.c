@@ -0,0 +1,355 @@
+/*
+ * approx_rank_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call approx_rank_filter_init(...) on your filter handle with window size, rank and allowed rank
+ *              error in permille of window size.
+ *      2. Call approx_rank_filter_filter_sample(...) on each new sample or approx_rank_filter_filter_block(...)
+ *              on blocks of samples.
+ *      3. Call approx_rank_filter_deinit(...) to release filter memory.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          Call approx_rank_filter_flush(...)
+ *
+ *  Filter outputs a sample for every input sample. While the first window is not collected rank is scaled
+ *  to the number of collected samples, as in warm-up mode of rank filter.
+ *
+ *  Output sample is a window sample whose rank differs from requested one by about
+ *  error * window_size, error = error_permille / 1000.
+ *
+ *  Memory depends on both window size and error: the current block takes error * window_size / 2 samples,
+ *  block summaries take about min(window_size, 4 / error^2) samples (up to 8 MB at error_permille = 1) and
+ *  value bins take 256 KB. approx_rank_filter_get_memory_size(...) returns exact number.
+ *  approx_rank_filter_init(...) rejects configurations which take more memory than exact RankFilter_t,
+ *  that is 2 * window_size samples of window buffer and sorted window. Depending on error, windows from
+ *  about 70 000 to 130 000 samples up are accepted.
+ *
+ *   Algorithm:
+ *      1. Samples are collected into blocks of B = error * window_size / 2 samples. Samples of the current
+ *              block are counted in value bins exactly.
+ *      2. Completed block is sorted and replaced in bins by S = min(B, 2 / error) quantile points, point j
+ *              stands for sorted block samples [j * B / S, (j + 1) * B / S). Only points are stored.
+ *      3. Block is removed from bins once all its samples are out of window, so bins hold the window plus
+ *              less than B expired samples.
+ *      4. Bins are a Fenwick tree. Adding a weight and finding the sample of a given rank cost 16 steps.
+ *              Requested rank is scaled to the total weight held in bins.
+ *
+ *      Each stored block moves ranks by at most B / S, the expired samples by less than B, so the total error
+ *      is below error * window_size plus one block point. Cost per sample is O(log(B)) amortized.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "approx_rank_filter.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static void approx_rank_filter_get_layout(uint32_t window_size, uint16_t error_permille, uint32_t *block_size,
+		uint32_t *summary_len, uint32_t *blocks_num);
+static uint64_t approx_rank_filter_get_layout_size(uint32_t block_size, uint32_t summary_len, uint32_t blocks_num);
+static void approx_rank_filter_complete_block(ApproxRankFilter_t *filter);
+static void approx_rank_filter_expire_blocks(ApproxRankFilter_t *filter);
+static inline uint32_t approx_rank_filter_point_weight(uint32_t block_size, uint32_t summary_len, uint32_t j);
+static inline void approx_rank_filter_tree_add(uint32_t *tree, int16_t value, int32_t weight);
+static inline int16_t approx_rank_filter_tree_find(const uint32_t *tree, uint32_t rank);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes approximate rank filter
+ * @param	filter			-	filter handle
+ * @param	window_size		-	filter window size
+ * @param	rank			-	filter rank, less than window size
+ * @param	error_permille	-	allowed rank error in permille of window size, 1..1000
+ *
+ * @return	Filter status. FilterError if filter would take more memory than exact RankFilter_t.
+ */
+FilterStatus_t approx_rank_filter_init(ApproxRankFilter_t *filter, uint32_t window_size, uint32_t rank,
+		uint16_t error_permille)
+{
+	if(window_size == 0 || rank >= window_size || error_permille == 0 || error_permille > 1000)
+	{
+		return FilterError;
+	}
+
+	filter->window_size = window_size;
+	filter->rank = rank;
+
+	approx_rank_filter_get_layout(window_size, error_permille, &filter->block_size, &filter->summary_len,
+			&filter->blocks_num);
+
+	if(approx_rank_filter_get_layout_size(filter->block_size, filter->summary_len, filter->blocks_num) >=
+			2 * (uint64_t)window_size * sizeof(int16_t))
+	{
+		return FilterError;
+	}
+
+	filter->summaries = _malloc((size_t)filter->blocks_num * filter->summary_len * sizeof *filter->summaries);
+	filter->block = _malloc(filter->block_size * sizeof *filter->block);
+	filter->tree = _malloc((APPROX_RANK_FILTER_BINS + 1) * sizeof *filter->tree);
+
+	if(filter->summaries == NULL || filter->block == NULL || filter->tree == NULL)
+	{
+		approx_rank_filter_deinit(filter);
+		return FilterError;
+	}
+
+	approx_rank_filter_flush(filter);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Returns memory allocated by filter with given parameters in bytes.
+ * @note	Grows with window_size as error * window_size / 2 samples plus min(window_size, 4 / error^2) samples.
+ * 				Compare it with 2 * window_size * sizeof(int16_t) of exact RankFilter_t before choosing the filter,
+ * 				approx_rank_filter_init(...) fails if it is not smaller. Saturates at UINT32_MAX.
+ */
+uint32_t approx_rank_filter_get_memory_size(uint32_t window_size, uint16_t error_permille)
+{
+	uint32_t block_size, summary_len, blocks_num;
+
+	if(window_size == 0 || error_permille == 0 || error_permille > 1000)
+	{
+		return 0;
+	}
+
+	approx_rank_filter_get_layout(window_size, error_permille, &block_size, &summary_len, &blocks_num);
+
+	uint64_t size = approx_rank_filter_get_layout_size(block_size, summary_len, blocks_num);
+
+	return (size > UINT32_MAX) ? UINT32_MAX : (uint32_t)size;
+}
+
+
+/**
+ * @brief	    Computes the next filtered sample.
+ *
+ * @param[in]	filter	    -   filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	        -	pointer to where filtered sample will be written.
+ *
+ * @return	    Filter error status
+ */
+FilterStatus_t approx_rank_filter_filter_sample(ApproxRankFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	filter->block[filter->block_fill++] = new_sample;
+	filter->total++;
+	approx_rank_filter_tree_add(filter->tree, new_sample, 1);
+
+	if(filter->block_fill == filter->block_size)
+	{
+		approx_rank_filter_complete_block(filter);
+	}
+
+	approx_rank_filter_expire_blocks(filter);
+
+	uint32_t rank = filter->rank;
+
+	if(filter->window_size > 1)
+	{
+		rank = (uint64_t)filter->rank * (filter->total - 1) / (filter->window_size - 1);
+	}
+
+	*y = approx_rank_filter_tree_find(filter->tree, rank);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples keeping filter state between calls.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples, always data_len.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t approx_rank_filter_filter_block(ApproxRankFilter_t *filter, int16_t *data, uint16_t data_len,
+		int16_t *y, uint16_t *y_len)
+{
+	for(uint16_t i=0; i<data_len; i++)
+	{
+		approx_rank_filter_filter_sample(filter, data[i], &y[i]);
+	}
+
+	*y_len = data_len;
+
+	return FilterOK;
+}
+
+
+void approx_rank_filter_flush(ApproxRankFilter_t *filter)
+{
+	memset(filter->tree, 0, (APPROX_RANK_FILTER_BINS + 1) * sizeof *filter->tree);
+
+	filter->total = 0;
+	filter->block_fill = 0;
+	filter->blocks_head = 0;
+	filter->blocks_count = 0;
+}
+
+
+void approx_rank_filter_deinit(ApproxRankFilter_t *filter)
+{
+	_free(filter->summaries);
+	_free(filter->block);
+	_free(filter->tree);
+
+	filter->summaries = NULL;
+	filter->block = NULL;
+	filter->tree = NULL;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Splits allowed error between expired samples and block points, half to each.
+ *
+ * @param	window_size		-	window size
+ * @param	error_permille	-	allowed rank error in permille of window size
+ * @param	block_size		-	samples per block
+ * @param	summary_len		-	points per completed block
+ * @param	blocks_num		-	completed blocks ring capacity
+ */
+static void approx_rank_filter_get_layout(uint32_t window_size, uint16_t error_permille, uint32_t *block_size,
+		uint32_t *summary_len, uint32_t *blocks_num)
+{
+	uint32_t size = (uint64_t)window_size * error_permille / 2000;
+	uint32_t points = (2000 + error_permille - 1) / error_permille;
+
+	*block_size = (size > 0) ? size : 1;
+	*summary_len = (points < *block_size) ? points : *block_size;
+
+	/* Window touches at most ceil(W / B) completed blocks, one more is held until it expires */
+	*blocks_num = (window_size + *block_size - 1) / *block_size + 1;
+}
+
+
+/**
+ * @brief	Returns bytes taken by summaries ring, current block and value bins.
+ */
+static uint64_t approx_rank_filter_get_layout_size(uint32_t block_size, uint32_t summary_len, uint32_t blocks_num)
+{
+	return ((uint64_t)blocks_num * summary_len + block_size) * sizeof(int16_t)
+			+ (APPROX_RANK_FILTER_BINS + 1) * sizeof(uint32_t);
+}
+
+
+/**
+ * @brief	Replaces samples of the current block in bins with its quantile points.
+ */
+static void approx_rank_filter_complete_block(ApproxRankFilter_t *filter)
+{
+	const uint32_t block_size = filter->block_size;
+	const uint32_t summary_len = filter->summary_len;
+
+	uint32_t slot = filter->blocks_head + filter->blocks_count;
+	if(slot >= filter->blocks_num)
+	{
+		slot -= filter->blocks_num;
+	}
+
+	int16_t *summary = &filter->summaries[(size_t)slot * summary_len];
+
+	if(summary_len == block_size)
+	{
+		/* Every sample is its own point, bins already hold them */
+		memcpy(summary, filter->block, block_size * sizeof *summary);
+	}
+	else
+	{
+		qsort(filter->block, block_size, sizeof *filter->block, filter_sort_cmp);
+
+		for(uint32_t i=0; i<block_size; i++)
+		{
+			approx_rank_filter_tree_add(filter->tree, filter->block[i], -1);
+		}
+
+		for(uint32_t j=0; j<summary_len; j++)
+		{
+			summary[j] = filter->block[(uint64_t)(2*j + 1) * block_size / (2 * summary_len)];
+			approx_rank_filter_tree_add(filter->tree, summary[j],
+					approx_rank_filter_point_weight(block_size, summary_len, j));
+		}
+	}
+
+	filter->blocks_count++;
+	filter->block_fill = 0;
+}
+
+
+/**
+ * @brief	Removes the oldest completed blocks which have no samples in window.
+ */
+static void approx_rank_filter_expire_blocks(ApproxRankFilter_t *filter)
+{
+	const uint32_t block_size = filter->block_size;
+	const uint32_t summary_len = filter->summary_len;
+
+	while(filter->blocks_count != 0 &&
+			filter->block_fill + (uint64_t)(filter->blocks_count - 1) * block_size >= filter->window_size)
+	{
+		const int16_t *summary = &filter->summaries[(size_t)filter->blocks_head * summary_len];
+
+		for(uint32_t j=0; j<summary_len; j++)
+		{
+			approx_rank_filter_tree_add(filter->tree, summary[j],
+					-(int32_t)approx_rank_filter_point_weight(block_size, summary_len, j));
+		}
+
+		filter->total -= block_size;
+		filter->blocks_head = (filter->blocks_head + 1 == filter->blocks_num) ? 0 : filter->blocks_head + 1;
+		filter->blocks_count--;
+	}
+}
+
+
+/**
+ * @brief	Returns number of block samples point j stands for. Weights of all points sum to block size.
+ */
+static inline uint32_t approx_rank_filter_point_weight(uint32_t block_size, uint32_t summary_len, uint32_t j)
+{
+	return (uint64_t)(j + 1) * block_size / summary_len - (uint64_t)j * block_size / summary_len;
+}
+
+
+static inline void approx_rank_filter_tree_add(uint32_t *tree, int16_t value, int32_t weight)
+{
+	for(uint32_t i=((uint16_t)value ^ 0x8000u) + 1; i<=APPROX_RANK_FILTER_BINS; i+=i & (0u - i))
+	{
+		tree[i] += weight;
+	}
+}
+
+
+/**
+ * @brief	Returns value of the sample of given rank, 0 is the smallest one.
+ */
+static inline int16_t approx_rank_filter_tree_find(const uint32_t *tree, uint32_t rank)
+{
+	uint32_t pos = 0;
+
+	for(uint32_t step=APPROX_RANK_FILTER_BINS; step!=0; step>>=1)
+	{
+		if(pos + step <= APPROX_RANK_FILTER_BINS && tree[pos + step] <= rank)
+		{
+			pos += step;
+			rank -= tree[pos];
+		}
+	}
+
+	return (int16_t)(pos ^ 0x8000u);
+}
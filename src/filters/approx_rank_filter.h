@@ -0,0 +1,64 @@
+/*
+ * approx_rank_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_APPROX_RANK_FILTER_H_
+#define SRC_MOD_FILTERS_APPROX_RANK_FILTER_H_
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Number of value bins, one per int16 value
+ */
+#define APPROX_RANK_FILTER_BINS     65536u
+
+
+typedef struct approx_rank_filter {
+
+	uint32_t	window_size;
+	uint32_t	rank;
+
+	/* Samples per block and quantile points kept per completed block */
+	uint32_t	block_size;
+	uint32_t	summary_len;
+
+	/* Ring of completed block summaries */
+	uint32_t	blocks_num;
+	uint32_t	blocks_head;
+	uint32_t	blocks_count;
+	int16_t		*summaries;
+
+	/* Current block */
+	int16_t		*block;
+	uint32_t	block_fill;
+
+	/* Fenwick tree of weights over sample values and total weight */
+	uint32_t	*tree;
+	uint32_t	total;
+
+} ApproxRankFilter_t;
+
+
+FilterStatus_t  approx_rank_filter_init(ApproxRankFilter_t *filter, uint32_t window_size, uint32_t rank,
+        uint16_t error_permille);
+uint32_t        approx_rank_filter_get_memory_size(uint32_t window_size, uint16_t error_permille);
+FilterStatus_t  approx_rank_filter_filter_sample(ApproxRankFilter_t *filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  approx_rank_filter_filter_block(ApproxRankFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
+void            approx_rank_filter_flush(ApproxRankFilter_t *filter);
+void            approx_rank_filter_deinit(ApproxRankFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_APPROX_RANK_FILTER_H_ */
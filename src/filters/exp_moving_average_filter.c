@@ -0,0 +1,266 @@
+/*
+ * exp_moving_average_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call exp_moving_avg_init(...) on your filter handle
+ *      2. Call exp_moving_avg_filter_sample(...) on each new sample. The first sample initializes average,
+ *              so no buffer has to be filled.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          3. Call exp_moving_avg_flush(...)
+ *
+ *  Instead of 2 you can feed blocks of samples with exp_moving_avg_filter_block(...).
+ *  It outputs one sample per input sample.
+ *
+ *  You can also filter prepared sequence with exp_moving_avg_filter_sequence(...).
+ *
+ *  Smoothing factor alpha is Q15 number. exp_moving_avg_alpha_from_window(...) returns alpha = 2 / (N + 1)
+ *  which gives the same center of mass as moving average of N samples.
+ *
+ *   Algorithm:
+ *      1. EMA:     e[n] = e[n-1] + alpha * (x[n] - e[n-1])
+ *      2. DEMA:    e2[n] = e2[n-1] + alpha * (e[n] - e2[n-1]), output is 2 * e[n] - e2[n]
+ *      3. Averages are kept in Q15 so slow averages do not get stuck because of rounding.
+ *              Products are computed in 64 bits.
+ *      4. In case of HighPass filter returns the new sample minus low pass sample.
+ */
+
+
+#include <stdlib.h>
+
+#include "exp_moving_average_filter.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline int32_t exp_moving_avg_step(int32_t ema, int32_t target, uint16_t alpha);
+static inline int16_t exp_moving_avg_output(int16_t current_sample, int32_t ema, int32_t ema2,
+		ExpMovingAverageOrder_t order, FilterType_t ftype);
+static void exp_moving_avg_kernel(ExpMovingAverageFilter_t *filter, const int16_t *data, uint16_t data_len,
+		int16_t *y);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes exponential moving average filter
+ * @param	filter		-	filter handle
+ * @param	ftype		-	low pass or high pass
+ * @param	order		-	single (EMA) or double (DEMA) exponential average
+ * @param   alpha		-	smoothing factor in Q15. Must be in range [1, EXP_MOVING_AVG_ALPHA_ONE]
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t exp_moving_avg_init(ExpMovingAverageFilter_t *filter, FilterType_t ftype,
+		ExpMovingAverageOrder_t order, uint16_t alpha)
+{
+	if(alpha == 0 || alpha > EXP_MOVING_AVG_ALPHA_ONE)
+	{
+		return FilterError;
+	}
+
+	filter->alpha = alpha;
+	filter->order = order;
+	filter->type = ftype;
+
+	filter->ema = 0;
+	filter->ema2 = 0;
+	filter->initialized = 0;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Returns alpha with the same lag as moving average of given window.
+ *
+ * @param[in]   window_size -   moving average window size
+ *
+ * @return      Q15 alpha = 2 / (window_size + 1)
+ */
+uint16_t exp_moving_avg_alpha_from_window(uint16_t window_size)
+{
+	if(window_size == 0)
+	{
+		return EXP_MOVING_AVG_ALPHA_ONE;
+	}
+
+	return (2u * EXP_MOVING_AVG_ALPHA_ONE) / ((uint32_t)window_size + 1);
+}
+
+
+/**
+ * @brief	Produces one output sample.
+ *
+ * @param[in]	    filter	-	filter handle
+ * @param[in]       new_sample  -   new raw sample.
+ * @param[out]  	y	-	variable where sample will be saved.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t exp_moving_avg_filter_sample(ExpMovingAverageFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	exp_moving_avg_kernel(filter, &new_sample, 1, y);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   input samples
+ * @param[in]   data_len    -   number of input samples
+ * @param[out]  y           -   output samples. Must have space for data_len samples.
+ * @param[out]  y_len       -   number of produced samples. Always equal to data_len.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t exp_moving_avg_filter_block(ExpMovingAverageFilter_t *filter, int16_t *data, uint16_t data_len,
+		int16_t *y, uint16_t *y_len)
+{
+	exp_moving_avg_kernel(filter, data, data_len, y);
+	*y_len = data_len;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Filters sequence of samples.
+ *
+ * @param	data		-	pointer to data
+ * @param	data_size	-	size of data
+ * @param	order		-	single (EMA) or double (DEMA) exponential average
+ * @param	alpha		-	smoothing factor in Q15
+ * @param	y			-	pointer to output buffer. Must have space for data_size samples.
+ * @param	y_data_len	-	output data length. Always equal to data_size.
+ *
+ * @return	Filter error status
+ */
+FilterStatus_t exp_moving_avg_filter_sequence(int16_t *data, uint16_t data_size, ExpMovingAverageOrder_t order,
+		uint16_t alpha, int16_t *y, uint16_t *y_data_len)
+{
+	ExpMovingAverageFilter_t filter;
+
+	if(exp_moving_avg_init(&filter, FilterLowPass, order, alpha) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	return exp_moving_avg_filter_block(&filter, data, data_size, y, y_data_len);
+}
+
+
+/**
+ * @brief       Resets filter. The next sample initializes average again.
+ *
+ * @param[in]   filter  -   filter handle
+ */
+void exp_moving_avg_flush(ExpMovingAverageFilter_t *filter)
+{
+	filter->initialized = 0;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Moves Q15 average towards Q15 target by alpha.
+ */
+static inline int32_t exp_moving_avg_step(int32_t ema, int32_t target, uint16_t alpha)
+{
+	int64_t delta = (int64_t)alpha * ((int64_t)target - ema);
+
+	return ema + (int32_t)(delta >> EXP_MOVING_AVG_ALPHA_SHIFT);
+}
+
+
+/**
+ * @brief	Converts Q15 averages into output sample.
+ */
+static inline int16_t exp_moving_avg_output(int16_t current_sample, int32_t ema, int32_t ema2,
+		ExpMovingAverageOrder_t order, FilterType_t ftype)
+{
+	int64_t avg = (order == ExpMovingAverageDouble) ? 2*(int64_t)ema - ema2 : ema;
+	int32_t sample = (int32_t)((avg + (1 << (EXP_MOVING_AVG_ALPHA_SHIFT - 1))) >> EXP_MOVING_AVG_ALPHA_SHIFT);
+
+	if(ftype == FilterHighPass)
+	{
+		sample = (int32_t)current_sample - sample;
+	}
+
+	/* DEMA overshoots on steps */
+	if(sample > INT16_MAX)
+	{
+		sample = INT16_MAX;
+	}
+	else if(sample < INT16_MIN)
+	{
+		sample = INT16_MIN;
+	}
+
+	return sample;
+}
+
+
+/**
+ * @brief	Filters samples keeping filter state in locals. Each output depends on the previous one
+ * 				so samples are processed one after another.
+ *
+ * @param	filter		-	filter handle
+ * @param	data		-	input samples
+ * @param	data_len	-	number of samples
+ * @param	y			-	output samples
+ */
+static void exp_moving_avg_kernel(ExpMovingAverageFilter_t *filter, const int16_t *data, uint16_t data_len,
+		int16_t *y)
+{
+	const uint16_t alpha = filter->alpha;
+	const ExpMovingAverageOrder_t order = filter->order;
+	const FilterType_t ftype = filter->type;
+
+	int32_t ema = filter->ema;
+	int32_t ema2 = filter->ema2;
+	uint16_t i = 0;
+
+	if(data_len == 0)
+	{
+		return;
+	}
+
+	if(!filter->initialized)
+	{
+		ema = (int32_t)data[0] * (int32_t)EXP_MOVING_AVG_ALPHA_ONE;
+		ema2 = ema;
+		y[i] = exp_moving_avg_output(data[0], ema, ema2, order, ftype);
+
+		filter->initialized = 1;
+		i++;
+	}
+
+	if(order == ExpMovingAverageDouble)
+	{
+		for(; i<data_len; i++)
+		{
+			ema = exp_moving_avg_step(ema, (int32_t)data[i] * (int32_t)EXP_MOVING_AVG_ALPHA_ONE, alpha);
+			ema2 = exp_moving_avg_step(ema2, ema, alpha);
+			y[i] = exp_moving_avg_output(data[i], ema, ema2, order, ftype);
+		}
+	}
+	else
+	{
+		for(; i<data_len; i++)
+		{
+			ema = exp_moving_avg_step(ema, (int32_t)data[i] * (int32_t)EXP_MOVING_AVG_ALPHA_ONE, alpha);
+			y[i] = exp_moving_avg_output(data[i], ema, ema, order, ftype);
+		}
+	}
+
+	filter->ema = ema;
+	filter->ema2 = ema2;
+}
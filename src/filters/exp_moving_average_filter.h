@@ -0,0 +1,57 @@
+/*
+ * exp_moving_average_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_EXP_MOVING_AVERAGE_FILTER_H_
+#define SRC_MOD_FILTERS_EXP_MOVING_AVERAGE_FILTER_H_
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Smoothing factor is Q15 number in range (0, 1]
+ */
+#define EXP_MOVING_AVG_ALPHA_SHIFT  15
+#define EXP_MOVING_AVG_ALPHA_ONE    (1u << EXP_MOVING_AVG_ALPHA_SHIFT)
+
+
+typedef enum {ExpMovingAverageSingle=0, ExpMovingAverageDouble} ExpMovingAverageOrder_t;
+
+
+typedef struct exp_moving_average_filter {
+
+	uint16_t				alpha;
+	ExpMovingAverageOrder_t	order;
+	FilterType_t			type;
+
+	/* Q15 averages */
+	int32_t					ema;
+	int32_t					ema2;
+	uint8_t					initialized;
+
+} ExpMovingAverageFilter_t;
+
+
+FilterStatus_t  exp_moving_avg_init(ExpMovingAverageFilter_t *filter, FilterType_t ftype,
+        ExpMovingAverageOrder_t order, uint16_t alpha);
+uint16_t        exp_moving_avg_alpha_from_window(uint16_t window_size);
+FilterStatus_t  exp_moving_avg_filter_sample(ExpMovingAverageFilter_t *filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  exp_moving_avg_filter_block(ExpMovingAverageFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
+FilterStatus_t  exp_moving_avg_filter_sequence(int16_t *data, uint16_t data_size, ExpMovingAverageOrder_t order,
+        uint16_t alpha, int16_t *y, uint16_t *y_data_len);
+void            exp_moving_avg_flush(ExpMovingAverageFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_EXP_MOVING_AVERAGE_FILTER_H_ */
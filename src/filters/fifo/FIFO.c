@@ -94,6 +94,35 @@ FIFO_error_t FIFO_write(FIFO_t *fifo, void *pData, uint16_t len, uint16_t *iw)
 }
 
 
+/*!
+ @brief  Copies items from the FIFO without removing them.
+
+ @param  fifo - pointer to the FIFO structure.
+ @param  pData - pointer to copy data to.
+ @param  offset - number of items to skip from the oldest one.
+ @param  len - number of items to copy.
+
+ @retval FIFO_OK - on success.
+ @retval FIFO_UNDERFLOW - FIFO holds less than offset + len items.
+ */
+FIFO_error_t FIFO_peek(FIFO_t *fifo, void *pData, uint16_t offset, uint16_t len)
+{
+    return FIFO8_peek(&fifo->fifo8, pData, offset * fifo->item_size, len * fifo->item_size);
+}
+
+/*!
+ @brief  Replaces FIFO content with given items.
+
+ @param  fifo - pointer to the FIFO structure.
+ @param  pData - items, the oldest first.
+ @param  len - number of items. Must not exceed FIFO size.
+ */
+void FIFO_load(FIFO_t *fifo, const void *pData, uint16_t len)
+{
+    FIFO8_load(&fifo->fifo8, pData, len * fifo->item_size);
+}
+
+
 /**
  * @brief	Return first item id in the buffer. Useful when using LOOP mode and have to process new samples on fly.
  * @note	Return the first sample in the STRAIGHTENED buffer. Not the next sample's id which will be read from FIFO.
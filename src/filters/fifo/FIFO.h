@@ -33,6 +33,8 @@ void FIFO_init(FIFO_t *fifo, uint8_t *buffer, uint16_t fifo_size,
         uint16_t item_size, uint8_t flags);
 FIFO_error_t FIFO_read(FIFO_t *fifo, void *pData, uint16_t len, uint16_t *ir);
 FIFO_error_t FIFO_write(FIFO_t *fifo, void *pData, uint16_t len, uint16_t *iw);
+FIFO_error_t FIFO_peek(FIFO_t *fifo, void *pData, uint16_t offset, uint16_t len);
+void FIFO_load(FIFO_t *fifo, const void *pData, uint16_t len);
 void FIFO_get_first_item(FIFO_t *fifo, void *item);
 void FIFO_get_middle_item(FIFO_t *fifo, void *item);
 void FIFO_get_last_item(FIFO_t *fifo, void *item);
@@ -185,6 +185,60 @@ FIFO_error_t FIFO8_write(FIFO8_t *pFIFO, FIFO_TYPE *pData, uint16_t len,
     return RetVal;
 }
 
+/*!
+ @brief  Copies data from the FIFO without removing it.
+
+ @param  pFIFO - pointer to the FIFO structure.
+ @param  pData - pointer to copy data to.
+ @param  offset - number of bytes to skip from the read position.
+ @param  len - length of data to copy.
+
+ @retval FIFO_OK - on success.
+ @retval FIFO_UNDERFLOW - FIFO holds less than offset + len bytes, nothing is copied.
+ */
+FIFO_error_t FIFO8_peek(FIFO8_t *pFIFO, FIFO_TYPE *pData, uint16_t offset,
+        uint16_t len)
+{
+    if((uint32_t)offset + len > pFIFO->counter)
+    {
+        return FIFO_UNDERFLOW;
+    }
+
+    uint32_t start = (uint32_t)pFIFO->r_index + offset;
+    if(start >= pFIFO->FIFO_size)
+    {
+        start -= pFIFO->FIFO_size;
+    }
+
+    uint32_t first_part = pFIFO->FIFO_size - start;
+    if(first_part > len)
+    {
+        first_part = len;
+    }
+
+    memcpy(pData, pFIFO->pBuffer + start, first_part);
+    memcpy(pData + first_part, pFIFO->pBuffer, len - first_part);
+
+    return FIFO_OK;
+}
+
+/*!
+ @brief  Replaces FIFO content with given data.
+ @note   Data is copied to the beginning of the buffer with one memcpy.
+
+ @param  pFIFO - pointer to the FIFO structure.
+ @param  pData - pointer to data.
+ @param  len - length of data. Must not exceed FIFO size.
+ */
+void FIFO8_load(FIFO8_t *pFIFO, const FIFO_TYPE *pData, uint16_t len)
+{
+    memcpy(pFIFO->pBuffer, pData, len);
+
+    pFIFO->counter = len;
+    pFIFO->r_index = 0;
+    pFIFO->w_index = (len == pFIFO->FIFO_size) ? 0 : len;
+}
+
 /*!
  @brief    Gets bytes count stored in the FIFO.
  @note     
@@ -33,6 +33,10 @@ FIFO_error_t FIFO8_read(FIFO8_t *pFIFO, FIFO_TYPE *pData, uint16_t len,
 FIFO_error_t FIFO8_write(FIFO8_t *pFIFO, FIFO_TYPE *pData, uint16_t len,
         uint16_t *bw);
 
+FIFO_error_t FIFO8_peek(FIFO8_t *pFIFO, FIFO_TYPE *pData, uint16_t offset,
+        uint16_t len);
+void FIFO8_load(FIFO8_t *pFIFO, const FIFO_TYPE *pData, uint16_t len);
+
 uint16_t FIFO8_get_data_count(FIFO8_t *pFIFO);
 uint16_t FIFO8_get_free_space(FIFO8_t *pFIFO);
 bool FIFO8_is_enough_free_space(FIFO8_t *pFIFO, uint16_t len);
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "filter.h"
 
@@ -47,11 +48,146 @@ uint32_t filter_windowed_get_expected_output_len(uint32_t data_len, uint32_t win
 }
 
 
+/**
+ * @brief	Comparison function of int16 samples for qsort.
+ */
+int filter_sort_cmp(const void *pdata1, const void *pdata2)
+{
+	return (*(const int16_t*)pdata1 - *(const int16_t*)pdata2);
+}
+
+
+/**
+ * @brief	Returns frame size filtered with 2D window method (valid region).
+ */
+FilterStatus_t filter_2d_get_output_size(uint16_t width, uint16_t height, uint16_t kernel_width,
+		uint16_t kernel_height, uint16_t *y_width, uint16_t *y_height)
+{
+	if(kernel_width == 0 || kernel_height == 0 || kernel_width > width || kernel_height > height)
+	{
+		return FilterError;
+	}
+
+	*y_width = filter_windowed_get_expected_output_len(width, kernel_width);
+	*y_height = filter_windowed_get_expected_output_len(height, kernel_height);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Returns number of samples in the window before output sample.
+ */
+uint32_t filter_edge_get_left_len(uint32_t window_size, FilterAlignment_t alignment)
+{
+	return (alignment == FilterAlignCentered) ? (window_size - 1) / 2 : window_size - 1;
+}
+
 
+/**
+ * @brief	Returns sample of a sequence extended according to padding policy.
+ *
+ * @param	data		-	sequence
+ * @param	data_size	-	sequence length. Must be > 0.
+ * @param	idx			-	sample index, can be outside of the sequence
+ * @param	edge		-	edge handling configuration
+ *
+ * @return	Sample
+ */
+int16_t filter_edge_get_sample(const int16_t *data, uint32_t data_size, int32_t idx, const FilterEdgeConfig_t *edge)
+{
+	int32_t n = data_size;
+	int32_t period;
+
+	if(idx >= 0 && idx < n)
+	{
+		return data[idx];
+	}
+
+	switch(edge->padding)
+	{
+	case FilterPadConstant:
+		return edge->pad_value;
+
+	case FilterPadReplicate:
+		return (idx < 0) ? data[0] : data[n-1];
+
+	case FilterPadWrap:
+		idx %= n;
+		return data[(idx < 0) ? idx + n : idx];
+
+	case FilterPadReflect:
+	default:
+		if(n == 1)
+		{
+			return data[0];
+		}
+
+		period = 2*(n - 1);
+		idx %= period;
+
+		if(idx < 0)
+		{
+			idx += period;
+		}
+
+		return data[(idx < n) ? idx : period - idx];
+	}
+}
 
 
+/**
+ * @brief	Writes filter state checkpoint header.
+ *
+ * @param	buf			-	checkpoint buffer
+ * @param	kind		-	filter kind
+ * @param	window_size	-	filter window size
+ * @param	items_num	-	number of samples stored in the window
+ * @param	size		-	whole checkpoint size including header
+ */
+void filter_state_write_header(uint8_t *buf, FilterStateKind_t kind, uint16_t window_size,
+		uint16_t items_num, uint32_t size)
+{
+	FilterStateHeader_t header;
 
+	header.magic = FILTER_STATE_MAGIC;
+	header.version = FILTER_STATE_VERSION;
+	header.kind = kind;
+	header.window_size = window_size;
+	header.items_num = items_num;
+	header.size = size;
 
+	memcpy(buf, &header, sizeof header);
+}
 
 
+/**
+ * @brief	Reads and validates filter state checkpoint header.
+ *
+ * @param	buf			-	checkpoint buffer
+ * @param	buf_size	-	checkpoint buffer length
+ * @param	kind		-	expected filter kind
+ * @param	window_size	-	expected window size
+ * @param	header		-	pointer where header will be stored
+ *
+ * @return	FilterError if checkpoint does not match filter.
+ */
+FilterStatus_t filter_state_read_header(const uint8_t *buf, uint32_t buf_size, FilterStateKind_t kind,
+		uint16_t window_size, FilterStateHeader_t *header)
+{
+	if(buf_size < sizeof *header)
+	{
+		return FilterError;
+	}
+
+	memcpy(header, buf, sizeof *header);
 
+	if(header->magic != FILTER_STATE_MAGIC || header->version != FILTER_STATE_VERSION
+			|| header->kind != kind || header->window_size != window_size
+			|| header->items_num > window_size || header->size > buf_size)
+	{
+		return FilterError;
+	}
+
+	return FilterOK;
+}
@@ -19,6 +19,17 @@ extern "C" {
  * Redefine malloc if needed
  */
 #define	_malloc	malloc
+#define	_free	free
+
+/**
+ * Library version. Caches of measured data, i.e. autotune cache, are invalidated when it changes.
+ */
+#define FILTER_LIBRARY_VERSION	"1.6.0"
+
+/**
+ * Pi for coefficient design. M_PI is not defined in ISO C mode.
+ */
+#define FILTER_PI	3.14159265358979323846
 
 typedef enum {FilterLowPass, FilterHighPass} FilterType_t;
 
@@ -27,6 +38,68 @@ typedef enum {FilterOK=0, FilterError} FilterStatus_t;
 typedef enum {FilterRingBuffer=0, FilterSimpleBuffer} FilterBufferType_t;
 
 
+/**
+ * Accumulator type used by running sum filters.
+ * 32 bits are exact for int16 samples and windows up to 65535 samples.
+ * Define FILTER_WIDE_ACCUMULATOR to get 64 bits accumulators.
+ */
+#ifdef FILTER_WIDE_ACCUMULATOR
+typedef int64_t filter_acc_t;
+#else
+typedef int32_t filter_acc_t;
+#endif
+
+
+/**
+ * How samples outside of a sequence are produced:
+ *      Reflect     -   d c b | a b c d | c b a
+ *      Replicate   -   a a a | a b c d | d d d
+ *      Constant    -   k k k | a b c d | k k k
+ *      Wrap        -   b c d | a b c d | a b c
+ */
+typedef enum {FilterPadReflect=0, FilterPadReplicate, FilterPadConstant, FilterPadWrap} FilterPadding_t;
+
+/**
+ * Position of output sample in its window:
+ *      Causal      -   window ends at output sample
+ *      Centered    -   output sample is in the middle of the window
+ */
+typedef enum {FilterAlignCausal=0, FilterAlignCentered} FilterAlignment_t;
+
+
+typedef struct _filter_edge_config {
+	FilterPadding_t		padding;
+	FilterAlignment_t	alignment;
+	int16_t				pad_value;
+} FilterEdgeConfig_t;
+
+
+/**
+ * Filter state checkpoint header. Checkpoint is stored in host byte order and
+ * can be restored by the library built for the same architecture.
+ */
+#define FILTER_STATE_MAGIC      0x5346u
+#define FILTER_STATE_VERSION    2
+
+typedef enum {FilterStateMovingAverage=1, FilterStateRank} FilterStateKind_t;
+
+typedef struct _filter_state_header {
+	uint16_t	magic;
+	uint8_t		version;
+	uint8_t		kind;
+	uint16_t	window_size;
+	uint16_t	items_num;
+	uint32_t	size;
+} FilterStateHeader_t;
+
+
+/**
+ * Number of output rows of 2D filters processed by one task. Bands are filtered in parallel
+ * when library is built with OpenMP.
+ */
+#define FILTER_2D_BAND_ROWS		32
+
+
 typedef struct _filter_buffer_config {
 	uint32_t last_x_rd_ptr;
 	uint32_t new_x_rd_ptr;
@@ -38,6 +111,15 @@ typedef struct _filter_buffer_config {
 // void update_buffer_ptr(uint32_t *ptr, uint32_t buf_size);
 void filter_update_buffer_ptrs(FilterBufferConfig_t *filter);
 uint32_t filter_windowed_get_expected_output_len(uint32_t data_len, uint32_t window_size);
+int filter_sort_cmp(const void *pdata1, const void *pdata2);
+FilterStatus_t filter_2d_get_output_size(uint16_t width, uint16_t height, uint16_t kernel_width,
+		uint16_t kernel_height, uint16_t *y_width, uint16_t *y_height);
+uint32_t filter_edge_get_left_len(uint32_t window_size, FilterAlignment_t alignment);
+void filter_state_write_header(uint8_t *buf, FilterStateKind_t kind, uint16_t window_size,
+		uint16_t items_num, uint32_t size);
+FilterStatus_t filter_state_read_header(const uint8_t *buf, uint32_t buf_size, FilterStateKind_t kind,
+		uint16_t window_size, FilterStateHeader_t *header);
+int16_t filter_edge_get_sample(const int16_t *data, uint32_t data_size, int32_t idx, const FilterEdgeConfig_t *edge);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,614 @@
+/*
+ * filter_autotune.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  USAGE:
+ *      1. Build with FILTER_AUTOTUNE_ENABLE defined. Without it filters always start with default backends
+ *          and this module contains only stubs. Tuning uses stdio and POSIX clock_gettime(...).
+ *      2. At startup call filter_autotune_load(...) with cache file path. FilterError means there is no
+ *          cache, or it was made by another library version or on another CPU model. It is not used then.
+ *      3. Call filter_autotune_rank(...) / filter_autotune_moving_avg(...) for every configuration the
+ *          application uses. Configurations found in cache are not measured again.
+ *      4. Call filter_autotune_save(...) to store results for the next startup.
+ *
+ *      rank_filter_init(...) and moving_avg_init(...) (and their _capacity variants) look their configuration
+ *      up in cache and select the tuned backend. Configurations which were not tuned keep default backend.
+ *      Backend can be changed afterwards with rank_filter_set_backend(...) / moving_avg_set_backend(...).
+ *
+ *  Cache is global and is not protected, tune and load it before filters are created in other threads.
+ *
+ *  Cache file is text:
+ *      filter_autotune <library version>
+ *      cpu <cpu model>
+ *      rank <window size> <rank> <backend>
+ *      moving_avg <window size> <filter type> <backend>
+ *
+ *   Algorithm:
+ *      Every backend filters the same noisy random walk FILTER_AUTOTUNE_BENCH_REPS times. Walk is one window
+ *      longer than FILTER_AUTOTUNE_BENCH_LEN samples, so every backend produces that many outputs.
+ *      The backend with the lowest best time wins.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "filter_autotune.h"
+
+
+#define FILTER_AUTOTUNE_CPU_MODEL_LEN   128
+#define FILTER_AUTOTUNE_LINE_LEN        256
+
+
+#ifdef FILTER_AUTOTUNE_ENABLE
+
+static FilterAutotuneEntry_t filter_autotune_entries[FILTER_AUTOTUNE_MAX_ENTRIES];
+static uint16_t filter_autotune_entries_num;
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static FilterAutotuneEntry_t *filter_autotune_find(FilterAutotuneKind_t kind, uint16_t window_size,
+		uint16_t param);
+static FilterStatus_t filter_autotune_store(FilterAutotuneKind_t kind, uint16_t window_size, uint16_t param,
+		uint8_t backend);
+static void filter_autotune_get_cpu_model(char *model, uint32_t len);
+static int16_t *filter_autotune_bench_data(uint16_t len);
+static inline uint16_t filter_autotune_bench_len(uint16_t window_size);
+static double filter_autotune_bench_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t backend,
+		const int16_t *data, uint16_t len, int16_t *y);
+static double filter_autotune_bench_moving_avg(uint16_t window_size, FilterType_t ftype,
+		MovingAverageBackend_t backend, const int16_t *data, uint16_t len, int16_t *y);
+static inline double filter_autotune_now(void);
+
+#endif
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief       Loads tuned configurations from cache file replacing current ones.
+ *
+ * @param[in]   path    -   cache file path
+ *
+ * @return      FilterError if file can not be read, is corrupted or was made by another library version
+ *                  or on another CPU model. Cache is left empty then.
+ */
+FilterStatus_t filter_autotune_load(const char *path)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	char line[FILTER_AUTOTUNE_LINE_LEN];
+	char expected[FILTER_AUTOTUNE_LINE_LEN];
+	char cpu_model[FILTER_AUTOTUNE_CPU_MODEL_LEN];
+	FilterStatus_t status = FilterOK;
+
+	filter_autotune_reset();
+
+	FILE *file = fopen(path, "r");
+	if(file == NULL)
+	{
+		return FilterError;
+	}
+
+	/* Key lines */
+	filter_autotune_get_cpu_model(cpu_model, sizeof cpu_model);
+
+	snprintf(expected, sizeof expected, "filter_autotune %s\n", FILTER_LIBRARY_VERSION);
+	if(fgets(line, sizeof line, file) == NULL || strcmp(line, expected) != 0)
+	{
+		status = FilterError;
+	}
+
+	snprintf(expected, sizeof expected, "cpu %s\n", cpu_model);
+	if(status == FilterOK && (fgets(line, sizeof line, file) == NULL || strcmp(line, expected) != 0))
+	{
+		status = FilterError;
+	}
+
+	while(status == FilterOK && fgets(line, sizeof line, file) != NULL)
+	{
+		char kind[16];
+		unsigned window_size, param, backend;
+
+		if(sscanf(line, "%15s %u %u %u", kind, &window_size, &param, &backend) != 4
+				|| window_size == 0 || window_size > UINT16_MAX || param > UINT16_MAX || backend > 1)
+		{
+			status = FilterError;
+		}
+		else if(strcmp(kind, "rank") == 0)
+		{
+			status = filter_autotune_store(FilterAutotuneRank, window_size, param, backend);
+		}
+		else if(strcmp(kind, "moving_avg") == 0)
+		{
+			status = filter_autotune_store(FilterAutotuneMovingAvg, window_size, param, backend);
+		}
+		else
+		{
+			status = FilterError;
+		}
+	}
+
+	fclose(file);
+
+	if(status != FilterOK)
+	{
+		filter_autotune_reset();
+	}
+
+	return status;
+#else
+	(void)path;
+	return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Writes tuned configurations into cache file.
+ *
+ * @param[in]   path    -   cache file path
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t filter_autotune_save(const char *path)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	char cpu_model[FILTER_AUTOTUNE_CPU_MODEL_LEN];
+
+	FILE *file = fopen(path, "w");
+	if(file == NULL)
+	{
+		return FilterError;
+	}
+
+	filter_autotune_get_cpu_model(cpu_model, sizeof cpu_model);
+
+	fprintf(file, "filter_autotune %s\n", FILTER_LIBRARY_VERSION);
+	fprintf(file, "cpu %s\n", cpu_model);
+
+	for(uint16_t i=0; i<filter_autotune_entries_num; i++)
+	{
+		const FilterAutotuneEntry_t *entry = &filter_autotune_entries[i];
+
+		fprintf(file, "%s %u %u %u\n", (entry->kind == FilterAutotuneRank) ? "rank" : "moving_avg",
+				entry->window_size, entry->param, entry->backend);
+	}
+
+	return (fclose(file) == 0) ? FilterOK : FilterError;
+#else
+	(void)path;
+	return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Clears cache. Filters created after that use default backends.
+ */
+void filter_autotune_reset(void)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	filter_autotune_entries_num = 0;
+#endif
+}
+
+
+/**
+ * @brief       Measures rank filter backends for configuration and caches the fastest one.
+ * @note        Cached configuration is returned without measuring.
+ *
+ * @param[in]   window_size -   rank filter window size
+ * @param[in]   rank        -   rank filter rank
+ * @param[out]  backend     -   the fastest backend. Can be NULL.
+ *
+ * @return      FilterError if tuning is not compiled in, configuration is invalid or cache is full.
+ */
+FilterStatus_t filter_autotune_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t *backend)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	RankFilterBackend_t best;
+
+	if(window_size == 0 || rank >= window_size)
+	{
+		return FilterError;
+	}
+
+	if(filter_autotune_lookup_rank(window_size, rank, &best) != FilterOK)
+	{
+		const uint16_t len = filter_autotune_bench_len(window_size);
+		int16_t *data = filter_autotune_bench_data(len);
+		int16_t *y = _malloc(len * sizeof *y);
+
+		if(data == NULL || y == NULL)
+		{
+			_free(data);
+			_free(y);
+			return FilterError;
+		}
+
+		double linear = filter_autotune_bench_rank(window_size, rank, RankFilterLinearScan, data, len, y);
+		double binary = filter_autotune_bench_rank(window_size, rank, RankFilterBinarySearch, data, len, y);
+
+		_free(data);
+		_free(y);
+
+		if(linear < 0 || binary < 0)
+		{
+			return FilterError;
+		}
+
+		best = (binary < linear) ? RankFilterBinarySearch : RankFilterLinearScan;
+
+		if(filter_autotune_store(FilterAutotuneRank, window_size, rank, best) != FilterOK)
+		{
+			return FilterError;
+		}
+	}
+
+	if(backend != NULL)
+	{
+		*backend = best;
+	}
+
+	return FilterOK;
+#else
+	(void)window_size;
+	(void)rank;
+	(void)backend;
+	return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Measures moving average backends for configuration and caches the fastest one.
+ * @note        Cached configuration is returned without measuring.
+ *
+ * @param[in]   window_size -   moving average window size
+ * @param[in]   ftype       -   filter type
+ * @param[out]  backend     -   the fastest backend. Can be NULL.
+ *
+ * @return      FilterError if tuning is not compiled in, configuration is invalid or cache is full.
+ */
+FilterStatus_t filter_autotune_moving_avg(uint16_t window_size, FilterType_t ftype,
+		MovingAverageBackend_t *backend)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	MovingAverageBackend_t best;
+
+	if(window_size == 0)
+	{
+		return FilterError;
+	}
+
+	if(filter_autotune_lookup_moving_avg(window_size, ftype, &best) != FilterOK)
+	{
+		const uint16_t len = filter_autotune_bench_len(window_size);
+		int16_t *data = filter_autotune_bench_data(len);
+		int16_t *y = _malloc(len * sizeof *y);
+
+		if(data == NULL || y == NULL)
+		{
+			_free(data);
+			_free(y);
+			return FilterError;
+		}
+
+		double fifo = filter_autotune_bench_moving_avg(window_size, ftype, MovingAverageFifo, data, len, y);
+		double ring = filter_autotune_bench_moving_avg(window_size, ftype, MovingAverageDirectRing, data, len, y);
+
+		_free(data);
+		_free(y);
+
+		if(fifo < 0 || ring < 0)
+		{
+			return FilterError;
+		}
+
+		best = (ring < fifo) ? MovingAverageDirectRing : MovingAverageFifo;
+
+		if(filter_autotune_store(FilterAutotuneMovingAvg, window_size, ftype, best) != FilterOK)
+		{
+			return FilterError;
+		}
+	}
+
+	if(backend != NULL)
+	{
+		*backend = best;
+	}
+
+	return FilterOK;
+#else
+	(void)window_size;
+	(void)ftype;
+	(void)backend;
+	return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Returns cached backend of rank filter configuration.
+ *
+ * @param[in]   window_size -   rank filter window size
+ * @param[in]   rank        -   rank filter rank
+ * @param[out]  backend     -   cached backend. Not changed if configuration is not cached.
+ *
+ * @return      FilterError if configuration is not cached.
+ */
+FilterStatus_t filter_autotune_lookup_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t *backend)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	const FilterAutotuneEntry_t *entry = filter_autotune_find(FilterAutotuneRank, window_size, rank);
+
+	if(entry == NULL)
+	{
+		return FilterError;
+	}
+
+	*backend = (RankFilterBackend_t)entry->backend;
+	return FilterOK;
+#else
+	(void)window_size;
+	(void)rank;
+	(void)backend;
+	return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Returns cached backend of moving average configuration.
+ *
+ * @param[in]   window_size -   moving average window size
+ * @param[in]   ftype       -   filter type
+ * @param[out]  backend     -   cached backend. Not changed if configuration is not cached.
+ *
+ * @return      FilterError if configuration is not cached.
+ */
+FilterStatus_t filter_autotune_lookup_moving_avg(uint16_t window_size, FilterType_t ftype,
+		MovingAverageBackend_t *backend)
+{
+#ifdef FILTER_AUTOTUNE_ENABLE
+	const FilterAutotuneEntry_t *entry = filter_autotune_find(FilterAutotuneMovingAvg, window_size, ftype);
+
+	if(entry == NULL)
+	{
+		return FilterError;
+	}
+
+	*backend = (MovingAverageBackend_t)entry->backend;
+	return FilterOK;
+#else
+	(void)window_size;
+	(void)ftype;
+	(void)backend;
+	return FilterError;
+#endif
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+#ifdef FILTER_AUTOTUNE_ENABLE
+
+static FilterAutotuneEntry_t *filter_autotune_find(FilterAutotuneKind_t kind, uint16_t window_size,
+		uint16_t param)
+{
+	for(uint16_t i=0; i<filter_autotune_entries_num; i++)
+	{
+		FilterAutotuneEntry_t *entry = &filter_autotune_entries[i];
+
+		if(entry->kind == kind && entry->window_size == window_size && entry->param == param)
+		{
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief	Adds configuration to cache or updates its backend.
+ */
+static FilterStatus_t filter_autotune_store(FilterAutotuneKind_t kind, uint16_t window_size, uint16_t param,
+		uint8_t backend)
+{
+	FilterAutotuneEntry_t *entry = filter_autotune_find(kind, window_size, param);
+
+	if(entry == NULL)
+	{
+		if(filter_autotune_entries_num == FILTER_AUTOTUNE_MAX_ENTRIES)
+		{
+			return FilterError;
+		}
+
+		entry = &filter_autotune_entries[filter_autotune_entries_num++];
+
+		entry->kind = kind;
+		entry->window_size = window_size;
+		entry->param = param;
+	}
+
+	entry->backend = backend;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Returns CPU model name from /proc/cpuinfo, "unknown" if it is not available.
+ */
+static void filter_autotune_get_cpu_model(char *model, uint32_t len)
+{
+	char line[FILTER_AUTOTUNE_LINE_LEN];
+	FILE *file = fopen("/proc/cpuinfo", "r");
+
+	snprintf(model, len, "unknown");
+
+	if(file == NULL)
+	{
+		return;
+	}
+
+	while(fgets(line, sizeof line, file) != NULL)
+	{
+		char *value = strchr(line, ':');
+
+		if(strncmp(line, "model name", 10) == 0 && value != NULL)
+		{
+			value += strspn(value + 1, " \t") + 1;
+			value[strcspn(value, "\n")] = '\0';
+
+			snprintf(model, len, "%s", value);
+			break;
+		}
+	}
+
+	fclose(file);
+}
+
+
+/**
+ * @brief	Returns number of bench samples for window size.
+ */
+static inline uint16_t filter_autotune_bench_len(uint16_t window_size)
+{
+	return (window_size < UINT16_MAX - FILTER_AUTOTUNE_BENCH_LEN) ? window_size + FILTER_AUTOTUNE_BENCH_LEN
+			: UINT16_MAX;
+}
+
+
+/**
+ * @brief	Returns len samples of noisy random walk. Generator is local, so rand() sequence of
+ * 				application is not changed.
+ */
+static int16_t *filter_autotune_bench_data(uint16_t len)
+{
+	int16_t *data = _malloc(len * sizeof *data);
+	uint32_t seed = 12345;
+	int32_t level = 0;
+
+	if(data == NULL)
+	{
+		return NULL;
+	}
+
+	for(uint32_t i=0; i<len; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+
+		level += (int32_t)((seed >> 16) % 65) - 32;
+		level = (level > 16000) ? 16000 : ((level < -16000) ? -16000 : level);
+
+		data[i] = level + (int32_t)((seed >> 8) % 2001) - 1000;
+	}
+
+	return data;
+}
+
+
+/**
+ * @brief	Returns the best time of filtering bench data with rank filter backend in seconds, -1 on error.
+ */
+static double filter_autotune_bench_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t backend,
+		const int16_t *data, uint16_t len, int16_t *y)
+{
+	int16_t *buffer = _malloc(window_size * sizeof *buffer);
+	RankFilter_t rank_filter;
+	double best = -1;
+
+	if(buffer == NULL || rank_filter_init(&rank_filter, buffer, window_size, rank) != FilterOK)
+	{
+		_free(buffer);
+		return -1;
+	}
+
+	rank_filter_set_backend(&rank_filter, backend);
+
+	for(uint32_t rep=0; rep<FILTER_AUTOTUNE_BENCH_REPS; rep++)
+	{
+		uint16_t y_len;
+
+		rank_filter_flush(&rank_filter);
+
+		double start = filter_autotune_now();
+		FilterStatus_t status = rank_filter_filter_block(&rank_filter, (int16_t*)data, len, y, &y_len);
+		double elapsed = filter_autotune_now() - start;
+
+		if(status != FilterOK)
+		{
+			best = -1;
+			break;
+		}
+
+		best = (best < 0 || elapsed < best) ? elapsed : best;
+	}
+
+	rank_filter_deinit(&rank_filter);
+	_free(buffer);
+
+	return best;
+}
+
+
+/**
+ * @brief	Returns the best time of filtering bench data with moving average backend in seconds, -1 on error.
+ */
+static double filter_autotune_bench_moving_avg(uint16_t window_size, FilterType_t ftype,
+		MovingAverageBackend_t backend, const int16_t *data, uint16_t len, int16_t *y)
+{
+	int16_t *buffer = _malloc(window_size * sizeof *buffer);
+	MovingAverageFilter_t filter;
+	double best = -1;
+
+	if(buffer == NULL || moving_avg_init(&filter, ftype, buffer, window_size) != FilterOK)
+	{
+		_free(buffer);
+		return -1;
+	}
+
+	moving_avg_set_backend(&filter, backend);
+
+	for(uint32_t rep=0; rep<FILTER_AUTOTUNE_BENCH_REPS; rep++)
+	{
+		uint16_t y_len;
+
+		moving_avg_flush(&filter);
+
+		double start = filter_autotune_now();
+		FilterStatus_t status = moving_avg_filter_block(&filter, (int16_t*)data, len, y, &y_len);
+		double elapsed = filter_autotune_now() - start;
+
+		if(status != FilterOK)
+		{
+			best = -1;
+			break;
+		}
+
+		best = (best < 0 || elapsed < best) ? elapsed : best;
+	}
+
+	_free(buffer);
+
+	return best;
+}
+
+
+static inline double filter_autotune_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * filter_autotune.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_FILTER_AUTOTUNE_H_
+#define SRC_MOD_FILTERS_FILTER_AUTOTUNE_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+#include "rank_filter.h"
+#include "moving_average_filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Tuning is compiled in only when FILTER_AUTOTUNE_ENABLE is defined. Otherwise all functions
+ * return FilterError and filters use default backends.
+ */
+
+/**
+ * Maximum number of tuned configurations kept in cache
+ */
+#define FILTER_AUTOTUNE_MAX_ENTRIES     64
+
+/**
+ * Outputs produced by every backend per measurement and number of measurements. The fastest one counts.
+ */
+#define FILTER_AUTOTUNE_BENCH_LEN       4096
+#define FILTER_AUTOTUNE_BENCH_REPS      5
+
+
+typedef enum {FilterAutotuneRank=0, FilterAutotuneMovingAvg} FilterAutotuneKind_t;
+
+
+/**
+ * Tuned configuration. Param is rank of rank filter or FilterType_t of moving average.
+ */
+typedef struct filter_autotune_entry {
+	FilterAutotuneKind_t	kind;
+	uint16_t				window_size;
+	uint16_t				param;
+	uint8_t					backend;
+} FilterAutotuneEntry_t;
+
+
+FilterStatus_t  filter_autotune_load(const char *path);
+FilterStatus_t  filter_autotune_save(const char *path);
+void            filter_autotune_reset(void);
+FilterStatus_t  filter_autotune_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t *backend);
+FilterStatus_t  filter_autotune_moving_avg(uint16_t window_size, FilterType_t ftype,
+        MovingAverageBackend_t *backend);
+FilterStatus_t  filter_autotune_lookup_rank(uint16_t window_size, uint16_t rank, RankFilterBackend_t *backend);
+FilterStatus_t  filter_autotune_lookup_moving_avg(uint16_t window_size, FilterType_t ftype,
+        MovingAverageBackend_t *backend);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_FILTER_AUTOTUNE_H_ */
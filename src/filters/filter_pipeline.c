@@ -0,0 +1,333 @@
+/*
+ * filter_pipeline.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Initialize stage filters as usual with moving_avg_init(...), rank_filter_init(...) etc.
+ *      2. Call filter_pipeline_init(...) on your pipeline handle.
+ *      3. Add stages in processing order with filter_pipeline_add_moving_avg(...), filter_pipeline_add_rank(...),
+ *          filter_pipeline_add_exp_moving_avg(...), filter_pipeline_add_weighted_moving_avg(...)
+ *          or filter_pipeline_add_stage(...) for any other filter with block API.
+ *      4. Call filter_pipeline_filter_block(...) on each new portion of data.
+ *
+ *      If you need to reset pipeline call filter_pipeline_flush(...).
+ *
+ *  You can also filter prepared sequence with:
+ *      1. filter_pipeline_filter_sequence(...)
+ *
+ *   Algorithm:
+ *      1. Input is split into blocks of FILTER_PIPELINE_BLOCK_SIZE samples.
+ *      2. Every block passes through all stages before the next one is taken, intermediate samples
+ *          stay in two small scratch buffers.
+ *      3. Every stage drops window_size-1 first samples, so pipeline output is shorter than input
+ *          by filter_pipeline_get_latency(...) samples.
+ */
+
+#include <stddef.h>
+
+#include "filter_pipeline.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static FilterStatus_t moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len);
+static void moving_avg_stage_flush(void *filter);
+static FilterStatus_t rank_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len);
+static void rank_stage_flush(void *filter);
+static FilterStatus_t exp_moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len);
+static void exp_moving_avg_stage_flush(void *filter);
+static FilterStatus_t weighted_moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len);
+static void weighted_moving_avg_stage_flush(void *filter);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief       Initializes empty pipeline.
+ *
+ * @param[in]   pipeline    -   pipeline handle
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t filter_pipeline_init(FilterPipeline_t *pipeline)
+{
+    pipeline->stages_num = 0;
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Appends stage to pipeline.
+ *
+ * @param[in]   pipeline    -   pipeline handle
+ * @param[in]   filter      -   initialized filter handle
+ * @param[in]   block       -   block function of the filter
+ * @param[in]   flush       -   flush function of the filter. Can be NULL.
+ * @param[in]   window_size -   filter window size. Stage outputs window_size-1 samples less than it gets.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t filter_pipeline_add_stage(FilterPipeline_t *pipeline, void *filter, FilterStageBlockFunc_t block,
+        FilterStageFlushFunc_t flush, uint16_t window_size)
+{
+    if(pipeline->stages_num == FILTER_PIPELINE_MAX_STAGES || block == NULL || window_size == 0)
+    {
+        return FilterError;
+    }
+
+    FilterStage_t *stage = &pipeline->stages[pipeline->stages_num++];
+
+    stage->filter = filter;
+    stage->block = block;
+    stage->flush = flush;
+    stage->window_size = window_size;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Appends moving average filter stage.
+ */
+FilterStatus_t filter_pipeline_add_moving_avg(FilterPipeline_t *pipeline, MovingAverageFilter_t *filter)
+{
+    return filter_pipeline_add_stage(pipeline, filter, moving_avg_stage_block, moving_avg_stage_flush,
+            filter->window_size);
+}
+
+
+/**
+ * @brief       Appends rank filter stage.
+ */
+FilterStatus_t filter_pipeline_add_rank(FilterPipeline_t *pipeline, RankFilter_t *filter)
+{
+    return filter_pipeline_add_stage(pipeline, filter, rank_stage_block, rank_stage_flush,
+            filter->window_size);
+}
+
+
+/**
+ * @brief       Appends exponential moving average filter stage. It has no window so it adds no latency.
+ */
+FilterStatus_t filter_pipeline_add_exp_moving_avg(FilterPipeline_t *pipeline, ExpMovingAverageFilter_t *filter)
+{
+    return filter_pipeline_add_stage(pipeline, filter, exp_moving_avg_stage_block, exp_moving_avg_stage_flush, 1);
+}
+
+
+/**
+ * @brief       Appends weighted moving average filter stage.
+ */
+FilterStatus_t filter_pipeline_add_weighted_moving_avg(FilterPipeline_t *pipeline,
+        WeightedMovingAverageFilter_t *filter)
+{
+    return filter_pipeline_add_stage(pipeline, filter, weighted_moving_avg_stage_block,
+            weighted_moving_avg_stage_flush, filter->window_size);
+}
+
+
+/**
+ * @brief       Passes data through all stages keeping their state between calls.
+ *
+ * @param[in]   pipeline    -   pipeline handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t filter_pipeline_filter_block(FilterPipeline_t *pipeline, int16_t *data, uint32_t data_len,
+        int16_t *y, uint32_t *y_len)
+{
+    uint8_t stages_num = pipeline->stages_num;
+    uint32_t produced = 0;
+
+    if(stages_num == 0)
+    {
+        return FilterError;
+    }
+
+    for(uint32_t offset=0; offset<data_len; offset+=FILTER_PIPELINE_BLOCK_SIZE)
+    {
+        uint16_t len = (data_len - offset < FILTER_PIPELINE_BLOCK_SIZE) ?
+                data_len - offset : FILTER_PIPELINE_BLOCK_SIZE;
+
+        int16_t *in = data + offset;
+
+        for(uint8_t s=0; s<stages_num && len != 0; s++)
+        {
+            FilterStage_t *stage = &pipeline->stages[s];
+
+            /* The last stage writes directly into output */
+            int16_t *out = (s == stages_num - 1) ? y + produced : pipeline->scratch[s & 1];
+
+            if(stage->block(stage->filter, in, len, out, &len) != FilterOK)
+            {
+                return FilterError;
+            }
+
+            in = out;
+        }
+
+        produced += len;
+    }
+
+    *y_len = produced;
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Filters prepared sequence from the empty pipeline state.
+ * @note        Flushes all stages before filtering.
+ *
+ * @param[in]   pipeline    -   pipeline handle
+ * @param[in]   data        -   data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[out]  y           -   buffer for filtered data. You can predict its length with
+ *                                  filter_pipeline_get_output_data_len.
+ * @param[out]  y_len       -   output sequence length
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t filter_pipeline_filter_sequence(FilterPipeline_t *pipeline, int16_t *data, uint32_t data_size,
+        int16_t *y, uint32_t *y_len)
+{
+    uint32_t expected_len;
+
+    if(filter_pipeline_get_output_data_len(pipeline, data_size, &expected_len) != FilterOK)
+    {
+        return FilterError;
+    }
+
+    filter_pipeline_flush(pipeline);
+    return filter_pipeline_filter_block(pipeline, data, data_size, y, y_len);
+}
+
+
+/**
+ * @brief       Returns expected output length of filter_pipeline_filter_sequence.
+ *
+ * @param[in]   pipeline    -   pipeline handle
+ * @param[in]   data_size   -   input length
+ * @param[out]  y_len       -   expected output length
+ *
+ * @return      FilterError if input is shorter than composed window.
+ */
+FilterStatus_t filter_pipeline_get_output_data_len(FilterPipeline_t *pipeline, uint32_t data_size, uint32_t *y_len)
+{
+    uint32_t latency = filter_pipeline_get_latency(pipeline);
+
+    if(pipeline->stages_num == 0 || data_size <= latency)
+    {
+        return FilterError;
+    }
+
+    *y_len = data_size - latency;
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Returns number of input samples consumed before the first output.
+ * @note        Composed window size of the pipeline is latency + 1.
+ */
+uint32_t filter_pipeline_get_latency(FilterPipeline_t *pipeline)
+{
+    uint32_t latency = 0;
+
+    for(uint8_t s=0; s<pipeline->stages_num; s++)
+    {
+        latency += pipeline->stages[s].window_size - 1;
+    }
+
+    return latency;
+}
+
+
+/**
+ * @brief       Returns offset of input sample which output sample is aligned to.
+ * @note        Output sample i corresponds to the middle of every stage window, i.e. to input
+ *                  sample i + delay.
+ */
+uint32_t filter_pipeline_get_delay(FilterPipeline_t *pipeline)
+{
+    uint32_t delay = 0;
+
+    for(uint8_t s=0; s<pipeline->stages_num; s++)
+    {
+        delay += (pipeline->stages[s].window_size - 1) / 2;
+    }
+
+    return delay;
+}
+
+
+/**
+ * @brief       Flushes all stages. Stages collect their windows again after that.
+ */
+void filter_pipeline_flush(FilterPipeline_t *pipeline)
+{
+    for(uint8_t s=0; s<pipeline->stages_num; s++)
+    {
+        FilterStage_t *stage = &pipeline->stages[s];
+
+        if(stage->flush != NULL)
+        {
+            stage->flush(stage->filter);
+        }
+    }
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+static FilterStatus_t moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+    return moving_avg_filter_block(filter, data, data_len, y, y_len);
+}
+
+
+static void moving_avg_stage_flush(void *filter)
+{
+    moving_avg_flush(filter);
+}
+
+
+static FilterStatus_t rank_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+    return rank_filter_filter_block(filter, data, data_len, y, y_len);
+}
+
+
+static void rank_stage_flush(void *filter)
+{
+    rank_filter_flush(filter);
+}
+
+
+static FilterStatus_t exp_moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+    return exp_moving_avg_filter_block(filter, data, data_len, y, y_len);
+}
+
+
+static void exp_moving_avg_stage_flush(void *filter)
+{
+    exp_moving_avg_flush(filter);
+}
+
+
+static FilterStatus_t weighted_moving_avg_stage_block(void *filter, int16_t *data, uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+    return weighted_moving_avg_filter_block(filter, data, data_len, y, y_len);
+}
+
+
+static void weighted_moving_avg_stage_flush(void *filter)
+{
+    weighted_moving_avg_flush(filter);
+}
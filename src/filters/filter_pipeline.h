@@ -0,0 +1,80 @@
+/*
+ * filter_pipeline.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_FILTER_PIPELINE_H_
+#define SRC_MOD_FILTERS_FILTER_PIPELINE_H_
+
+#include "filter.h"
+#include "moving_average_filter.h"
+#include "rank_filter.h"
+#include "exp_moving_average_filter.h"
+#include "weighted_moving_average_filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Maximum number of stages in a pipeline
+ */
+#define FILTER_PIPELINE_MAX_STAGES  8
+
+/**
+ * Number of samples processed by all stages at once. Two blocks of intermediate samples
+ * must fit into L1 cache.
+ */
+#define FILTER_PIPELINE_BLOCK_SIZE  512
+
+
+/**
+ * Stage interface. Any filter with block API of this form can be a stage.
+ */
+typedef FilterStatus_t (*FilterStageBlockFunc_t)(void *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
+typedef void (*FilterStageFlushFunc_t)(void *filter);
+
+
+typedef struct filter_stage {
+    void                    *filter;
+    FilterStageBlockFunc_t  block;
+    FilterStageFlushFunc_t  flush;
+    uint16_t                window_size;
+} FilterStage_t;
+
+
+typedef struct filter_pipeline {
+    FilterStage_t   stages[FILTER_PIPELINE_MAX_STAGES];
+    uint8_t         stages_num;
+
+    int16_t         scratch[2][FILTER_PIPELINE_BLOCK_SIZE];
+} FilterPipeline_t;
+
+
+FilterStatus_t  filter_pipeline_init(FilterPipeline_t *pipeline);
+FilterStatus_t  filter_pipeline_add_stage(FilterPipeline_t *pipeline, void *filter, FilterStageBlockFunc_t block,
+        FilterStageFlushFunc_t flush, uint16_t window_size);
+FilterStatus_t  filter_pipeline_add_moving_avg(FilterPipeline_t *pipeline, MovingAverageFilter_t *filter);
+FilterStatus_t  filter_pipeline_add_rank(FilterPipeline_t *pipeline, RankFilter_t *filter);
+FilterStatus_t  filter_pipeline_add_exp_moving_avg(FilterPipeline_t *pipeline, ExpMovingAverageFilter_t *filter);
+FilterStatus_t  filter_pipeline_add_weighted_moving_avg(FilterPipeline_t *pipeline,
+        WeightedMovingAverageFilter_t *filter);
+FilterStatus_t  filter_pipeline_filter_block(FilterPipeline_t *pipeline, int16_t *data, uint32_t data_len,
+        int16_t *y, uint32_t *y_len);
+FilterStatus_t  filter_pipeline_filter_sequence(FilterPipeline_t *pipeline, int16_t *data, uint32_t data_size,
+        int16_t *y, uint32_t *y_len);
+FilterStatus_t  filter_pipeline_get_output_data_len(FilterPipeline_t *pipeline, uint32_t data_size, uint32_t *y_len);
+uint32_t        filter_pipeline_get_latency(FilterPipeline_t *pipeline);
+uint32_t        filter_pipeline_get_delay(FilterPipeline_t *pipeline);
+void            filter_pipeline_flush(FilterPipeline_t *pipeline);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_FILTER_PIPELINE_H_ */
@@ -0,0 +1,200 @@
+/*
+ * filter_stats.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  USAGE:
+ *      1. Build with FILTER_STATS_ENABLE defined. Without it filters contain no instrumentation code.
+ *      2. Call filter_stats_snapshot(...) from any context to get consistent copy of counters.
+ *          Filtering is not stopped, snapshot is retried while counters are being updated.
+ *      3. Call filter_stats_reset(...) to clear counters.
+ *
+ *  Counters are global and assume a single filtering context (one thread or one ISR).
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "filter_stats.h"
+
+
+#if defined(__GNUC__)
+#define FILTER_STATS_BARRIER()  __sync_synchronize()
+#else
+#define FILTER_STATS_BARRIER()
+#endif
+
+
+static volatile FilterStats_t filter_stats;
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline void filter_stats_update_begin(void);
+static inline void filter_stats_update_end(void);
+static inline uint32_t filter_stats_hist_bin(uint32_t cycles);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief       Copies current counters.
+ *
+ * @param[out]  snapshot    -   pointer where counters will be stored.
+ *
+ * @return      FilterError if instrumentation is not compiled in.
+ */
+FilterStatus_t filter_stats_snapshot(FilterStats_t *snapshot)
+{
+#ifdef FILTER_STATS_ENABLE
+    uint32_t seq_start, seq_end;
+
+    do
+    {
+        seq_start = filter_stats.sequence;
+        FILTER_STATS_BARRIER();
+
+        memcpy(snapshot, (const void*)&filter_stats, sizeof *snapshot);
+
+        FILTER_STATS_BARRIER();
+        seq_end = filter_stats.sequence;
+    }
+    while((seq_start & 1) || seq_start != seq_end);
+
+    return FilterOK;
+#else
+    memset(snapshot, 0, sizeof *snapshot);
+    return FilterError;
+#endif
+}
+
+
+/**
+ * @brief       Clears all counters.
+ */
+void filter_stats_reset(void)
+{
+    uint32_t sequence = filter_stats.sequence;
+
+    filter_stats_update_begin();
+    memset((void*)&filter_stats, 0, sizeof filter_stats);
+    filter_stats.sequence = sequence + 1;
+    filter_stats_update_end();
+}
+
+
+/**
+ * @brief       Starts measurement of instrumented call.
+ * @return      Start cycle counter value.
+ */
+uint32_t filter_stats_enter(void)
+{
+    return FILTER_STATS_CYCLES();
+}
+
+
+/**
+ * @brief       Finishes measurement of instrumented call.
+ *
+ * @param[in]   path    -   instrumented function
+ * @param[in]   start_cycles    -   value returned by filter_stats_enter
+ * @param[in]   samples -   number of produced samples
+ */
+void filter_stats_leave(FilterStatsPath_t path, uint32_t start_cycles, uint32_t samples)
+{
+    uint32_t cycles = FILTER_STATS_CYCLES() - start_cycles;
+    volatile FilterStatsPathCounters_t *counters = &filter_stats.path[path];
+
+    filter_stats_update_begin();
+
+    counters->calls++;
+    counters->samples += samples;
+    counters->cycles_hist[filter_stats_hist_bin(cycles)]++;
+
+    filter_stats_update_end();
+}
+
+
+/**
+ * @brief       Counts FIFO errors.
+ *
+ * @param[in]   status  -   FIFO operation status
+ * @return      The same status
+ */
+FIFO_error_t filter_stats_fifo(FIFO_error_t status)
+{
+    if(status == FIFO_OK)
+    {
+        return status;
+    }
+
+    filter_stats_update_begin();
+
+    if(status == FIFO_OVERFLOW)
+    {
+        filter_stats.fifo_overflows++;
+    }
+    else if(status == FIFO_UNDERFLOW)
+    {
+        filter_stats.fifo_underflows++;
+    }
+
+    filter_stats_update_end();
+
+    return status;
+}
+
+
+/**
+ * @brief       Counts sorted window update work of rank filter.
+ *
+ * @param[in]   scan_len    -   number of sorted window items scanned
+ * @param[in]   bytes_moved -   number of bytes moved with memmove
+ */
+void filter_stats_rank_scan(uint32_t scan_len, uint32_t bytes_moved)
+{
+    filter_stats_update_begin();
+
+    filter_stats.rank_scan_len += scan_len;
+    filter_stats.rank_memmove_bytes += bytes_moved;
+
+    if(scan_len > filter_stats.rank_scan_len_max)
+    {
+        filter_stats.rank_scan_len_max = scan_len;
+    }
+
+    filter_stats_update_end();
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+static inline void filter_stats_update_begin(void)
+{
+    filter_stats.sequence++;
+    FILTER_STATS_BARRIER();
+}
+
+
+static inline void filter_stats_update_end(void)
+{
+    FILTER_STATS_BARRIER();
+    filter_stats.sequence++;
+}
+
+
+/**
+ * @brief   Returns log2 histogram bucket of cycles count.
+ */
+static inline uint32_t filter_stats_hist_bin(uint32_t cycles)
+{
+    uint32_t bin = 0;
+
+    while(cycles != 0 && bin < FILTER_STATS_HIST_BINS - 1)
+    {
+        cycles >>= 1;
+        bin++;
+    }
+
+    return bin;
+}
@@ -0,0 +1,102 @@
+/*
+ * filter_stats.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_FILTER_STATS_H_
+#define SRC_MOD_FILTERS_FILTER_STATS_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+#include "fifo/FIFO_def.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Instrumentation is compiled in only when FILTER_STATS_ENABLE is defined.
+ * Otherwise all hooks below expand to nothing.
+ */
+
+/**
+ * Cycle counter used for latency histograms. Redefine it for your target,
+ * i.e. DWT->CYCCNT on Cortex-M.
+ */
+#ifndef FILTER_STATS_CYCLES
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILTER_STATS_CYCLES()   ((uint32_t)__builtin_ia32_rdtsc())
+#else
+#define FILTER_STATS_CYCLES()   (0u)
+#endif
+#endif
+
+/**
+ * Number of log2 buckets in cycles histogram. Bucket i counts calls which took [2^(i-1), 2^i) cycles.
+ * The last bucket also counts all longer calls.
+ */
+#define FILTER_STATS_HIST_BINS  24
+
+
+typedef enum {
+    FilterStatsMovingAvgSample = 0,
+    FilterStatsMovingAvgSequence,
+    FilterStatsRankSample,
+    FilterStatsRankSequence,
+    FILTER_STATS_PATHS_NUM
+} FilterStatsPath_t;
+
+
+typedef struct filter_stats_path {
+    uint32_t    calls;
+    uint32_t    samples;
+    uint32_t    cycles_hist[FILTER_STATS_HIST_BINS];
+} FilterStatsPathCounters_t;
+
+
+typedef struct filter_stats {
+    /* Odd while counters are being updated */
+    uint32_t    sequence;
+
+    FilterStatsPathCounters_t   path[FILTER_STATS_PATHS_NUM];
+
+    uint32_t    fifo_overflows;
+    uint32_t    fifo_underflows;
+
+    uint64_t    rank_scan_len;
+    uint32_t    rank_scan_len_max;
+    uint64_t    rank_memmove_bytes;
+} FilterStats_t;
+
+
+FilterStatus_t  filter_stats_snapshot(FilterStats_t *snapshot);
+void            filter_stats_reset(void);
+
+uint32_t        filter_stats_enter(void);
+void            filter_stats_leave(FilterStatsPath_t path, uint32_t start_cycles, uint32_t samples);
+FIFO_error_t    filter_stats_fifo(FIFO_error_t status);
+void            filter_stats_rank_scan(uint32_t scan_len, uint32_t bytes_moved);
+
+
+#ifdef FILTER_STATS_ENABLE
+#define FILTER_STATS_ENTER(t0)                  uint32_t t0 = filter_stats_enter()
+#define FILTER_STATS_LEAVE(path, t0, samples)   filter_stats_leave(path, t0, samples)
+#define FILTER_STATS_FIFO(status)               filter_stats_fifo(status)
+#define FILTER_STATS_RANK_SCAN(len, bytes)      filter_stats_rank_scan(len, bytes)
+#else
+#define FILTER_STATS_ENTER(t0)
+#define FILTER_STATS_LEAVE(path, t0, samples)   ((void)0)
+#define FILTER_STATS_FIFO(status)               (status)
+#define FILTER_STATS_RANK_SCAN(len, bytes)      ((void)0)
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_FILTER_STATS_H_ */
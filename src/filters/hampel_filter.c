@@ -0,0 +1,342 @@
+/*
+ * hampel_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call hampel_init(...) on your filter handle
+ *      2. Call hampel_fill_buffer(...) when you collected enough samples(equal to window size)
+ *              to compute the first sample.
+ *      3. Call hampel_filter_sample(...) on each new sample.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          4.1 Call hampel_flush(...)
+ *
+ *      After that you have to fill buffer again with:
+ *          4.2 hampel_fill_buffer(...) before sampling.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with hampel_filter_block(...).
+ *  It collects the first window itself and outputs one sample per input sample after that.
+ *  Outlier flags are written into bitmap: flag of y[i] is bit (i % 8) of byte i / 8.
+ *
+ *  You can also filter prepared sequence with hampel_filter_sequence(...).
+ *
+ *  Output sample corresponds to the middle sample of the window (offset (window_size - 1) / 2 from the oldest one).
+ *
+ *   Algorithm:
+ *      1. Sorted window is maintained by rank filter, median is its middle sample.
+ *      2. Absolute deviations from median of samples below it and above it form two sorted sequences.
+ *              MAD is the median of their union and is found by binary search over both sequences
+ *              in O(log(window_size)) without building them.
+ *      3. Middle sample is an outlier if |x - median| > threshold * 1.4826 * MAD. Outliers are replaced
+ *              with median, other samples pass unchanged.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hampel_filter.h"
+#include "filter_stats.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline int16_t hampel_output(const int16_t *sorted_window, uint16_t window_size, int16_t middle,
+		uint16_t threshold, uint8_t *outlier);
+static inline int32_t hampel_get_mad(const int16_t *sorted_window, uint16_t window_size);
+static inline void hampel_set_flag(uint8_t *outliers, uint16_t id, uint8_t outlier);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes Hampel filter
+ * @param	filter		-	filter handle
+ * @param 	buffer		-	buffer with incoming data. Length of buffer must match window size.
+ * @param	window_size	-	filter window size
+ * @param	threshold	-	outlier threshold in standard deviations, Q8.
+ *
+ * @return	Filter status
+ */
+FilterStatus_t hampel_init(HampelFilter_t *filter, int16_t *buffer, uint16_t window_size, uint16_t threshold)
+{
+	if(window_size == 0)
+	{
+		return FilterError;
+	}
+
+	filter->threshold = threshold;
+
+	return rank_filter_init(&filter->rank_filter, buffer, window_size, (window_size - 1) / 2);
+}
+
+
+/**
+ * @brief       Fill filter buffer for the first time
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   samples -   samples to be written. Length must match filter window size
+ * @param[out]  y       -   pointer where sample will be stored.
+ * @param[out]  outlier -   set to 1 if middle sample is an outlier. Can be NULL.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t hampel_fill_buffer(HampelFilter_t *filter, int16_t *samples, int16_t *y, uint8_t *outlier)
+{
+	RankFilter_t *rank_filter = &filter->rank_filter;
+	uint16_t window_size = rank_filter->window_size;
+
+	if(rank_filter_fill_buffer(rank_filter, samples, NULL) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	*y = hampel_output(rank_filter->sorted_window, window_size, samples[(window_size - 1) / 2],
+			filter->threshold, outlier);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	    Computes the next filtered sample.
+ * @note	    Costs one rank filter update and O(log(window_size)) on top of it.
+ *
+ * @param[in]	filter	    -   filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	        -	pointer to where filtered sample will be written.
+ * @param[out]  outlier     -   set to 1 if middle sample is an outlier. Can be NULL.
+ *
+ * @return	    Filter error status
+ */
+FilterStatus_t hampel_filter_sample(HampelFilter_t *filter, int16_t new_sample, int16_t *y, uint8_t *outlier)
+{
+	RankFilter_t *rank_filter = &filter->rank_filter;
+	uint16_t window_size = rank_filter->window_size;
+
+	int16_t last_sample, middle;
+
+	if(rank_filter_replace_sample(rank_filter, new_sample, &last_sample, NULL, NULL) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_peek(&rank_filter->fifo, &middle, (window_size - 1) / 2, 1)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	*y = hampel_output(rank_filter->sorted_window, window_size, middle, filter->threshold, outlier);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with hampel_fill_buffer. While the first window is not
+ *                  collected input samples produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  outliers    -   outlier flags bitmap. Must hold (data_len + 7) / 8 bytes. Can be NULL.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t hampel_filter_block(HampelFilter_t *filter, int16_t *data, uint16_t data_len,
+		int16_t *y, uint8_t *outliers, uint16_t *y_len)
+{
+	RankFilter_t *rank_filter = &filter->rank_filter;
+	uint16_t produced = 0;
+	uint16_t i = 0;
+	uint8_t outlier;
+
+	/* Collect the first window */
+	while(i < data_len && !rank_filter->initialized)
+	{
+		int16_t median;
+		uint16_t rank_len;
+
+		if(rank_filter_filter_block(rank_filter, &data[i++], 1, &median, &rank_len) != FilterOK)
+		{
+			return FilterError;
+		}
+
+		if(rank_len != 0)
+		{
+			int16_t middle;
+
+			if(FILTER_STATS_FIFO(FIFO_peek(&rank_filter->fifo, &middle, (rank_filter->window_size - 1) / 2, 1))
+					!= FIFO_OK)
+			{
+				return FilterError;
+			}
+
+			y[produced] = hampel_output(rank_filter->sorted_window, rank_filter->window_size, middle,
+					filter->threshold, &outlier);
+			hampel_set_flag(outliers, produced++, outlier);
+		}
+	}
+
+	for(; i<data_len; i++)
+	{
+		if(hampel_filter_sample(filter, data[i], &y[produced], &outlier) != FilterOK)
+		{
+			return FilterError;
+		}
+
+		hampel_set_flag(outliers, produced++, outlier);
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Performs Hampel filtering of a simple buffer.
+ *
+ * @param[in]   data        -   data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   filter window size
+ * @param[in]   threshold   -   outlier threshold in standard deviations, Q8
+ * @param[out]  y           -   pointer where output data will be stored.
+ * @param[out]  outliers    -   outlier flags bitmap. Must hold (y_len + 7) / 8 bytes. Can be NULL.
+ * @param[out]  y_len       -   output data length
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t hampel_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+		uint16_t threshold, int16_t *y, uint8_t *outliers, uint16_t *y_len)
+{
+	if(window_size == 0 || window_size > data_size)
+	{
+		return FilterError;
+	}
+
+	const uint16_t middle_offset = (window_size - 1) / 2;
+
+	uint16_t filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+	int16_t sorted_window[window_size];
+	uint8_t outlier;
+
+	memcpy(sorted_window, data, window_size * sizeof *data);
+	qsort(sorted_window, window_size, sizeof *sorted_window, filter_sort_cmp);
+
+	y[0] = hampel_output(sorted_window, window_size, data[middle_offset], threshold, &outlier);
+	hampel_set_flag(outliers, 0, outlier);
+
+	for(uint16_t i=1; i<filtered_len; i++)
+	{
+		rank_filter_window_update(sorted_window, window_size, data[i-1], data[i+window_size-1], NULL, NULL);
+
+		y[i] = hampel_output(sorted_window, window_size, data[i+middle_offset], threshold, &outlier);
+		hampel_set_flag(outliers, i, outlier);
+	}
+
+	*y_len = filtered_len;
+
+	return FilterOK;
+}
+
+
+void hampel_flush(HampelFilter_t *filter)
+{
+	rank_filter_flush(&filter->rank_filter);
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Replaces middle sample with median if it is an outlier.
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	window size
+ * @param	middle			-	middle sample of the window
+ * @param	threshold		-	threshold in standard deviations, Q8
+ * @param	outlier			-	outlier flag. Can be NULL.
+ *
+ * @return	Output sample
+ */
+static inline int16_t hampel_output(const int16_t *sorted_window, uint16_t window_size, int16_t middle,
+		uint16_t threshold, uint8_t *outlier)
+{
+	int16_t median = sorted_window[(window_size - 1) / 2];
+	int32_t deviation = abs((int32_t)middle - median);
+
+	/* deviation > threshold * 1.4826 * MAD, both factors are Q8 */
+	uint8_t is_outlier = ((int64_t)deviation << 16) >
+			(int64_t)threshold * HAMPEL_MAD_SCALE_Q8 * hampel_get_mad(sorted_window, window_size);
+
+	if(outlier != NULL)
+	{
+		*outlier = is_outlier;
+	}
+
+	return is_outlier ? median : middle;
+}
+
+
+/**
+ * @brief	Returns median absolute deviation of sorted window.
+ * @note	Deviations of samples at and below median m are L[j] = a[m] - a[m-j], j = 0..m.
+ * 				Deviations of samples above median are R[j] = a[m+1+j] - a[m]. Both are sorted, so
+ * 				the m-th smallest deviation is found by binary search on number of samples taken from L.
+ */
+static inline int32_t hampel_get_mad(const int16_t *sorted_window, uint16_t window_size)
+{
+	const int32_t m = (window_size - 1) / 2;
+	const int32_t left_len = m + 1;
+	const int32_t right_len = window_size - m - 1;
+	const int32_t median = sorted_window[m];
+
+	/* Take i deviations from L and m + 1 - i from R */
+	int32_t low = (m + 1 - right_len > 0) ? m + 1 - right_len : 0;
+	int32_t high = (m + 1 < left_len) ? m + 1 : left_len;
+
+	while(low < high)
+	{
+		int32_t i = (low + high) / 2;
+		int32_t j = m + 1 - i;
+
+		if(median - sorted_window[m-i] < sorted_window[m+j] - median)
+		{
+			low = i + 1;
+		}
+		else
+		{
+			high = i;
+		}
+	}
+
+	int32_t j = m + 1 - low;
+	int32_t left_max = (low > 0) ? median - sorted_window[m-low+1] : 0;
+	int32_t right_max = (j > 0) ? sorted_window[m+j] - median : 0;
+
+	return (left_max > right_max) ? left_max : right_max;
+}
+
+
+static inline void hampel_set_flag(uint8_t *outliers, uint16_t id, uint8_t outlier)
+{
+	if(outliers == NULL)
+	{
+		return;
+	}
+
+	if(outlier)
+	{
+		outliers[id / 8] |= (1u << (id % 8));
+	}
+	else
+	{
+		outliers[id / 8] &= ~(1u << (id % 8));
+	}
+}
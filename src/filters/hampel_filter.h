@@ -0,0 +1,54 @@
+/*
+ * hampel_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_HAMPEL_FILTER_H_
+#define SRC_MOD_FILTERS_HAMPEL_FILTER_H_
+
+#include "filter.h"
+#include "rank_filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * MAD to standard deviation scale factor 1.4826 in Q8
+ */
+#define HAMPEL_MAD_SCALE_Q8     380
+
+/**
+ * Common threshold of 3 standard deviations in Q8
+ */
+#define HAMPEL_DEFAULT_THRESHOLD_Q8     (3u << 8)
+
+
+typedef struct hampel_filter {
+
+	RankFilter_t		rank_filter;
+
+	/* Outlier threshold in standard deviations, Q8 */
+	uint16_t			threshold;
+
+} HampelFilter_t;
+
+
+FilterStatus_t  hampel_init(HampelFilter_t *filter, int16_t *buffer, uint16_t window_size, uint16_t threshold);
+FilterStatus_t  hampel_fill_buffer(HampelFilter_t *filter, int16_t *samples, int16_t *y, uint8_t *outlier);
+FilterStatus_t  hampel_filter_sample(HampelFilter_t *filter, int16_t new_sample, int16_t *y, uint8_t *outlier);
+FilterStatus_t  hampel_filter_block(HampelFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint8_t *outliers, uint16_t *y_len);
+FilterStatus_t  hampel_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+        uint16_t threshold, int16_t *y, uint8_t *outliers, uint16_t *y_len);
+void            hampel_flush(HampelFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_HAMPEL_FILTER_H_ */
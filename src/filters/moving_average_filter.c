@@ -18,8 +18,40 @@
  *
  *          No moving_avg_init(...) required.
  *
+ *  With moving_avg_set_warmup(...) enabled step 2 is not required. Filter outputs average of collected
+ *  samples until the first window is full and then continues as usual. The same happens after flush.
+ *
+ *  Window can be changed at runtime with moving_avg_resize(...) when filter was initialized with
+ *  moving_avg_init_capacity(...) and buffer larger than window. Shrinking drops the oldest samples,
+ *  growing collects new samples while output is averaged over samples collected so far.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with moving_avg_filter_block(...).
+ *  It collects the first window itself and outputs one sample per input sample after that.
+ *
  *  You can also filter prepared sequence with:
  *      1. moving_avg_filter_sequence(...)
+ *      2. moving_avg_filter_sequence_padded(...) if output must have the same length as input.
+ *
+ *  2D frames (row-major) are box filtered with moving_avg_filter_2d(...). Output is the valid region of
+ *  (width - kernel_width + 1) x (height - kernel_height + 1) samples. Rows are summed horizontally with running sum,
+ *  vertical sums are kept per column and updated with entering and leaving rows, so frame is never transposed.
+ *  Frame is split into bands of FILTER_2D_BAND_ROWS output rows which are processed in parallel with OpenMP.
+ *
+ *  Moving averages of up to MOVING_AVG_MULTI_MAX_WINDOWS window sizes are computed together with
+ *  moving_avg_multi_window_filter_sequence(...) in one pass over data with one shared prefix sum, or streamed with
+ *  moving_avg_multi_window_init(...) and moving_avg_multi_window_filter_sample(...) / _block(...).
+ *  Streaming filter holds one buffer of the largest window size and outputs averages of all windows
+ *  ending at the newest sample once the largest window is collected.
+ *
+ *  Filter state can be saved with moving_avg_save_state(...) and restored into a filter initialized
+ *  with the same window size by moving_avg_restore_state(...). Restored filter continues bit-exactly.
+ *
+ *  Long running filters can enable background accumulator resync with moving_avg_set_resync(...).
+ *  Filter then sums every window_size new samples into a shadow accumulator and replaces running sum with it
+ *  if they differ. No flush is required and output is not stalled.
+ *
+ *  Window update implementation is selected with moving_avg_set_backend(...). When library is built with
+ *  FILTER_AUTOTUNE_ENABLE, init takes it from autotune cache, see filter_autotune.c.
  *
  *   Algorithm:
  *      1. Keeps accumulative sum of the window.
@@ -33,12 +65,48 @@
 #include <string.h>
 
 #include "moving_average_filter.h"
+#include "filter_stats.h"
+#include "filter_autotune.h"
+
+
+/**
+ * Samples per tile of multi window sequence. Prefix sums of the tile are computed once, then every window
+ * takes its outputs of the tile from them.
+ */
+#define MOVING_AVG_MULTI_TILE   512
+
+
+/**
+ * Filter fields stored in checkpoint after header. Window samples follow it.
+ */
+typedef struct moving_average_state {
+	int64_t		prev_acc;
+	int64_t		resync_acc;
+	uint32_t	resync_count;
+	uint32_t	resync_corrections;
+	uint16_t	resync_pos;
+	uint8_t		initialized;
+	uint8_t		type;
+	uint8_t		resync_enabled;
+	uint8_t		growing;
+} MovingAverageState_t;
 
 
 /****** STATIC FUNCTION PROTOTYPES ********/
 static int16_t moving_avg_compute_first_output(MovingAverageFilter_t *filter);
 static int16_t moving_avg_filter_initalize(MovingAverageFilter_t *filter);
-static int16_t produce_output(int16_t current_sample, int32_t acc, uint32_t window_size, FilterType_t ftype);
+static inline FilterStatus_t moving_avg_compute_next_sample(MovingAverageFilter_t *filter, int16_t new_sample, int16_t *y);
+static inline int16_t moving_avg_ring_exchange(FIFO_t *fifo, int16_t new_sample);
+static FilterStatus_t moving_avg_warmup_sample(MovingAverageFilter_t *filter, int16_t new_sample, int16_t *y);
+static int16_t produce_output(int16_t current_sample, filter_acc_t acc, uint32_t window_size, FilterType_t ftype);
+static inline void moving_avg_resync_reset(MovingAverageFilter_t *filter);
+static FilterStatus_t moving_avg_2d_band(const int16_t *frame, uint16_t width, uint16_t kernel_width,
+		uint16_t kernel_height, uint32_t row_begin, uint32_t row_end, int16_t *y);
+static inline void moving_avg_2d_add_row(const int16_t *row, uint16_t y_width, uint16_t kernel_width,
+		filter_acc_t sign, filter_acc_t *column_sum);
+static inline filter_acc_t moving_avg_resync_step(MovingAverageFilter_t *filter, int16_t new_sample, filter_acc_t acc);
+static FilterStatus_t moving_avg_multi_window_check(const uint16_t *window_sizes, uint16_t windows_num,
+		uint16_t *max_window);
 
 
 /**************************** PUBLIC API ****************************/
@@ -56,13 +124,48 @@ static int16_t produce_output(int16_t current_sample, int32_t acc, uint32_t wind
 FilterStatus_t moving_avg_init(MovingAverageFilter_t *filter, FilterType_t ftype,
 		int16_t *buffer, uint16_t window_size)
 {
+	return moving_avg_init_capacity(filter, ftype, buffer, window_size, window_size);
+}
+
+
+/**
+ * @brief 	Initializes moving average filter which window can be resized later.
+ * @param	filter		-	filter handle
+ * @param	ftype		-	filter type
+ * @param	buffer		-	buffer which contains data.
+ * @param	buffer_size	-	buffer length. Maximum window size filter can be resized to.
+ * @param   window_size -   initial moving average window size.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t moving_avg_init_capacity(MovingAverageFilter_t *filter, FilterType_t ftype,
+		int16_t *buffer, uint16_t buffer_size, uint16_t window_size)
+{
+	if(window_size == 0 || window_size > buffer_size)
+	{
+		return FilterError;
+	}
+
 	filter->type = ftype;
+	filter->buffer_size = buffer_size;
 	filter->window_size = window_size;
 
 	filter->prev_acc = 0;
 	filter->initialized = 0;
+	filter->warmup = 0;
+	filter->growing = 0;
+
+	filter->resync_enabled = 0;
+	filter->resync_count = 0;
+	filter->resync_corrections = 0;
+	moving_avg_resync_reset(filter);
+
+	filter->backend = MovingAverageFifo;
+#ifdef FILTER_AUTOTUNE_ENABLE
+	filter_autotune_lookup_moving_avg(window_size, ftype, &filter->backend);
+#endif
 
-	FIFO_init(&filter->fifo, (uint8_t*)buffer, window_size, sizeof(*buffer), FIFO_LOOP);
+	FIFO_init(&filter->fifo, (uint8_t*)buffer, buffer_size, sizeof(*buffer), FIFO_LOOP);
 
 	return FilterOK;
 }
@@ -87,7 +190,7 @@ FilterStatus_t moving_avg_fill_buffer(MovingAverageFilter_t *filter, int16_t *da
     FIFO_t *fifo_ptr = &filter->fifo;
     uint32_t window_size = filter->window_size;
 
-    if(FIFO_write(fifo_ptr, data, window_size, NULL) != FIFO_OK)
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, data, window_size, NULL)) != FIFO_OK)
     {
         return FilterError;
     }
@@ -113,39 +216,77 @@ FilterStatus_t moving_avg_filter_sample(MovingAverageFilter_t *filter, int16_t n
 {
     if(!filter->initialized)
     {
-        return FilterError;
+        return (filter->warmup || filter->growing) ? moving_avg_warmup_sample(filter, new_sample, y) : FilterError;
     }
 
+    FilterStatus_t status;
+    FILTER_STATS_ENTER(t0);
+
+    status = moving_avg_compute_next_sample(filter, new_sample, y);
+
+    FILTER_STATS_LEAVE(FilterStatsMovingAvgSample, t0, 1);
+    return status;
+}
+
+
+/**
+ * @brief       Filters block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with moving_avg_fill_buffer. While the first window is not
+ *                  collected input samples produce no output unless warm-up mode is enabled.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_filter_block(MovingAverageFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len)
+{
     FIFO_t *fifo_ptr = &filter->fifo;
-    FilterType_t type = filter->type;
-    uint32_t window_size = filter->window_size;
+    uint16_t produced = 0;
+    uint16_t i = 0;
 
-    int32_t acc;
-    int16_t middle, new_x, last_x;
+    FILTER_STATS_ENTER(t0);
 
-    if(FIFO_read(fifo_ptr, &last_x, 1, NULL) != FIFO_OK)
+    /* Collect the first window */
+    while(i < data_len && !filter->initialized)
     {
-        return FilterError;
+        if(filter->warmup || filter->growing)
+        {
+            if(moving_avg_warmup_sample(filter, data[i++], &y[produced++]) != FilterOK)
+            {
+                return FilterError;
+            }
+
+            continue;
+        }
+
+        if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &data[i++], 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        if(FIFO_get_data_count(fifo_ptr) == filter->window_size)
+        {
+            y[produced++] = moving_avg_filter_initalize(filter);
+        }
     }
 
-    /**
-     * Replace old sample with a new one
-     */
-    if(FIFO_write(fifo_ptr, &new_sample, 1, NULL) != FIFO_OK)
+    for(; i<data_len; i++)
     {
-        return FilterError;
+        if(moving_avg_compute_next_sample(filter, data[i], &y[produced++]) != FilterOK)
+        {
+            return FilterError;
+        }
     }
 
-    acc = filter->prev_acc;
-    new_x = new_sample;
-    FIFO_get_middle_item(fifo_ptr, &middle);
+    *y_len = produced;
 
-    /* Cast in order to avoid overflow */
-    acc += (int32_t)new_x - (int32_t)last_x;
-    *y = produce_output(middle, acc, window_size, type);
-
-    filter->prev_acc = acc;
-	return FilterOK;
+    FILTER_STATS_LEAVE(FilterStatsMovingAvgSample, t0, produced);
+    return FilterOK;
 }
 
 
@@ -170,20 +311,22 @@ FilterStatus_t	moving_avg_filter_sequence(int16_t *data, uint16_t data_size,
         return FilterError;
     }
 
+    FILTER_STATS_ENTER(t0);
+
 	uint32_t filtered_len = filter_windowed_get_expected_output_len(data_size, window_size); // Always > 0
 	uint32_t recursive_items_num = 	filtered_len - 1; 			// Always >= 0
 
 	/* Contains accumulative sum */
-	int32_t acc = 0;
+	filter_acc_t acc = 0;
 
 	/* Computing the first output item */
 	for(uint32_t i=0; i<window_size; i++)
 	{
-		acc += (int32_t)data[i];
+		acc += (filter_acc_t)data[i];
 	}
 
 	uint32_t item_shift = 0;
-	y[item_shift++] = acc / window_size;
+	y[item_shift++] = acc / (filter_acc_t)window_size;
 
 	/* Recursive part */
 	uint32_t p = (window_size-1) / 2;
@@ -194,15 +337,150 @@ FilterStatus_t	moving_avg_filter_sequence(int16_t *data, uint16_t data_size,
 		uint32_t next_sample_id = i+2*p+item_shift;
 
 		acc += data[next_sample_id] - data[prev_sample_id];
-		y[i+item_shift] = acc / (int32_t)window_size;
+		y[i+item_shift] = acc / (filter_acc_t)window_size;
 	}
 
 	*y_data_len = filtered_len;
 
+	FILTER_STATS_LEAVE(FilterStatsMovingAvgSequence, t0, filtered_len);
 	return FilterOK;
 }
 
 
+/**
+ * @brief	Produces filtered sequence of the same length as input.
+ * @note	Samples outside of data are produced according to edge padding policy.
+ * 				Windows which cross data edges are handled by separate loops, interior loop has no checks.
+ *
+ * @param[in]	data	    -	data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   moving average window size
+ * @param[in]	edge	    -	padding and alignment configuration
+ * @param[out]	y	        -	buffer to save filtered data into. Must hold data_size samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_filter_sequence_padded(int16_t *data, uint16_t data_size, uint16_t window_size,
+        const FilterEdgeConfig_t *edge, int16_t *y)
+{
+    if(data_size == 0 || window_size == 0)
+    {
+        return FilterError;
+    }
+
+    FILTER_STATS_ENTER(t0);
+
+    int32_t n = data_size;
+    int32_t w = window_size;
+    int32_t left = filter_edge_get_left_len(window_size, edge->alignment);
+    filter_acc_t acc = 0;
+    int32_t i;
+
+    /* Window of the first output item */
+    for(int32_t k=-left; k<w-left; k++)
+    {
+        acc += (filter_acc_t)filter_edge_get_sample(data, n, k, edge);
+    }
+
+    y[0] = acc / (filter_acc_t)w;
+
+    /**
+     * Output item i drops sample i-left-1 and takes sample i-left+w-1.
+     * Both of them are inside data for i in [interior_start, interior_end).
+     */
+    int32_t interior_start = left + 1;
+    int32_t interior_end = n - w + left + 1;
+
+    if(interior_end > n)
+    {
+        interior_end = n;
+    }
+
+    for(i=1; i<interior_start && i<n; i++)
+    {
+        acc += (filter_acc_t)filter_edge_get_sample(data, n, i-left+w-1, edge)
+                - (filter_acc_t)filter_edge_get_sample(data, n, i-left-1, edge);
+        y[i] = acc / (filter_acc_t)w;
+    }
+
+    for(; i<interior_end; i++)
+    {
+        acc += (filter_acc_t)data[i-left+w-1] - (filter_acc_t)data[i-left-1];
+        y[i] = acc / (filter_acc_t)w;
+    }
+
+    for(; i<n; i++)
+    {
+        acc += (filter_acc_t)filter_edge_get_sample(data, n, i-left+w-1, edge)
+                - (filter_acc_t)filter_edge_get_sample(data, n, i-left-1, edge);
+        y[i] = acc / (filter_acc_t)w;
+    }
+
+    FILTER_STATS_LEAVE(FilterStatsMovingAvgSequence, t0, n);
+    return FilterOK;
+}
+
+
+/**
+ * @brief	Box filters 2D frame.
+ * @note	Output is the valid region, see filter_2d_get_output_size.
+ * @note	Kernel area must not exceed 65536 samples unless FILTER_WIDE_ACCUMULATOR is defined.
+ *
+ * @param[in]	frame	        -	row-major frame
+ * @param[in]   width           -   frame width
+ * @param[in]   height          -   frame height
+ * @param[in]   kernel_width    -   kernel width
+ * @param[in]   kernel_height   -   kernel height
+ * @param[out]	y	            -	row-major output frame
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_filter_2d(const int16_t *frame, uint16_t width, uint16_t height,
+        uint16_t kernel_width, uint16_t kernel_height, int16_t *y)
+{
+    uint16_t y_width, y_height;
+
+    if(filter_2d_get_output_size(width, height, kernel_width, kernel_height, &y_width, &y_height) != FilterOK)
+    {
+        return FilterError;
+    }
+
+    if(sizeof(filter_acc_t) < sizeof(int64_t) && (uint32_t)kernel_width * kernel_height > 65536u)
+    {
+        return FilterError;
+    }
+
+    int32_t bands_num = (y_height + FILTER_2D_BAND_ROWS - 1) / FILTER_2D_BAND_ROWS;
+    uint8_t band_status[bands_num];
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int32_t band=0; band<bands_num; band++)
+    {
+        uint32_t row_begin = band * FILTER_2D_BAND_ROWS;
+        uint32_t row_end = row_begin + FILTER_2D_BAND_ROWS;
+
+        if(row_end > y_height)
+        {
+            row_end = y_height;
+        }
+
+        band_status[band] = moving_avg_2d_band(frame, width, kernel_width, kernel_height, row_begin, row_end, y);
+    }
+
+    for(int32_t band=0; band<bands_num; band++)
+    {
+        if(band_status[band] != FilterOK)
+        {
+            return FilterError;
+        }
+    }
+
+    return FilterOK;
+}
+
+
 /**
  * @brief	Returns expected filtered sequence length.
  * @note	Works only with Simple buffer.
@@ -229,13 +507,577 @@ void moving_avg_flush(MovingAverageFilter_t *filter)
     FIFO_flush(fifo_ptr);
 
     filter->initialized = 0;
+    filter->growing = 0;
+    moving_avg_resync_reset(filter);
+}
+
+
+/**
+ * @brief       Changes window size keeping collected samples.
+ * @note        Shrinking drops the oldest samples and subtracts them from the running sum, so the cost is
+ *                  proportional to the size change. After growing the filter keeps producing outputs
+ *                  averaged over collected samples until the new window is full.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   window_size -   new window size. Must not exceed buffer size given at init.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_resize(MovingAverageFilter_t *filter, uint16_t window_size)
+{
+    FIFO_t *fifo_ptr = &filter->fifo;
+    uint16_t count = FIFO_get_data_count(fifo_ptr);
+    int16_t last_x;
+
+    if(window_size == 0 || window_size > filter->buffer_size)
+    {
+        return FilterError;
+    }
+
+    /* Drop the oldest samples which do not fit into the new window */
+    for(; count > window_size; count--)
+    {
+        if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_x, 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        filter->prev_acc -= (filter_acc_t)last_x;
+    }
+
+    if(filter->initialized && window_size > filter->window_size)
+    {
+        filter->initialized = 0;
+        filter->growing = 1;
+    }
+    else if(!filter->initialized && count == window_size)
+    {
+        /* Running sum is not tracked while collecting the first window */
+        filter->window_size = window_size;
+        filter->growing = 0;
+        moving_avg_filter_initalize(filter);
+    }
+
+    filter->window_size = window_size;
+    moving_avg_resync_reset(filter);
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Returns checkpoint size of filter state.
+ */
+uint32_t moving_avg_get_state_size(MovingAverageFilter_t *filter)
+{
+    return sizeof(FilterStateHeader_t) + sizeof(MovingAverageState_t)
+            + FIFO_get_data_count(&filter->fifo) * sizeof(int16_t);
+}
+
+
+/**
+ * @brief       Saves filter state into versioned checkpoint.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[out]  buf         -   checkpoint buffer
+ * @param[in]   buf_size    -   checkpoint buffer length. Use moving_avg_get_state_size to get required length.
+ * @param[out]  state_size  -   written checkpoint length. Can be NULL.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_save_state(MovingAverageFilter_t *filter, uint8_t *buf, uint32_t buf_size,
+        uint32_t *state_size)
+{
+    FIFO_t *fifo_ptr = &filter->fifo;
+    uint16_t items_num = FIFO_get_data_count(fifo_ptr);
+    uint32_t size = moving_avg_get_state_size(filter);
+
+    if(buf_size < size)
+    {
+        return FilterError;
+    }
+
+    MovingAverageState_t state;
+    memset(&state, 0, sizeof state);
+
+    state.prev_acc = filter->prev_acc;
+    state.resync_acc = filter->resync_acc;
+    state.resync_count = filter->resync_count;
+    state.resync_corrections = filter->resync_corrections;
+    state.resync_pos = filter->resync_pos;
+    state.initialized = filter->initialized;
+    state.type = filter->type;
+    state.resync_enabled = filter->resync_enabled;
+    state.growing = filter->growing;
+
+    filter_state_write_header(buf, FilterStateMovingAverage, filter->window_size, items_num, size);
+    buf += sizeof(FilterStateHeader_t);
+
+    memcpy(buf, &state, sizeof state);
+    buf += sizeof state;
+
+    FIFO_peek(fifo_ptr, buf, 0, items_num);
+
+    if(state_size != NULL)
+    {
+        *state_size = size;
+    }
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Restores filter state from checkpoint.
+ * @note        Filter must be initialized with moving_avg_init with the same window size.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   buf         -   checkpoint made with moving_avg_save_state
+ * @param[in]   buf_size    -   checkpoint length
+ *
+ * @return      FilterError if checkpoint is corrupted or does not match filter.
+ */
+FilterStatus_t moving_avg_restore_state(MovingAverageFilter_t *filter, const uint8_t *buf, uint32_t buf_size)
+{
+    FilterStateHeader_t header;
+    MovingAverageState_t state;
+
+    if(filter_state_read_header(buf, buf_size, FilterStateMovingAverage, filter->window_size, &header) != FilterOK)
+    {
+        return FilterError;
+    }
+
+    if(header.size != sizeof header + sizeof state + header.items_num * sizeof(int16_t))
+    {
+        return FilterError;
+    }
+
+    buf += sizeof header;
+    memcpy(&state, buf, sizeof state);
+    buf += sizeof state;
+
+    filter->prev_acc = state.prev_acc;
+    filter->resync_acc = state.resync_acc;
+    filter->resync_count = state.resync_count;
+    filter->resync_corrections = state.resync_corrections;
+    filter->resync_pos = state.resync_pos;
+    filter->initialized = state.initialized;
+    filter->type = state.type;
+    filter->resync_enabled = state.resync_enabled;
+    filter->growing = state.growing;
+
+    FIFO_load(&filter->fifo, buf, header.items_num);
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Enables or disables warm-up mode.
+ * @note        In warm-up mode moving_avg_filter_sample works before the first window is collected and
+ *                  outputs average of samples collected so far.
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   enable  -   0 to disable warm-up, otherwise enable
+ */
+void moving_avg_set_warmup(MovingAverageFilter_t *filter, uint8_t enable)
+{
+    filter->warmup = (enable != 0);
+}
+
+
+/**
+ * @brief       Enables or disables background resync of accumulative sum.
+ * @note        Every window_size samples running sum is replaced by the sum of the last window_size samples
+ *                  which is computed incrementally. Costs one addition per sample.
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   enable  -   0 to disable resync, otherwise enable
+ */
+void moving_avg_set_resync(MovingAverageFilter_t *filter, uint8_t enable)
+{
+    filter->resync_enabled = (enable != 0);
+    moving_avg_resync_reset(filter);
+}
+
+
+/**
+ * @brief       Selects window update implementation. See MovingAverageBackend_t.
+ * @note        Can be changed at any time, output does not depend on it.
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   backend -   window update implementation
+ */
+void moving_avg_set_backend(MovingAverageFilter_t *filter, MovingAverageBackend_t backend)
+{
+    filter->backend = backend;
+}
+
+
+/**
+ * @brief       Returns resync counters.
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[out]  resync_count    -   number of completed resyncs. Can be NULL.
+ * @param[out]  resync_corrections  -   number of resyncs which changed running sum. Can be NULL.
+ */
+void moving_avg_get_resync_stats(MovingAverageFilter_t *filter, uint32_t *resync_count,
+        uint32_t *resync_corrections)
+{
+    if(resync_count != NULL)
+    {
+        *resync_count = filter->resync_count;
+    }
+
+    if(resync_corrections != NULL)
+    {
+        *resync_corrections = filter->resync_corrections;
+    }
+}
+
+
+
+
+/**
+ * @brief 	Initializes multi window moving average
+ * @param	filter			-	filter handle
+ * @param	buffer			-	buffer with incoming data. Length must match the largest window size.
+ * @param	window_sizes	-	window sizes. Array is not copied and must outlive filter.
+ * @param	windows_num		-	number of windows, up to MOVING_AVG_MULTI_MAX_WINDOWS
+ *
+ * @return	Filter status
+ */
+FilterStatus_t moving_avg_multi_window_init(MovingAverageMultiWindow_t *filter, int16_t *buffer,
+		const uint16_t *window_sizes, uint16_t windows_num)
+{
+	if(moving_avg_multi_window_check(window_sizes, windows_num, &filter->max_window) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	filter->window_sizes = window_sizes;
+	filter->windows_num = windows_num;
+
+	FIFO_init(&filter->fifo, (uint8_t*)buffer, filter->max_window, sizeof(*buffer), FIFO_LOOP);
+	moving_avg_multi_window_flush(filter);
+
+	return FilterOK;
 }
 
 
+/**
+ * @brief	Feeds one sample into all windows.
+ *
+ * @param[in]	    filter	    -	filter handle
+ * @param[in]       new_sample  -   new raw sample.
+ * @param[out]  	y	        -	averages of all windows in order of window sizes. Written only if ready.
+ * @param[out]  	ready	    -	set to 1 when the largest window is collected and y is written.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t moving_avg_multi_window_filter_sample(MovingAverageMultiWindow_t *filter, int16_t new_sample,
+		int16_t *y, uint8_t *ready)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	uint16_t count = FIFO_get_data_count(fifo_ptr);
+	int16_t last_sample;
+
+	/* Every full window loses its oldest sample, the buffer holds the largest one */
+	for(uint16_t k=0; k<filter->windows_num; k++)
+	{
+		uint16_t window_size = filter->window_sizes[k];
+
+		if(count >= window_size)
+		{
+			if(FILTER_STATS_FIFO(FIFO_peek(fifo_ptr, &last_sample, count - window_size, 1)) != FIFO_OK)
+			{
+				return FilterError;
+			}
+
+			filter->acc[k] -= last_sample;
+		}
+
+		filter->acc[k] += new_sample;
+	}
+
+	if(count == filter->max_window)
+	{
+		if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_sample, 1, NULL)) != FIFO_OK)
+		{
+			return FilterError;
+		}
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	filter->initialized = filter->initialized || (count + 1 == filter->max_window);
+	*ready = filter->initialized;
+
+	if(filter->initialized)
+	{
+		for(uint16_t k=0; k<filter->windows_num; k++)
+		{
+			y[k] = filter->acc[k] / (filter_acc_t)filter->window_sizes[k];
+		}
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Feeds block of samples into all windows.
+ * @note        While the largest window is not collected input samples produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   outputs, windows_num averages per produced frame.
+ *                                  Must hold data_len * windows_num samples.
+ * @param[out]  y_len       -   number of produced frames.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_multi_window_filter_block(MovingAverageMultiWindow_t *filter, int16_t *data,
+		uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+	uint16_t produced = 0;
+	uint8_t ready;
+
+	for(uint16_t i=0; i<data_len; i++)
+	{
+		if(moving_avg_multi_window_filter_sample(filter, data[i], &y[produced * filter->windows_num], &ready)
+				!= FilterOK)
+		{
+			return FilterError;
+		}
+
+		produced += ready;
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Produces filtered sequences of all window sizes in one pass.
+ * @note	Data is read once. Prefix sums P of the last max_window + MOVING_AVG_MULTI_TILE samples are kept
+ * 				in a ring, every window computes its outputs of the tile as (P[i] - P[i - window_size]) / window_size
+ * 				reading the ring only.
+ * @note	Prefix sums fit 32 bits accumulator since data_size is below 65536.
+ *
+ * @param[in]	data	        -	data to be filtered
+ * @param[in]   data_size       -   data length
+ * @param[in]   window_sizes    -   window sizes, each up to data_size
+ * @param[in]   windows_num     -   number of windows, up to MOVING_AVG_MULTI_MAX_WINDOWS
+ * @param[out]	y	            -	output buffer of every window, each one holds data_size - window_size + 1 samples.
+ * @param[out]	y_lens	        - 	output length of every window
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t moving_avg_multi_window_filter_sequence(int16_t *data, uint16_t data_size,
+		const uint16_t *window_sizes, uint16_t windows_num, int16_t **y, uint16_t *y_lens)
+{
+	uint16_t max_window;
+
+	if(moving_avg_multi_window_check(window_sizes, windows_num, &max_window) != FilterOK || max_window > data_size)
+	{
+		return FilterError;
+	}
+
+	/* Power of two ring holding prefix sums P[i - max_window] .. P[i] for every i of the tile */
+	uint32_t ring_len = 1;
+	while(ring_len < (uint32_t)max_window + MOVING_AVG_MULTI_TILE + 1)
+	{
+		ring_len <<= 1;
+	}
+
+	const uint32_t mask = ring_len - 1;
+	filter_acc_t *prefix = _malloc(ring_len * sizeof *prefix);
+
+	if(prefix == NULL)
+	{
+		return FilterError;
+	}
+
+	filter_acc_t sum = 0;
+	prefix[0] = 0;
+
+	for(uint32_t tile=0; tile<data_size; tile+=MOVING_AVG_MULTI_TILE)
+	{
+		uint32_t tile_end = (data_size - tile < MOVING_AVG_MULTI_TILE) ? data_size : tile + MOVING_AVG_MULTI_TILE;
+
+		for(uint32_t i=tile; i<tile_end; i++)
+		{
+			sum += data[i];
+			prefix[(i + 1) & mask] = sum;
+		}
+
+		for(uint16_t k=0; k<windows_num; k++)
+		{
+			const uint32_t window_size = window_sizes[k];
+			int16_t *out = y[k];
+
+			/* Outputs of the window ending at samples tile .. tile_end - 1 */
+			for(uint32_t end=(tile + 1 > window_size) ? tile + 1 : window_size; end<=tile_end; end++)
+			{
+				out[end - window_size] = (prefix[end & mask] - prefix[(end - window_size) & mask])
+						/ (filter_acc_t)window_size;
+			}
+		}
+	}
+
+	_free(prefix);
+
+	for(uint16_t k=0; k<windows_num; k++)
+	{
+		y_lens[k] = filter_windowed_get_expected_output_len(data_size, window_sizes[k]);
+	}
+
+	return FilterOK;
+}
+
+
+void moving_avg_multi_window_flush(MovingAverageMultiWindow_t *filter)
+{
+	FIFO_flush(&filter->fifo);
+
+	for(uint16_t k=0; k<filter->windows_num; k++)
+	{
+		filter->acc[k] = 0;
+	}
+
+	filter->initialized = 0;
+}
+
 
 
 /**************************** PRIVATE API ****************************/
 
+/**
+ * @brief	Replaces the oldest sample of the window with a new one and computes output.
+ *
+ * @param	filter	-	filter handle
+ * @param	new_sample	-	new raw sample
+ * @param	y	-	variable where sample will be saved.
+ *
+ * @return	Filter error status
+ */
+static inline FilterStatus_t moving_avg_compute_next_sample(MovingAverageFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+    FIFO_t *fifo_ptr = &filter->fifo;
+    FilterType_t type = filter->type;
+    uint32_t window_size = filter->window_size;
+
+    filter_acc_t acc;
+    int16_t middle, new_x, last_x;
+
+    /**
+     * Replace old sample with a new one
+     */
+    if(filter->backend == MovingAverageDirectRing)
+    {
+        last_x = moving_avg_ring_exchange(fifo_ptr, new_sample);
+    }
+    else
+    {
+        if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_x, 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+    }
+
+    acc = filter->prev_acc;
+    new_x = new_sample;
+    FIFO_get_middle_item(fifo_ptr, &middle);
+
+    /* Cast in order to avoid overflow */
+    acc += (filter_acc_t)new_x - (filter_acc_t)last_x;
+
+    if(filter->resync_enabled)
+    {
+        acc = moving_avg_resync_step(filter, new_x, acc);
+    }
+
+    *y = produce_output(middle, acc, window_size, type);
+
+    filter->prev_acc = acc;
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Replaces the oldest sample of full ring with new one and returns the oldest sample.
+ * @note	Samples are exchanged in FIFO buffer without per byte FIFO API. Read and write indexes
+ * 				are moved as FIFO_read(...) and FIFO_write(...) would do, so FIFO stays consistent.
+ */
+static inline int16_t moving_avg_ring_exchange(FIFO_t *fifo, int16_t new_sample)
+{
+    FIFO8_t *fifo8 = &fifo->fifo8;
+    const uint16_t item_size = sizeof new_sample;
+    int16_t last_sample;
+
+    memcpy(&last_sample, &fifo8->pBuffer[fifo8->r_index], item_size);
+    memcpy(&fifo8->pBuffer[fifo8->w_index], &new_sample, item_size);
+
+    fifo8->r_index = (fifo8->r_index + item_size == fifo8->FIFO_size) ? 0 : fifo8->r_index + item_size;
+    fifo8->w_index = (fifo8->w_index + item_size == fifo8->FIFO_size) ? 0 : fifo8->w_index + item_size;
+
+    return last_sample;
+}
+
+
+
+/**
+ * @brief	Adds sample to not yet full window and computes output over collected samples.
+ * 				Filter becomes initialized when window is full.
+ *
+ * @param	filter	-	filter handle
+ * @param	new_sample	-	new raw sample
+ * @param	y	-	variable where sample will be saved.
+ *
+ * @return	Filter error status
+ */
+static FilterStatus_t moving_avg_warmup_sample(MovingAverageFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t middle;
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	uint16_t count = FIFO_get_data_count(fifo_ptr);
+	filter_acc_t acc = (count == 1) ? 0 : filter->prev_acc;
+
+	acc += (filter_acc_t)new_sample;
+	filter->prev_acc = acc;
+
+	if(count == filter->window_size)
+	{
+		filter->initialized = 1;
+		filter->growing = 0;
+		moving_avg_resync_reset(filter);
+	}
+
+	FIFO_get_middle_item(fifo_ptr, &middle);
+	*y = produce_output(middle, acc, count, filter->type);
+
+	return FilterOK;
+}
+
+
 /**
  * @brief	Internal initialization of filter. Computes first output sample.
  * 				After that recursive implementation will be used.
@@ -246,6 +1088,8 @@ void moving_avg_flush(MovingAverageFilter_t *filter)
 static int16_t moving_avg_filter_initalize(MovingAverageFilter_t *filter)
 {
 	filter->initialized = 1;
+	moving_avg_resync_reset(filter);
+
 	return moving_avg_compute_first_output(filter);
 }
 
@@ -259,13 +1103,13 @@ static int16_t moving_avg_filter_initalize(MovingAverageFilter_t *filter)
 static int16_t moving_avg_compute_first_output(MovingAverageFilter_t *filter)
 {
 	int16_t sample;
-	int32_t acc = 0;
+	filter_acc_t acc = 0;
 	uint32_t window_size = filter->window_size;
 	FilterType_t ftype = filter->type;
 	FIFO_t *fifo_ptr = &filter->fifo;
 
 	int16_t buf[filter->window_size];
-	if(FIFO_read(fifo_ptr, buf, window_size, NULL) != FIFO_OK)
+	if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, buf, window_size, NULL)) != FIFO_OK)
 	{
 	    return FilterError;
 	}
@@ -273,14 +1117,14 @@ static int16_t moving_avg_compute_first_output(MovingAverageFilter_t *filter)
 	/**
 	 * Write the same data again for future usage
 	 */
-	if(FIFO_write(fifo_ptr, buf, window_size, NULL) != FIFO_OK)
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, buf, window_size, NULL)) != FIFO_OK)
 	{
 	    return FilterError;
 	}
 
 	for(uint32_t i=0; i<filter->window_size; i++)
 	{
-		acc += (int32_t)buf[i];
+		acc += (filter_acc_t)buf[i];
 	}
 
 	int16_t middle;
@@ -294,18 +1138,157 @@ static int16_t moving_avg_compute_first_output(MovingAverageFilter_t *filter)
 
 
 
-static int16_t produce_output(int16_t current_sample, int32_t acc, uint32_t window_size, FilterType_t ftype)
+static int16_t produce_output(int16_t current_sample, filter_acc_t acc, uint32_t window_size, FilterType_t ftype)
 {
 	int16_t sample;
 
 	if(ftype == FilterHighPass)
 	{
-		sample = (int32_t)current_sample - (acc / (int32_t)window_size);
+		sample = (filter_acc_t)current_sample - (acc / (filter_acc_t)window_size);
 	}
 	else
 	{
-		sample = acc / (int32_t)window_size;
+		sample = acc / (filter_acc_t)window_size;
 	}
 
 	return sample;
 }
+
+
+/**
+ * @brief	Restarts shadow accumulator.
+ */
+static inline void moving_avg_resync_reset(MovingAverageFilter_t *filter)
+{
+	filter->resync_pos = 0;
+	filter->resync_acc = 0;
+}
+
+
+/**
+ * @brief	Adds new sample to shadow accumulator. When the whole window is replaced shadow accumulator
+ * 				holds exact window sum and it is used instead of running one.
+ *
+ * @param	filter	-	filter handle
+ * @param	new_sample	-	sample just written into window
+ * @param	acc		-	running sum including new sample
+ *
+ * @return	Running sum to be used.
+ */
+static inline filter_acc_t moving_avg_resync_step(MovingAverageFilter_t *filter, int16_t new_sample, filter_acc_t acc)
+{
+	filter->resync_acc += (filter_acc_t)new_sample;
+
+	if(++filter->resync_pos < filter->window_size)
+	{
+		return acc;
+	}
+
+	filter->resync_count++;
+
+	if(filter->resync_acc != acc)
+	{
+		filter->resync_corrections++;
+		acc = filter->resync_acc;
+	}
+
+	moving_avg_resync_reset(filter);
+	return acc;
+}
+
+
+/**
+ * @brief	Box filters output rows [row_begin, row_end) of 2D frame.
+ * @note	Column sums of the first window are computed from scratch, then each output row adds
+ * 				horizontal sums of the entering row and subtracts ones of the leaving row.
+ */
+static FilterStatus_t moving_avg_2d_band(const int16_t *frame, uint16_t width, uint16_t kernel_width,
+		uint16_t kernel_height, uint32_t row_begin, uint32_t row_end, int16_t *y)
+{
+	const uint16_t y_width = width - kernel_width + 1;
+	const filter_acc_t area = (filter_acc_t)kernel_width * kernel_height;
+
+	/* Allocated per band, stacks of OpenMP workers may be small */
+	filter_acc_t *column_sum = _malloc(y_width * sizeof *column_sum);
+	if(column_sum == NULL)
+	{
+		return FilterError;
+	}
+
+	memset(column_sum, 0, y_width * sizeof *column_sum);
+
+	for(uint32_t r=row_begin; r<row_begin+kernel_height; r++)
+	{
+		moving_avg_2d_add_row(frame + r*width, y_width, kernel_width, 1, column_sum);
+	}
+
+	for(uint32_t r=row_begin; r<row_end; r++)
+	{
+		if(r != row_begin)
+		{
+			moving_avg_2d_add_row(frame + (r+kernel_height-1)*width, y_width, kernel_width, 1, column_sum);
+			moving_avg_2d_add_row(frame + (r-1)*width, y_width, kernel_width, -1, column_sum);
+		}
+
+		int16_t *y_row = y + r*y_width;
+
+		for(uint16_t x=0; x<y_width; x++)
+		{
+			y_row[x] = column_sum[x] / area;
+		}
+	}
+
+	_free(column_sum);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Adds horizontal running sums of one row multiplied by sign to column sums.
+ */
+static inline void moving_avg_2d_add_row(const int16_t *row, uint16_t y_width, uint16_t kernel_width,
+		filter_acc_t sign, filter_acc_t *column_sum)
+{
+	filter_acc_t acc = 0;
+
+	for(uint16_t x=0; x<kernel_width; x++)
+	{
+		acc += row[x];
+	}
+
+	column_sum[0] += sign * acc;
+
+	for(uint16_t x=1; x<y_width; x++)
+	{
+		acc += (filter_acc_t)row[x+kernel_width-1] - row[x-1];
+		column_sum[x] += sign * acc;
+	}
+}
+
+
+/**
+ * @brief	Checks window sizes of multi window moving average and finds the largest one.
+ */
+static FilterStatus_t moving_avg_multi_window_check(const uint16_t *window_sizes, uint16_t windows_num,
+		uint16_t *max_window)
+{
+	if(windows_num == 0 || windows_num > MOVING_AVG_MULTI_MAX_WINDOWS)
+	{
+		return FilterError;
+	}
+
+	*max_window = 0;
+
+	for(uint16_t k=0; k<windows_num; k++)
+	{
+		if(window_sizes[k] == 0)
+		{
+			return FilterError;
+		}
+
+		*max_window = (window_sizes[k] > *max_window) ? window_sizes[k] : *max_window;
+	}
+
+	return FilterOK;
+}
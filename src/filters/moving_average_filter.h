@@ -17,12 +17,32 @@ extern "C" {
 #endif
 
 
+/**
+ * Window update of moving_avg_filter_sample(...) and moving_avg_filter_block(...):
+ *      Fifo        -   expiring sample is read and new one is written with FIFO API
+ *      DirectRing  -   both are exchanged in FIFO buffer directly, FIFO state is kept valid
+ * Both give identical output.
+ */
+typedef enum {MovingAverageFifo=0, MovingAverageDirectRing} MovingAverageBackend_t;
+
+
 typedef struct moving_average_filter {
 
     uint16_t            buffer_size;
 	uint16_t 			window_size;
-	int32_t				prev_acc;
+	filter_acc_t		prev_acc;
 	uint8_t				initialized;
+	uint8_t				warmup;
+	uint8_t				growing;
+
+	/* Background accumulator resync */
+	uint8_t				resync_enabled;
+	uint16_t			resync_pos;
+	filter_acc_t		resync_acc;
+	uint32_t			resync_count;
+	uint32_t			resync_corrections;
+
+	MovingAverageBackend_t	backend;
 
 	FilterType_t		type;
 	FIFO_t              fifo;
@@ -30,14 +50,63 @@ typedef struct moving_average_filter {
 } MovingAverageFilter_t;
 
 
+/**
+ * Maximum number of windows of multi window moving average
+ */
+#define MOVING_AVG_MULTI_MAX_WINDOWS    16
+
+
+typedef struct moving_average_multi_window {
+
+	const uint16_t		*window_sizes;
+	uint16_t			windows_num;
+	uint16_t			max_window;
+
+	filter_acc_t		acc[MOVING_AVG_MULTI_MAX_WINDOWS];
+	uint8_t				initialized;
+
+	/* Holds the largest window */
+	FIFO_t				fifo;
+
+} MovingAverageMultiWindow_t;
+
+
 FilterStatus_t  moving_avg_init(MovingAverageFilter_t *filter, FilterType_t ftype,
         int16_t *buffer, uint16_t window_size);
+FilterStatus_t  moving_avg_init_capacity(MovingAverageFilter_t *filter, FilterType_t ftype,
+        int16_t *buffer, uint16_t buffer_size, uint16_t window_size);
+FilterStatus_t  moving_avg_resize(MovingAverageFilter_t *filter, uint16_t window_size);
 FilterStatus_t  moving_avg_fill_buffer(MovingAverageFilter_t *filter, int16_t *data, int16_t *y);
 FilterStatus_t  moving_avg_filter_sample(MovingAverageFilter_t *filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  moving_avg_filter_block(MovingAverageFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
 FilterStatus_t  moving_avg_filter_sequence(int16_t *data, uint16_t data_size,
         uint16_t window_size, int16_t *y, uint16_t *y_data_len);
+FilterStatus_t  moving_avg_filter_sequence_padded(int16_t *data, uint16_t data_size, uint16_t window_size,
+        const FilterEdgeConfig_t *edge, int16_t *y);
+FilterStatus_t  moving_avg_filter_2d(const int16_t *frame, uint16_t width, uint16_t height,
+        uint16_t kernel_width, uint16_t kernel_height, int16_t *y);
 FilterStatus_t  moving_avg_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len);
 void            moving_avg_flush(MovingAverageFilter_t *filter);
+uint32_t        moving_avg_get_state_size(MovingAverageFilter_t *filter);
+FilterStatus_t  moving_avg_save_state(MovingAverageFilter_t *filter, uint8_t *buf, uint32_t buf_size,
+        uint32_t *state_size);
+FilterStatus_t  moving_avg_restore_state(MovingAverageFilter_t *filter, const uint8_t *buf, uint32_t buf_size);
+void            moving_avg_set_warmup(MovingAverageFilter_t *filter, uint8_t enable);
+void            moving_avg_set_resync(MovingAverageFilter_t *filter, uint8_t enable);
+void            moving_avg_set_backend(MovingAverageFilter_t *filter, MovingAverageBackend_t backend);
+void            moving_avg_get_resync_stats(MovingAverageFilter_t *filter, uint32_t *resync_count,
+        uint32_t *resync_corrections);
+
+FilterStatus_t  moving_avg_multi_window_init(MovingAverageMultiWindow_t *filter, int16_t *buffer,
+        const uint16_t *window_sizes, uint16_t windows_num);
+FilterStatus_t  moving_avg_multi_window_filter_sample(MovingAverageMultiWindow_t *filter, int16_t new_sample,
+        int16_t *y, uint8_t *ready);
+FilterStatus_t  moving_avg_multi_window_filter_block(MovingAverageMultiWindow_t *filter, int16_t *data,
+        uint16_t data_len, int16_t *y, uint16_t *y_len);
+FilterStatus_t  moving_avg_multi_window_filter_sequence(int16_t *data, uint16_t data_size,
+        const uint16_t *window_sizes, uint16_t windows_num, int16_t **y, uint16_t *y_lens);
+void            moving_avg_multi_window_flush(MovingAverageMultiWindow_t *filter);
 
 
 
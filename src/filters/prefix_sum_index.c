@@ -0,0 +1,260 @@
+/*
+ * prefix_sum_index.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Allocate prefix_sum_index_get_storage_len(...) int64_t items for the index.
+ *      2. Call prefix_sum_index_build(...) once on stored data. Data must stay in place while index is used.
+ *      3. Query mean of any range [begin, end) with prefix_sum_index_range_mean(...) or many ranges at once
+ *              with prefix_sum_index_range_means(...).
+ *      4. prefix_sum_index_moving_avg(...) produces the same output as moving_avg_filter_sequence(...)
+ *              for any window size without summing windows again.
+ *
+ *  Means are rounded towards zero, as in moving average filter.
+ *
+ *   Algorithm:
+ *      1. Index keeps 64 bit prefix sums P[k] = data[0] + ... + data[k-1], so sum of [begin, end) is
+ *              P[end] - P[begin].
+ *      2. Blocked index keeps only every 2^block_shift-th prefix sum, memory shrinks by the same factor.
+ *              Range sum then adds less than 2^block_shift samples after each stored boundary,
+ *              query costs O(2^block_shift) instead of O(1).
+ */
+
+
+#include <stdlib.h>
+
+#include "prefix_sum_index.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline int64_t prefix_sum_index_prefix(const PrefixSumIndex_t *index, uint32_t pos);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief	Returns number of int64_t items index of data_size samples needs.
+ */
+uint32_t prefix_sum_index_get_storage_len(uint32_t data_size, uint8_t block_shift)
+{
+	return (data_size >> block_shift) + 1;
+}
+
+
+/**
+ * @brief 	Builds index in one pass over data
+ *
+ * @param	index		-	index handle
+ * @param	data		-	indexed data. It is not copied and must outlive index.
+ * @param	data_size	-	data length
+ * @param	block_shift	-	0 for full index, otherwise one prefix sum is kept per 2^block_shift samples.
+ * 							Must not exceed PREFIX_SUM_INDEX_MAX_BLOCK_SHIFT.
+ * @param	prefix		-	storage of prefix_sum_index_get_storage_len(data_size, block_shift) items
+ *
+ * @return	Filter status
+ */
+FilterStatus_t prefix_sum_index_build(PrefixSumIndex_t *index, const int16_t *data, uint32_t data_size,
+		uint8_t block_shift, int64_t *prefix)
+{
+	if(block_shift > PREFIX_SUM_INDEX_MAX_BLOCK_SHIFT)
+	{
+		return FilterError;
+	}
+
+	const uint32_t block_size = 1u << block_shift;
+	const uint32_t blocks_num = data_size >> block_shift;
+
+	index->data = data;
+	index->data_size = data_size;
+	index->block_shift = block_shift;
+	index->prefix = prefix;
+
+	int64_t sum = 0;
+	prefix[0] = 0;
+
+	for(uint32_t k=0; k<blocks_num; k++)
+	{
+		const int16_t *block = data + (k << block_shift);
+
+		/* Block sum never exceeds 32 bits, so the inner loop is cheap */
+		int32_t block_sum = 0;
+
+		for(uint32_t i=0; i<block_size; i++)
+		{
+			block_sum += block[i];
+		}
+
+		sum += block_sum;
+		prefix[k+1] = sum;
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Returns sum of data[begin .. end)
+ *
+ * @param[in]   index   -   index handle
+ * @param[in]   begin   -   the first sample of range
+ * @param[in]   end     -   sample after the last one of range
+ * @param[out]  sum     -   range sum
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t prefix_sum_index_range_sum(const PrefixSumIndex_t *index, uint32_t begin, uint32_t end, int64_t *sum)
+{
+	if(begin > end || end > index->data_size)
+	{
+		return FilterError;
+	}
+
+	*sum = prefix_sum_index_prefix(index, end) - prefix_sum_index_prefix(index, begin);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Returns mean of data[begin .. end)
+ *
+ * @param[in]   index   -   index handle
+ * @param[in]   begin   -   the first sample of range
+ * @param[in]   end     -   sample after the last one of range. Range must not be empty.
+ * @param[out]  mean    -   range mean
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t prefix_sum_index_range_mean(const PrefixSumIndex_t *index, uint32_t begin, uint32_t end, int16_t *mean)
+{
+	int64_t sum;
+
+	if(begin == end || prefix_sum_index_range_sum(index, begin, end, &sum) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	*mean = sum / (int64_t)(end - begin);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Answers batch of range mean queries.
+ * @note        All queries are checked before any of them is answered.
+ *
+ * @param[in]   index       -   index handle
+ * @param[in]   begins      -   the first samples of ranges
+ * @param[in]   ends        -   samples after the last ones of ranges
+ * @param[in]   queries_num -   number of queries
+ * @param[out]  means       -   range means
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t prefix_sum_index_range_means(const PrefixSumIndex_t *index, const uint32_t *begins,
+		const uint32_t *ends, uint32_t queries_num, int16_t *means)
+{
+	for(uint32_t q=0; q<queries_num; q++)
+	{
+		if(begins[q] >= ends[q] || ends[q] > index->data_size)
+		{
+			return FilterError;
+		}
+	}
+
+	if(index->block_shift == 0)
+	{
+		/* Full index has no data scans, loop is plain gathers and arithmetic */
+		const int64_t *prefix = index->prefix;
+
+		for(uint32_t q=0; q<queries_num; q++)
+		{
+			means[q] = (prefix[ends[q]] - prefix[begins[q]]) / (int64_t)(ends[q] - begins[q]);
+		}
+	}
+	else
+	{
+		for(uint32_t q=0; q<queries_num; q++)
+		{
+			means[q] = (prefix_sum_index_prefix(index, ends[q]) - prefix_sum_index_prefix(index, begins[q]))
+					/ (int64_t)(ends[q] - begins[q]);
+		}
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Produces moving average of indexed data.
+ * @note        Output matches moving_avg_filter_sequence(...) with the same window size.
+ *
+ * @param[in]   index       -   index handle
+ * @param[in]   window_size -   any window size up to data length
+ * @param[out]  y           -   output, data_size - window_size + 1 samples
+ * @param[out]  y_len       -   output length
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t prefix_sum_index_moving_avg(const PrefixSumIndex_t *index, uint32_t window_size,
+		int16_t *y, uint32_t *y_len)
+{
+	if(window_size == 0 || window_size > index->data_size)
+	{
+		return FilterError;
+	}
+
+	const uint32_t filtered_len = index->data_size - window_size + 1;
+	const int64_t n = window_size;
+
+	if(index->block_shift == 0)
+	{
+		const int64_t *prefix = index->prefix;
+
+		for(uint32_t i=0; i<filtered_len; i++)
+		{
+			y[i] = (prefix[i + window_size] - prefix[i]) / n;
+		}
+	}
+	else
+	{
+		/* The first window comes from index, the rest slides over data */
+		const int16_t *data = index->data;
+		int64_t sum = prefix_sum_index_prefix(index, window_size);
+
+		y[0] = sum / n;
+
+		for(uint32_t i=1; i<filtered_len; i++)
+		{
+			sum += data[i + window_size - 1] - data[i - 1];
+			y[i] = sum / n;
+		}
+	}
+
+	*y_len = filtered_len;
+
+	return FilterOK;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Returns sum of data[0 .. pos)
+ */
+static inline int64_t prefix_sum_index_prefix(const PrefixSumIndex_t *index, uint32_t pos)
+{
+	uint32_t block = pos >> index->block_shift;
+	int64_t sum = index->prefix[block];
+
+	for(uint32_t i=block << index->block_shift; i<pos; i++)
+	{
+		sum += index->data[i];
+	}
+
+	return sum;
+}
@@ -0,0 +1,51 @@
+/*
+ * prefix_sum_index.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_PREFIX_SUM_INDEX_H_
+#define SRC_MOD_FILTERS_PREFIX_SUM_INDEX_H_
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Maximum block shift. Blocked index stores one prefix sum per 2^block_shift samples.
+ */
+#define PREFIX_SUM_INDEX_MAX_BLOCK_SHIFT    12
+
+
+typedef struct prefix_sum_index {
+
+	const int16_t	*data;
+	uint32_t		data_size;
+	uint8_t			block_shift;
+
+	/* prefix[k] is sum of data[0 .. k << block_shift) */
+	int64_t			*prefix;
+
+} PrefixSumIndex_t;
+
+
+uint32_t        prefix_sum_index_get_storage_len(uint32_t data_size, uint8_t block_shift);
+FilterStatus_t  prefix_sum_index_build(PrefixSumIndex_t *index, const int16_t *data, uint32_t data_size,
+        uint8_t block_shift, int64_t *prefix);
+FilterStatus_t  prefix_sum_index_range_sum(const PrefixSumIndex_t *index, uint32_t begin, uint32_t end, int64_t *sum);
+FilterStatus_t  prefix_sum_index_range_mean(const PrefixSumIndex_t *index, uint32_t begin, uint32_t end, int16_t *mean);
+FilterStatus_t  prefix_sum_index_range_means(const PrefixSumIndex_t *index, const uint32_t *begins,
+        const uint32_t *ends, uint32_t queries_num, int16_t *means);
+FilterStatus_t  prefix_sum_index_moving_avg(const PrefixSumIndex_t *index, uint32_t window_size,
+        int16_t *y, uint32_t *y_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_PREFIX_SUM_INDEX_H_ */
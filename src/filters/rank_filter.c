@@ -9,6 +9,9 @@
 #include <string.h>
 
 #include "rank_filter.h"
+#include "filter_stats.h"
+#include "filter_autotune.h"
+#include "sort_network.h"
 
 /**
  *  USAGE:
@@ -24,19 +27,127 @@
  *
  *          No rank_filter_init(...) required.
  *
+ *      5. Call rank_filter_deinit(...) to release filter memory.
+ *
+ *  With rank_filter_set_warmup(...) enabled step 2 is not required. Until the first window is full filter outputs
+ *  sample of proportional rank (rank * (count - 1) / (window_size - 1)) of collected samples. The same happens after flush.
+ *
+ *  Window and rank can be changed at runtime with rank_filter_resize(...) and rank_filter_set_rank(...).
+ *  Resizing requires filter to be initialized with rank_filter_init_capacity(...) and buffer larger than window.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with rank_filter_filter_block(...).
+ *  It collects the first window itself and outputs one sample per input sample after that.
+ *
+ *  If only every R-th output is needed use decimated filter:
+ *      1. Call rank_filter_decimated_init(...) with decimation R.
+ *      2. Call rank_filter_decimated_filter_sample(...) on each new sample or feed blocks with
+ *          rank_filter_decimated_filter_block(...). The first output is produced when the first window is
+ *          collected and then after every R samples, i.e. outputs 0, R, 2R, ... of rank_filter_filter_block(...).
+ *      Warm-up mode, resizing and checkpoints are not supported by decimated filter.
+ *
+ *  Several ranks of the same window can be computed by one filter:
+ *      1. Call rank_filter_multi_init(...) with the list of ranks.
+ *      2. Call rank_filter_multi_fill_buffer(...) and rank_filter_multi_filter_sample(...).
+ *          They output one sample per rank in the order of the list.
+ *
+ *  Sorted window update implementation is selected with rank_filter_set_backend(...). When library is built with
+ *  FILTER_AUTOTUNE_ENABLE, init takes it from autotune cache, see filter_autotune.c.
+ *
+ *  Filter state can be saved with rank_filter_save_state(...) and restored into a filter initialized
+ *  with the same window size by rank_filter_restore_state(...). Restored filter continues bit-exactly.
+ *
  *  You can also filter prepared sequence with:
  *      1. rank_filter_filter_sequence(...)
+ *      2. rank_filter_filter_sequence_padded(...) if output must have the same length as input.
+ *
+ *  2D frames (row-major) are filtered with rank_filter_filter_2d(...), median rank is (kernel_width * kernel_height - 1) / 2.
+ *  Output is the valid region of (width - kernel_width + 1) x (height - kernel_height + 1) samples. Frame is split into bands
+ *  of FILTER_2D_BAND_ROWS output rows which are processed in parallel with OpenMP.
  *
  *   Algorithm:
  *      1. When buffer is filled for the first time it sorts window with qsort and return element with given rank.
+ *          rank_filter_filter_sequence(...) sorts windows of 3, 5, 7 and 9 samples with sorting networks
+ *          computing SORT_NETWORK_LANES outputs at once.
  *      2. On each new sample it removes last sample from sorted window and inserts new sample into it.
+ *      3. Decimated filter collects R new and R expired samples, sorts both batches and merges them into
+ *          sorted window in one pass removing expired ones. Cost per output is O(window_size + R * log(R))
+ *          instead of O(R * window_size).
+ *
+ *   2D algorithm (Perreault, Hebert "Median filtering in constant time"):
+ *      1. Samples are offset by frame minimum and split into coarse (high) and fine (low) bits. Bit depth is
+ *          taken from frame range, so narrow range frames get small histograms.
+ *      2. Every column keeps coarse and fine histograms of kernel_height samples. Moving one row down
+ *          updates each column with one removed and one added sample.
+ *      3. Kernel coarse histogram slides along the row adding entering column and subtracting leaving one.
+ *          Coarse bin of required rank is found in it, then kernel fine histogram of that bin only is
+ *          brought up to date lazily from column fine histograms.
+ *      4. Columns are processed in strips which histograms fit into RANK_FILTER_2D_HIST_BUDGET.
+ *      5. If histograms of wide range frame do not fit, band keeps sorted frame columns and sorted kernel window.
+ *          Moving one row down updates every column with rank_filter_window_update(...). Window walks the band
+ *          in serpentine order and every step merges one entering sorted column (or kernel row) into the window
+ *          dropping the leaving one in one pass.
+ */
+
+
+/**
+ * Filter fields stored in checkpoint after header. Window samples and sorted window follow it.
+ */
+typedef struct rank_filter_state {
+	uint16_t	rank;
+	uint8_t		initialized;
+	uint8_t		growing;
+} RankFilterState_t;
+
+
+/**
+ * Parameters and scratch histograms of 2D rank filter band.
  */
+typedef struct rank_filter_2d {
+	const int16_t	*frame;
+	int16_t			*y;
+	uint16_t		width;
+	uint16_t		y_width;
+	uint16_t		kernel_width;
+	uint16_t		kernel_height;
+	uint32_t		rank;
+
+	/* Histogram layout */
+	int16_t			offset;
+	uint8_t			fine_bits;
+	uint32_t		coarse_bins;
+	uint16_t		columns;
+
+	uint16_t		*column_coarse;		/* [columns][coarse_bins] */
+	uint16_t		*column_fine;		/* [columns][coarse_bins << fine_bits] */
+	uint32_t		*kernel_coarse;
+	uint32_t		*kernel_fine;
+	int32_t			*fine_synced;		/* kernel position where fine histogram of coarse bin was updated */
+} RankFilter2d_t;
 
 
 /* Private functions prototypes */
-static int sort_cmp_func(const void *pdata1, const void *pdata2);
+static FilterStatus_t rank_filter_2d_band(RankFilter2d_t *config, uint32_t row_begin, uint32_t row_end);
+static FilterStatus_t rank_filter_2d_band_direct(const RankFilter2d_t *config, uint32_t row_begin, uint32_t row_end);
+static inline void rank_filter_2d_update_column(RankFilter2d_t *config, uint16_t column, int16_t sample, int16_t delta);
+static void rank_filter_2d_row(RankFilter2d_t *config, uint16_t y_len, int16_t *y);
 static inline FilterStatus_t rank_filter_compute_first_output(RankFilter_t *filter, int16_t *y);
 static inline FilterStatus_t rank_filter_compute_next_sample(RankFilter_t *filter, int16_t new_sample, int16_t *y);
+static inline void rank_filter_window_replace(int16_t *sorted_window, uint16_t window_size,
+		int16_t last_sample, int16_t new_sample, uint16_t *removed_pos, uint16_t *inserted_pos);
+static inline void rank_filter_window_replace_bsearch(int16_t *sorted_window, uint16_t window_size,
+		int16_t last_sample, int16_t new_sample);
+static inline uint16_t rank_filter_lower_bound(const int16_t *sorted_window, uint16_t begin, uint16_t end,
+		int16_t sample);
+static inline void rank_filter_window_remove(int16_t *sorted_window, uint16_t window_size, int16_t sample);
+static void rank_filter_window_batch_replace(int16_t *sorted_window, uint16_t window_size, int16_t *last_samples,
+		int16_t *new_samples, uint16_t batch_len, int16_t *merged);
+static void rank_filter_window_merge(const int16_t *sorted_window, uint32_t window_size, const int16_t *last_samples,
+		const int16_t *new_samples, uint32_t batch_len, int16_t *merged);
+static inline void rank_filter_multi_output(RankFilter_t *filter, int16_t *y);
+static inline uint16_t rank_filter_current_rank(RankFilter_t *filter, uint16_t rank);
+static FilterStatus_t rank_filter_warmup_sample(RankFilter_t *filter, int16_t new_sample, int16_t *y);
+static void rank_filter_sequence_network(const SortNetwork_t *network, int16_t *data, uint16_t filtered_len,
+		uint16_t rank, int16_t *y);
 
 
 
@@ -55,22 +166,52 @@ static inline FilterStatus_t rank_filter_compute_next_sample(RankFilter_t *filte
  */
 FilterStatus_t	rank_filter_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size, uint16_t rank)
 {
-	if(rank > window_size - 1)
+	return rank_filter_init_capacity(rank_filter, buffer, window_size, window_size, rank);
+}
+
+
+/**
+ * @brief 	Performs initialization of rank filter which window can be resized later
+ * @param	rank_filter	- rank filter handle
+ * @param 	buffer		-	buffer with incoming data
+ * @param	buffer_size	-	buffer length. Maximum window size filter can be resized to.
+ * @param	window_size	-	initial filter window size.
+ * @param	rank		-	filter rank
+ *
+ * @return	Filter status
+ */
+FilterStatus_t	rank_filter_init_capacity(RankFilter_t *rank_filter, int16_t *buffer, uint16_t buffer_size,
+		uint16_t window_size, uint16_t rank)
+{
+	if(window_size == 0 || window_size > buffer_size || rank > window_size - 1)
 	{
 		return FilterError;
 	}
 
+	rank_filter->buffer_size = buffer_size;
 	rank_filter->window_size = window_size;
 	rank_filter->rank = rank;
+	rank_filter->ranks = NULL;
+	rank_filter->ranks_num = 0;
 	rank_filter->initialized = 0;
-
-    rank_filter->sorted_window = _malloc((sizeof rank_filter->sorted_window) * rank_filter->window_size);
+	rank_filter->warmup = 0;
+	rank_filter->growing = 0;
+	rank_filter->decimation = 1;
+	rank_filter->batch_len = 0;
+	rank_filter->batch = NULL;
+
+	rank_filter->backend = RankFilterLinearScan;
+#ifdef FILTER_AUTOTUNE_ENABLE
+	filter_autotune_lookup_rank(window_size, rank, &rank_filter->backend);
+#endif
+
+    rank_filter->sorted_window = _malloc((sizeof rank_filter->sorted_window) * buffer_size);
     if(rank_filter->sorted_window == NULL)
     {
         return FilterError;
     }
 
-    FIFO_init(&rank_filter->fifo, (uint8_t*)buffer, window_size, sizeof(*buffer), FIFO_NO_FLAGS);
+    FIFO_init(&rank_filter->fifo, (uint8_t*)buffer, buffer_size, sizeof(*buffer), FIFO_NO_FLAGS);
 
 	return FilterOK;
 }
@@ -95,7 +236,7 @@ FilterStatus_t rank_filter_fill_buffer(RankFilter_t *rf, int16_t *samples, int16
     FIFO_t *fifo_ptr = &rf->fifo;
     uint16_t window_size = rf->window_size;
 
-    if(FIFO_write(fifo_ptr, samples, window_size, NULL) != FIFO_OK)
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, samples, window_size, NULL)) != FIFO_OK)
     {
         return FilterError;
     }
@@ -121,239 +262,1651 @@ FilterStatus_t rank_filter_filter_sample(RankFilter_t *rank_filter, int16_t new_
 {
 	if(!rank_filter->initialized)
 	{
-		return FilterError;
+		return (rank_filter->warmup || rank_filter->growing) ?
+				rank_filter_warmup_sample(rank_filter, new_sample, y) : FilterError;
 	}
 
-	return rank_filter_compute_next_sample(rank_filter, new_sample, y);
+	FilterStatus_t status;
+	FILTER_STATS_ENTER(t0);
+
+	status = rank_filter_compute_next_sample(rank_filter, new_sample, y);
+
+	FILTER_STATS_LEAVE(FilterStatsRankSample, t0, 1);
+	return status;
 }
 
 
 /**
- * @brief 	    Performs rank filtering on a simple buffer.
- * @note	    NOT an optimal implementation. Time complexity is O(n * window_size * log(window_size))
+ * @brief 	Performs initialization of rank filter computing several ranks of the same window.
+ * @note	Memory and update time are the same as for a single rank filter.
  *
- * @param[in]   data        -   data to be filtered
- * @param[in]   data_size   -   data length
- * @param[in]   window_size -   rank filter window size
- * @param[in]   rank        -   rank filter rank
- * @param[out]  y           -   pointer where output data will be stored
- * @param[out]  y_len       -   output data length. You can predict it using rank_filter_get_output_data_len.
+ * @param	rank_filter	-	rank filter handle
+ * @param 	buffer		-	buffer with incoming data. Length of buffer must match window size.
+ * @param	window_size	-	filter window size
+ * @param	ranks		-	list of ranks. Must stay valid while filter is used.
+ * @param	ranks_num	-	number of ranks
  *
- * @return      FilterStatus_t
+ * @return	Filter status
  */
-FilterStatus_t rank_filter_filter_sequence(int16_t *data, int16_t data_size, uint16_t window_size,
-        uint16_t rank, int16_t *y, uint16_t *y_len)
+FilterStatus_t rank_filter_multi_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size,
+        const uint16_t *ranks, uint16_t ranks_num)
 {
-    if(rank > window_size)
+    if(ranks_num == 0)
     {
         return FilterError;
     }
 
-	uint32_t item_size = sizeof *data;
-
-	int16_t 	window[window_size];
-	uint16_t	filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+    for(uint16_t i=0; i<ranks_num; i++)
+    {
+        if(ranks[i] > window_size - 1)
+        {
+            return FilterError;
+        }
+    }
 
-	for(uint16_t i=0; i<filtered_len; i++)
-	{
-		memcpy(window, data+i, window_size*item_size);
+    if(rank_filter_init(rank_filter, buffer, window_size, ranks[0]) != FilterOK)
+    {
+        return FilterError;
+    }
 
-		qsort(window, window_size, 2, sort_cmp_func);
-		y[i] = window[rank];
-	}
+    rank_filter->ranks = ranks;
+    rank_filter->ranks_num = ranks_num;
 
-	*y_len = filtered_len;
-	return FilterOK;
+    return FilterOK;
 }
 
 
 /**
- * @brief       Returns expected filtered sequence length.
+ * @brief       Fill multi rank filter buffer for the first time
  *
- * @param[in]   data_size   -   data size
- * @param[in]   window_size -   filter window size
- * @param[out]  y_len   -   pointer to where expected length will be written.
+ * @param[in]   rf  -   pointer to rank filter handle
+ * @param[in]   samples -   samples to be written. Length must match filter window size
+ * @param[out]  y   -   pointer where ranks_num samples will be stored.
  *
  * @return      Filter error status
  */
-FilterStatus_t rank_filter_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len)
+FilterStatus_t rank_filter_multi_fill_buffer(RankFilter_t *rf, int16_t *samples, int16_t *y)
 {
-    if(window_size > data_size)
+    if(rf->ranks == NULL || rank_filter_fill_buffer(rf, samples, NULL) != FilterOK)
     {
         return FilterError;
     }
 
-    *y_len = filter_windowed_get_expected_output_len(data_size, window_size);
+    rank_filter_multi_output(rf, y);
     return FilterOK;
 }
 
 
 /**
- *  @brief      Reset filter to unintialized state. You have to call rank_filter_fill_buffer again in order to use\
- *              rank_filter_sample.
+ * @brief	    Computes the next filtered sample for every rank.
+ * @note	    Time complexity is O(window_size + ranks_num).
  *
- *  @param[in]  rank_filter     -   pointer to rank filter
+ * @param[in]	rank_filter	- rank filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	-	pointer where ranks_num samples will be stored.
+ *
+ * @return	    Filter error status
  */
-void rank_filter_flush(RankFilter_t *rank_filter)
+FilterStatus_t rank_filter_multi_filter_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *y)
 {
-    FIFO_t *fifo_ptr = &rank_filter->fifo;
+    if(rank_filter->ranks == NULL || rank_filter_filter_sample(rank_filter, new_sample, NULL) != FilterOK)
+    {
+        return FilterError;
+    }
 
-    FIFO_flush(fifo_ptr);
-    rank_filter->initialized = 0;
+    rank_filter_multi_output(rank_filter, y);
+    return FilterOK;
 }
 
 
-
-/*********************************************************************************/
-/*****							PRIVATE API									*****/
-
 /**
- * @brief 	Comparasion function for qsort
+ * @brief       Filters block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with rank_filter_fill_buffer. While the first window is not
+ *                  collected input samples produce no output unless warm-up mode is enabled.
+ *
+ * @param[in]   rank_filter -   rank filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
  */
-static int sort_cmp_func(const void *pdata1, const void *pdata2)
+FilterStatus_t rank_filter_filter_block(RankFilter_t *rank_filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len)
 {
-	return (*(int16_t*)pdata1 - *(int16_t*)pdata2);
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+    uint16_t produced = 0;
+    uint16_t i = 0;
+
+    FILTER_STATS_ENTER(t0);
+
+    /* Collect the first window */
+    while(i < data_len && !rank_filter->initialized)
+    {
+        if(rank_filter->warmup || rank_filter->growing)
+        {
+            if(rank_filter_warmup_sample(rank_filter, data[i++], &y[produced++]) != FilterOK)
+            {
+                return FilterError;
+            }
+
+            continue;
+        }
+
+        if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &data[i++], 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        if(FIFO_get_data_count(fifo_ptr) == rank_filter->window_size)
+        {
+            rank_filter->initialized = 1;
+
+            if(rank_filter_compute_first_output(rank_filter, &y[produced++]) != FilterOK)
+            {
+                return FilterError;
+            }
+        }
+    }
+
+    for(; i<data_len; i++)
+    {
+        if(rank_filter_compute_next_sample(rank_filter, data[i], &y[produced++]) != FilterOK)
+        {
+            return FilterError;
+        }
+    }
+
+    *y_len = produced;
+
+    FILTER_STATS_LEAVE(FilterStatsRankSample, t0, produced);
+    return FilterOK;
 }
 
 
 /**
- * @brief	    Computes the first output of rank filter.
- * @note	    Time complexity is O(window_size*log(window_size)) since requires sorting.
+ * @brief 	Performs initialization of rank filter producing every decimation-th output.
  *
- * @param[in]	filter	-	rank filter handle
- * @param[out]  y   -   pointer to where filtered sample will be written
+ * @param	rank_filter	-	rank filter handle
+ * @param 	buffer		-	buffer with incoming data. Length of buffer must match window size.
+ * @param	window_size	-	filter window size
+ * @param	rank		-	filter rank
+ * @param	decimation	-	number of input samples per output, 1..window_size
  *
- * @return 	    Filtered error status
+ * @return	Filter status
  */
-static inline FilterStatus_t rank_filter_compute_first_output(RankFilter_t *filter, int16_t *y)
+FilterStatus_t rank_filter_decimated_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size,
+        uint16_t rank, uint16_t decimation)
 {
-	int16_t *sorted_window = filter->sorted_window;
-	uint8_t item_size = sizeof *filter->sorted_window;
-	uint16_t window_size = filter->window_size;
-	uint16_t rank = filter->rank;
-
-	FIFO_t *fifo_ptr = &filter->fifo;
-	int16_t samples[window_size];
-
-	/**
-	 * Read samples
-	 */
-	if(FIFO_read(fifo_ptr, samples, window_size, NULL) != FIFO_OK)
-	{
-	    return FilterError;
-	}
+    if(decimation == 0 || decimation > window_size)
+    {
+        return FilterError;
+    }
 
-	/**
-	 * Write them back
-	 */
-	if(FIFO_write(fifo_ptr, samples, window_size, NULL) != FIFO_OK)
-	{
-	    return FilterError;
-	}
+    if(rank_filter_init(rank_filter, buffer, window_size, rank) != FilterOK)
+    {
+        return FilterError;
+    }
 
-	/**
-	 * Sort window
-	 */
-	memcpy(sorted_window, samples, window_size*item_size);
-	qsort(sorted_window, window_size, item_size, sort_cmp_func);
+    /* New samples, expired samples and merged window */
+    rank_filter->batch = _malloc((2 * decimation + window_size) * sizeof *rank_filter->batch);
+    if(rank_filter->batch == NULL)
+    {
+        rank_filter_deinit(rank_filter);
+        return FilterError;
+    }
 
-	/**
-	 * Output
-	 */
-	if(y != NULL)
-	{
-	    *y = sorted_window[rank];
-	}
+    rank_filter->decimation = decimation;
 
-	return FilterOK;
+    return FilterOK;
 }
 
 
 /**
- * @brief 	Computes next filtered sample from a ring buffer.
- * @note	Time complexity is O(window_size).
+ * @brief	    Adds new sample to decimated filter and computes output every decimation samples.
+ * @note	    Time complexity is O(window_size / decimation + log(decimation)) per sample.
  *
- * @param[in]	filter	-	rank filter handle
- * @param[in]   new_sample  -   new raw sample
- * @param[out]  y   -   pointer to where filtered sample will be written
+ * @param[in]	rank_filter	-   rank filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	        -	pointer to where filtered sample will be written. Written only if ready.
+ * @param[out]	ready	    -	set to 1 when output is produced.
  *
  * @return	    Filter error status
  */
-static inline FilterStatus_t rank_filter_compute_next_sample(RankFilter_t *filter, int16_t new_sample, int16_t *y)
+FilterStatus_t rank_filter_decimated_filter_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *y,
+        uint8_t *ready)
 {
-	int16_t *sorted_window = filter->sorted_window;
-	uint16_t rank = filter->rank;
-	uint16_t window_size = filter->window_size;
-	uint16_t item_size = sizeof(new_sample);
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+    const uint16_t decimation = rank_filter->decimation;
 
-	FIFO_t *fifo_ptr = &filter->fifo;
-	int16_t last_sample;
+    *ready = 0;
 
-	if(FIFO_read(fifo_ptr, &last_sample, 1, NULL) != FIFO_OK)
-	{
-	    return FilterError;
-	}
+    if(rank_filter->batch == NULL)
+    {
+        return FilterError;
+    }
 
-	if(FIFO_write(fifo_ptr, &new_sample, 1, NULL) != FIFO_OK)
-	{
-	    return FilterError;
-	}
+    if(!rank_filter->initialized)
+    {
+        if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
 
-	int32_t last_sample_rank = -1;
-	int32_t new_sample_rank = -1;
-	int32_t new_sample_rank_shift = 1;
+        if(FIFO_get_data_count(fifo_ptr) == rank_filter->window_size)
+        {
+            rank_filter->initialized = 1;
+            *ready = 1;
 
-	/* Determine last and new sample ranks */
-	for(uint32_t i=0; i<window_size; i++)
-	{
-		if(sorted_window[i] == last_sample && last_sample_rank == -1)
-		{
-			last_sample_rank = i;
-		}
+            return rank_filter_compute_first_output(rank_filter, y);
+        }
 
-		if(sorted_window[i] >= new_sample && new_sample_rank == -1)
-		{
-			new_sample_rank = i;
-		}
+        return FilterOK;
+    }
 
-		if(last_sample_rank != -1 && new_sample_rank != -1)
-		{
-			break;
-		}
-	}
+    int16_t *new_samples = rank_filter->batch;
+    int16_t *last_samples = &rank_filter->batch[decimation];
 
-	if(new_sample_rank == -1)
-	{
-		new_sample_rank = window_size - 1;
-		new_sample_rank_shift = 0;
-	}
+    if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_samples[rank_filter->batch_len], 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
 
-	/* We remove last sample and insert new sample at its' position */
-	uint32_t bytes_to_move;
-	if(last_sample_rank < new_sample_rank)
-	{
-		bytes_to_move = (new_sample_rank - last_sample_rank)*item_size;
-		memmove(sorted_window+last_sample_rank, sorted_window+last_sample_rank+1, bytes_to_move);
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
 
-		sorted_window[new_sample_rank - new_sample_rank_shift] = new_sample;
+    new_samples[rank_filter->batch_len++] = new_sample;
 
-	}
-	else if(last_sample_rank > new_sample_rank)
-	{
-		bytes_to_move = (last_sample_rank - new_sample_rank)*item_size;
-		memmove(sorted_window+new_sample_rank+1, sorted_window+new_sample_rank, bytes_to_move);
+    if(rank_filter->batch_len == decimation)
+    {
+        FILTER_STATS_ENTER(t0);
 
-		sorted_window[new_sample_rank] = new_sample;
-	}
-	else // equal
-	{
-		sorted_window[last_sample_rank] = new_sample;
-	}
+        rank_filter_window_batch_replace(rank_filter->sorted_window, rank_filter->window_size, last_samples,
+                new_samples, decimation, &rank_filter->batch[2 * decimation]);
 
-	if(y != NULL)
-	{
-	    *y = sorted_window[rank];
-	}
+        rank_filter->batch_len = 0;
+        *y = rank_filter->sorted_window[rank_filter->rank];
+        *ready = 1;
 
-	return FilterOK;
+        FILTER_STATS_LEAVE(FilterStatsRankSample, t0, decimation);
+    }
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples with decimated filter keeping filter state between calls.
+ *
+ * @param[in]   rank_filter -   rank filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len / decimation + 1 samples.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_decimated_filter_block(RankFilter_t *rank_filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len)
+{
+    uint16_t produced = 0;
+    uint8_t ready;
+
+    for(uint16_t i=0; i<data_len; i++)
+    {
+        if(rank_filter_decimated_filter_sample(rank_filter, data[i], &y[produced], &ready) != FilterOK)
+        {
+            return FilterError;
+        }
+
+        produced += ready;
+    }
+
+    *y_len = produced;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief 	    Performs rank filtering on a simple buffer.
+ * @note	    NOT an optimal implementation. Time complexity is O(n * window_size * log(window_size))
+ *
+ * @param[in]   data        -   data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   rank filter window size
+ * @param[in]   rank        -   rank filter rank
+ * @param[out]  y           -   pointer where output data will be stored
+ * @param[out]  y_len       -   output data length. You can predict it using rank_filter_get_output_data_len.
+ *
+ * @return      FilterStatus_t
+ */
+FilterStatus_t rank_filter_filter_sequence(int16_t *data, int16_t data_size, uint16_t window_size,
+        uint16_t rank, int16_t *y, uint16_t *y_len)
+{
+    if(rank > window_size)
+    {
+        return FilterError;
+    }
+
+	FILTER_STATS_ENTER(t0);
+
+	uint32_t item_size = sizeof *data;
+
+	int16_t 	window[window_size];
+	uint16_t	filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+
+	const SortNetwork_t *network = sort_network_get(window_size);
+
+	if(network != NULL && rank < window_size)
+	{
+		rank_filter_sequence_network(network, data, filtered_len, rank, y);
+	}
+	else
+	{
+		for(uint16_t i=0; i<filtered_len; i++)
+		{
+			memcpy(window, data+i, window_size*item_size);
+
+			qsort(window, window_size, 2, filter_sort_cmp);
+			y[i] = window[rank];
+		}
+	}
+
+	*y_len = filtered_len;
+
+	FILTER_STATS_LEAVE(FilterStatsRankSequence, t0, filtered_len);
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Performs rank filtering producing output of the same length as input.
+ * @note        Samples outside of data are produced according to edge padding policy.
+ *                  Sorted window is sorted once and then updated with each new sample in O(window_size).
+ *                  Windows which cross data edges are handled by separate loops, interior loop has no checks.
+ *
+ * @param[in]   data        -   data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   rank filter window size
+ * @param[in]   rank        -   rank filter rank
+ * @param[in]   edge        -   padding and alignment configuration
+ * @param[out]  y           -   pointer where output data will be stored. Must hold data_size samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_filter_sequence_padded(int16_t *data, uint16_t data_size, uint16_t window_size,
+        uint16_t rank, const FilterEdgeConfig_t *edge, int16_t *y)
+{
+    if(data_size == 0 || rank >= window_size)
+    {
+        return FilterError;
+    }
+
+    FILTER_STATS_ENTER(t0);
+
+    int32_t n = data_size;
+    int32_t w = window_size;
+    int32_t left = filter_edge_get_left_len(window_size, edge->alignment);
+    int16_t sorted_window[window_size];
+    int32_t i;
+
+    /* Window of the first output item */
+    for(int32_t k=0; k<w; k++)
+    {
+        sorted_window[k] = filter_edge_get_sample(data, n, k-left, edge);
+    }
+
+    qsort(sorted_window, window_size, sizeof *sorted_window, filter_sort_cmp);
+    y[0] = sorted_window[rank];
+
+    /**
+     * Output item i drops sample i-left-1 and takes sample i-left+w-1.
+     * Both of them are inside data for i in [interior_start, interior_end).
+     */
+    int32_t interior_start = left + 1;
+    int32_t interior_end = n - w + left + 1;
+
+    if(interior_end > n)
+    {
+        interior_end = n;
+    }
+
+    for(i=1; i<interior_start && i<n; i++)
+    {
+        rank_filter_window_replace(sorted_window, window_size, filter_edge_get_sample(data, n, i-left-1, edge),
+                filter_edge_get_sample(data, n, i-left+w-1, edge), NULL, NULL);
+        y[i] = sorted_window[rank];
+    }
+
+    for(; i<interior_end; i++)
+    {
+        rank_filter_window_replace(sorted_window, window_size, data[i-left-1], data[i-left+w-1], NULL, NULL);
+        y[i] = sorted_window[rank];
+    }
+
+    for(; i<n; i++)
+    {
+        rank_filter_window_replace(sorted_window, window_size, filter_edge_get_sample(data, n, i-left-1, edge),
+                filter_edge_get_sample(data, n, i-left+w-1, edge), NULL, NULL);
+        y[i] = sorted_window[rank];
+    }
+
+    FILTER_STATS_LEAVE(FilterStatsRankSequence, t0, n);
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Returns expected filtered sequence length.
+ *
+ * @param[in]   data_size   -   data size
+ * @param[in]   window_size -   filter window size
+ * @param[out]  y_len   -   pointer to where expected length will be written.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len)
+{
+    if(window_size > data_size)
+    {
+        return FilterError;
+    }
+
+    *y_len = filter_windowed_get_expected_output_len(data_size, window_size);
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Rank filters 2D frame.
+ * @note        Output is the valid region, see filter_2d_get_output_size.
+ *
+ * @param[in]   frame           -   row-major frame
+ * @param[in]   width           -   frame width
+ * @param[in]   height          -   frame height
+ * @param[in]   kernel_width    -   kernel width
+ * @param[in]   kernel_height   -   kernel height
+ * @param[in]   rank            -   rank of output sample in sorted kernel. Must be less than kernel area.
+ * @param[out]  y               -   row-major output frame
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_filter_2d(const int16_t *frame, uint16_t width, uint16_t height,
+        uint16_t kernel_width, uint16_t kernel_height, uint32_t rank, int16_t *y)
+{
+    RankFilter2d_t config;
+    uint16_t y_width, y_height;
+
+    if(filter_2d_get_output_size(width, height, kernel_width, kernel_height, &y_width, &y_height) != FilterOK
+            || rank >= (uint32_t)kernel_width * kernel_height)
+    {
+        return FilterError;
+    }
+
+    int16_t min = frame[0], max = frame[0];
+
+    for(uint32_t i=1; i<(uint32_t)width * height; i++)
+    {
+        min = (frame[i] < min) ? frame[i] : min;
+        max = (frame[i] > max) ? frame[i] : max;
+    }
+
+    uint32_t range = (int32_t)max - min;
+    uint8_t bits = 0;
+
+    while(bits < 16 && (1u << bits) <= range)
+    {
+        bits++;
+    }
+
+    config.frame = frame;
+    config.y = y;
+    config.width = width;
+    config.y_width = y_width;
+    config.kernel_width = kernel_width;
+    config.kernel_height = kernel_height;
+    config.rank = rank;
+    config.offset = min;
+    config.fine_bits = bits / 2;
+    config.coarse_bins = 1u << (bits - config.fine_bits);
+
+    uint32_t column_bytes = (config.coarse_bins + (config.coarse_bins << config.fine_bits)) * sizeof(uint16_t);
+    uint32_t columns = RANK_FILTER_2D_HIST_BUDGET / column_bytes;
+
+    /* Strip must give at least kernel_width outputs to pay for histograms */
+    config.columns = (columns > width) ? width : columns;
+    if(config.columns < width && config.columns < 2*kernel_width - 1)
+    {
+        config.columns = 0;
+    }
+
+    int32_t bands_num = (y_height + FILTER_2D_BAND_ROWS - 1) / FILTER_2D_BAND_ROWS;
+    uint8_t band_status[bands_num];
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int32_t band=0; band<bands_num; band++)
+    {
+        RankFilter2d_t band_config = config;
+        uint32_t row_begin = band * FILTER_2D_BAND_ROWS;
+        uint32_t row_end = row_begin + FILTER_2D_BAND_ROWS;
+
+        if(row_end > y_height)
+        {
+            row_end = y_height;
+        }
+
+        if(band_config.columns == 0)
+        {
+            band_status[band] = rank_filter_2d_band_direct(&band_config, row_begin, row_end);
+        }
+        else
+        {
+            band_status[band] = rank_filter_2d_band(&band_config, row_begin, row_end);
+        }
+    }
+
+    for(int32_t band=0; band<bands_num; band++)
+    {
+        if(band_status[band] != FilterOK)
+        {
+            return FilterError;
+        }
+    }
+
+    return FilterOK;
+}
+
+
+/**
+ *  @brief      Reset filter to unintialized state. You have to call rank_filter_fill_buffer again in order to use\
+ *              rank_filter_sample.
+ *
+ *  @param[in]  rank_filter     -   pointer to rank filter
+ */
+void rank_filter_flush(RankFilter_t *rank_filter)
+{
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+
+    FIFO_flush(fifo_ptr);
+    rank_filter->initialized = 0;
+    rank_filter->growing = 0;
+    rank_filter->batch_len = 0;
+}
+
+
+/**
+ *  @brief      Releases memory allocated by rank_filter_init(...) and rank_filter_decimated_init(...).
+ *
+ *  @param[in]  rank_filter     -   pointer to rank filter
+ */
+void rank_filter_deinit(RankFilter_t *rank_filter)
+{
+    _free(rank_filter->sorted_window);
+    _free(rank_filter->batch);
+
+    rank_filter->sorted_window = NULL;
+    rank_filter->batch = NULL;
+}
+
+
+/**
+ * @brief       Changes window size keeping collected samples.
+ * @note        Shrinking removes the oldest samples from the sorted window one by one, so the cost is
+ *                  proportional to the size change. After growing the filter keeps producing outputs
+ *                  of proportional rank over collected samples until the new window is full.
+ * @note        Filter rank (and all ranks of multi rank filter) must fit into the new window.
+ *
+ * @param[in]   rank_filter -   pointer to rank filter
+ * @param[in]   window_size -   new window size. Must not exceed buffer size given at init.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_resize(RankFilter_t *rank_filter, uint16_t window_size)
+{
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+    uint16_t count = FIFO_get_data_count(fifo_ptr);
+    int16_t last_sample;
+
+    if(window_size == 0 || window_size > rank_filter->buffer_size || rank_filter->rank > window_size - 1
+            || rank_filter->batch != NULL)
+    {
+        return FilterError;
+    }
+
+    for(uint16_t i=0; i<rank_filter->ranks_num; i++)
+    {
+        if(rank_filter->ranks[i] > window_size - 1)
+        {
+            return FilterError;
+        }
+    }
+
+    /* Drop the oldest samples which do not fit into the new window */
+    for(; count > window_size; count--)
+    {
+        if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_sample, 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        if(rank_filter->initialized)
+        {
+            rank_filter_window_remove(rank_filter->sorted_window, count, last_sample);
+        }
+    }
+
+    if(rank_filter->initialized && window_size > rank_filter->window_size)
+    {
+        rank_filter->initialized = 0;
+        rank_filter->growing = 1;
+    }
+    else if(!rank_filter->initialized && count == window_size)
+    {
+        /* Sorted window is not tracked while collecting the first window */
+        rank_filter->window_size = window_size;
+        rank_filter->initialized = 1;
+        rank_filter->growing = 0;
+
+        if(rank_filter_compute_first_output(rank_filter, NULL) != FilterOK)
+        {
+            return FilterError;
+        }
+    }
+
+    rank_filter->window_size = window_size;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Changes filter rank. Takes effect from the next output sample.
+ *
+ * @param[in]   rank_filter -   pointer to rank filter
+ * @param[in]   rank        -   new rank. Must be less than window size.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_set_rank(RankFilter_t *rank_filter, uint16_t rank)
+{
+    if(rank > rank_filter->window_size - 1)
+    {
+        return FilterError;
+    }
+
+    rank_filter->rank = rank;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Replaces the oldest sample of initialized filter with the new one without producing output.
+ * @note        Intended for filters built on top of rank filter order statistics. Positions let them
+ *                  update their own state incrementally.
+ *
+ * @param[in]   rank_filter     -   pointer to rank filter
+ * @param[in]   new_sample      -   new sample to be written
+ * @param[out]  last_sample     -   removed sample
+ * @param[out]  removed_pos     -   position of removed sample in sorted window before update
+ * @param[out]  inserted_pos    -   position of new sample in sorted window after update
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_replace_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *last_sample,
+        uint16_t *removed_pos, uint16_t *inserted_pos)
+{
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+
+    if(!rank_filter->initialized)
+    {
+        return FilterError;
+    }
+
+    if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, last_sample, 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    rank_filter_window_replace(rank_filter->sorted_window, rank_filter->window_size, *last_sample, new_sample,
+            removed_pos, inserted_pos);
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Removes sample from sorted array and inserts new one keeping array sorted.
+ * @note        Same update as used by rank filter. Lets sequence filters keep their own sorted window.
+ *
+ * @param[in,out]   sorted_window   -   sorted samples
+ * @param[in]       window_size     -   number of samples
+ * @param[in]       last_sample     -   sample to be removed. Must be present in the window.
+ * @param[in]       new_sample      -   sample to be inserted
+ * @param[out]      removed_pos     -   position of removed sample before update. Can be NULL.
+ * @param[out]      inserted_pos    -   position of inserted sample after update. Can be NULL.
+ */
+void rank_filter_window_update(int16_t *sorted_window, uint16_t window_size, int16_t last_sample,
+        int16_t new_sample, uint16_t *removed_pos, uint16_t *inserted_pos)
+{
+    rank_filter_window_replace(sorted_window, window_size, last_sample, new_sample, removed_pos, inserted_pos);
+}
+
+
+
+/**
+ * @brief       Selects sorted window update implementation. See RankFilterBackend_t.
+ * @note        Can be changed at any time, output does not depend on it.
+ *
+ * @param[in]   rank_filter -   pointer to rank filter
+ * @param[in]   backend     -   sorted window update implementation
+ */
+void rank_filter_set_backend(RankFilter_t *rank_filter, RankFilterBackend_t backend)
+{
+    rank_filter->backend = backend;
+}
+
+
+/**
+ * @brief       Enables or disables warm-up mode.
+ * @note        In warm-up mode rank_filter_filter_sample works before the first window is collected.
+ *
+ * @param[in]   rank_filter -   pointer to rank filter
+ * @param[in]   enable      -   0 to disable warm-up, otherwise enable
+ */
+void rank_filter_set_warmup(RankFilter_t *rank_filter, uint8_t enable)
+{
+    rank_filter->warmup = (enable != 0);
+}
+
+
+/**
+ * @brief       Returns checkpoint size of filter state.
+ */
+uint32_t rank_filter_get_state_size(RankFilter_t *rank_filter)
+{
+    return sizeof(FilterStateHeader_t) + sizeof(RankFilterState_t)
+            + (FIFO_get_data_count(&rank_filter->fifo) + rank_filter->window_size) * sizeof(int16_t);
+}
+
+
+/**
+ * @brief       Saves filter state into versioned checkpoint.
+ *
+ * @param[in]   rank_filter -   rank filter handle
+ * @param[out]  buf         -   checkpoint buffer
+ * @param[in]   buf_size    -   checkpoint buffer length. Use rank_filter_get_state_size to get required length.
+ * @param[out]  state_size  -   written checkpoint length. Can be NULL.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rank_filter_save_state(RankFilter_t *rank_filter, uint8_t *buf, uint32_t buf_size,
+        uint32_t *state_size)
+{
+    FIFO_t *fifo_ptr = &rank_filter->fifo;
+    uint16_t items_num = FIFO_get_data_count(fifo_ptr);
+    uint16_t window_size = rank_filter->window_size;
+    uint32_t size = rank_filter_get_state_size(rank_filter);
+
+    if(buf_size < size || rank_filter->batch != NULL)
+    {
+        return FilterError;
+    }
+
+    RankFilterState_t state;
+
+    state.rank = rank_filter->rank;
+    state.initialized = rank_filter->initialized;
+    state.growing = rank_filter->growing;
+
+    filter_state_write_header(buf, FilterStateRank, window_size, items_num, size);
+    buf += sizeof(FilterStateHeader_t);
+
+    memcpy(buf, &state, sizeof state);
+    buf += sizeof state;
+
+    FIFO_peek(fifo_ptr, buf, 0, items_num);
+    buf += items_num * sizeof(int16_t);
+
+    memcpy(buf, rank_filter->sorted_window, window_size * sizeof(int16_t));
+
+    if(state_size != NULL)
+    {
+        *state_size = size;
+    }
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Restores filter state from checkpoint.
+ * @note        Filter must be initialized with rank_filter_init or rank_filter_multi_init with the same window size.
+ *
+ * @param[in]   rank_filter -   rank filter handle
+ * @param[in]   buf         -   checkpoint made with rank_filter_save_state
+ * @param[in]   buf_size    -   checkpoint length
+ *
+ * @return      FilterError if checkpoint is corrupted or does not match filter.
+ */
+FilterStatus_t rank_filter_restore_state(RankFilter_t *rank_filter, const uint8_t *buf, uint32_t buf_size)
+{
+    FilterStateHeader_t header;
+    RankFilterState_t state;
+    uint16_t window_size = rank_filter->window_size;
+
+    if(filter_state_read_header(buf, buf_size, FilterStateRank, window_size, &header) != FilterOK)
+    {
+        return FilterError;
+    }
+
+    if(header.size != sizeof header + sizeof state + (header.items_num + window_size) * sizeof(int16_t))
+    {
+        return FilterError;
+    }
+
+    buf += sizeof header;
+    memcpy(&state, buf, sizeof state);
+    buf += sizeof state;
+
+    if(state.rank > window_size - 1)
+    {
+        return FilterError;
+    }
+
+    rank_filter->rank = state.rank;
+    rank_filter->initialized = state.initialized;
+    rank_filter->growing = state.growing;
+
+    FIFO_load(&rank_filter->fifo, buf, header.items_num);
+    buf += header.items_num * sizeof(int16_t);
+
+    memcpy(rank_filter->sorted_window, buf, window_size * sizeof(int16_t));
+
+    return FilterOK;
+}
+
+
+
+/*********************************************************************************/
+/*****							PRIVATE API									*****/
+
+/**
+ * @brief	    Computes the first output of rank filter.
+ * @note	    Time complexity is O(window_size*log(window_size)) since requires sorting.
+ *
+ * @param[in]	filter	-	rank filter handle
+ * @param[out]  y   -   pointer to where filtered sample will be written
+ *
+ * @return 	    Filtered error status
+ */
+static inline FilterStatus_t rank_filter_compute_first_output(RankFilter_t *filter, int16_t *y)
+{
+	int16_t *sorted_window = filter->sorted_window;
+	uint8_t item_size = sizeof *filter->sorted_window;
+	uint16_t window_size = filter->window_size;
+	uint16_t rank = filter->rank;
+
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t samples[window_size];
+
+	/**
+	 * Read samples
+	 */
+	if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, samples, window_size, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	/**
+	 * Write them back
+	 */
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, samples, window_size, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	/**
+	 * Sort window
+	 */
+	memcpy(sorted_window, samples, window_size*item_size);
+	qsort(sorted_window, window_size, item_size, filter_sort_cmp);
+
+	/**
+	 * Output
+	 */
+	if(y != NULL)
+	{
+	    *y = sorted_window[rank];
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief 	Computes next filtered sample from a ring buffer.
+ * @note	Time complexity is O(window_size).
+ *
+ * @param[in]	filter	-	rank filter handle
+ * @param[in]   new_sample  -   new raw sample
+ * @param[out]  y   -   pointer to where filtered sample will be written
+ *
+ * @return	    Filter error status
+ */
+static inline FilterStatus_t rank_filter_compute_next_sample(RankFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	int16_t *sorted_window = filter->sorted_window;
+	uint16_t rank = filter->rank;
+	uint16_t window_size = filter->window_size;
+
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t last_sample;
+
+	if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_sample, 1, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	if(filter->backend == RankFilterBinarySearch)
+	{
+		rank_filter_window_replace_bsearch(sorted_window, window_size, last_sample, new_sample);
+	}
+	else
+	{
+		rank_filter_window_replace(sorted_window, window_size, last_sample, new_sample, NULL, NULL);
+	}
+
+	if(y != NULL)
+	{
+	    *y = sorted_window[rank];
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Writes sample of every rank of multi rank filter.
+ */
+static inline void rank_filter_multi_output(RankFilter_t *filter, int16_t *y)
+{
+	const int16_t *sorted_window = filter->sorted_window;
+	const uint16_t *ranks = filter->ranks;
+
+	for(uint16_t i=0; i<filter->ranks_num; i++)
+	{
+		y[i] = sorted_window[rank_filter_current_rank(filter, ranks[i])];
+	}
+}
+
+
+/**
+ * @brief	Removes sample from sorted window. Binary search is used to find sample position.
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	number of samples in sorted window before removal
+ * @param	sample			-	sample to remove. Must be present in window.
+ */
+static inline void rank_filter_window_remove(int16_t *sorted_window, uint16_t window_size, int16_t sample)
+{
+	uint16_t low = 0;
+	uint16_t high = window_size - 1;
+
+	while(low < high)
+	{
+		uint16_t mid = (low + high) / 2;
+
+		if(sorted_window[mid] < sample)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	memmove(sorted_window+low, sorted_window+low+1, (window_size - low - 1)*sizeof *sorted_window);
+}
+
+
+/**
+ * @brief	Replaces batch of expired samples in sorted window with batch of new samples in one pass.
+ * @note	Time complexity is O(window_size + batch_len * log(batch_len)).
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	window length
+ * @param	last_samples	-	samples to be removed. Must be present in the window. Sorted in place.
+ * @param	new_samples		-	samples to be inserted. Sorted in place.
+ * @param	batch_len		-	number of removed and inserted samples
+ * @param	merged			-	scratch buffer of window_size samples
+ */
+static void rank_filter_window_batch_replace(int16_t *sorted_window, uint16_t window_size, int16_t *last_samples,
+		int16_t *new_samples, uint16_t batch_len, int16_t *merged)
+{
+	qsort(last_samples, batch_len, sizeof *last_samples, filter_sort_cmp);
+	qsort(new_samples, batch_len, sizeof *new_samples, filter_sort_cmp);
+
+	rank_filter_window_merge(sorted_window, window_size, last_samples, new_samples, batch_len, merged);
+	memcpy(sorted_window, merged, window_size * sizeof *sorted_window);
+
+	FILTER_STATS_RANK_SCAN(window_size, window_size * sizeof *sorted_window);
+}
+
+
+/**
+ * @brief	Merges sorted new samples into sorted window skipping sorted expired samples in one pass.
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	window length
+ * @param	last_samples	-	sorted samples to be removed. Must be present in the window.
+ * @param	new_samples		-	sorted samples to be inserted
+ * @param	batch_len		-	number of removed and inserted samples
+ * @param	merged			-	updated window of window_size samples
+ */
+static void rank_filter_window_merge(const int16_t *sorted_window, uint32_t window_size, const int16_t *last_samples,
+		const int16_t *new_samples, uint32_t batch_len, int16_t *merged)
+{
+	uint32_t last_pos = 0;
+	uint32_t new_pos = 0;
+	uint32_t merged_len = 0;
+
+	for(uint32_t i=0; i<window_size; i++)
+	{
+		int16_t sample = sorted_window[i];
+
+		/* Expired samples are a sorted subset of window, so the next one is never below current sample */
+		if(last_pos < batch_len && last_samples[last_pos] == sample)
+		{
+			last_pos++;
+			continue;
+		}
+
+		while(new_pos < batch_len && new_samples[new_pos] <= sample)
+		{
+			merged[merged_len++] = new_samples[new_pos++];
+		}
+
+		merged[merged_len++] = sample;
+	}
+
+	while(new_pos < batch_len)
+	{
+		merged[merged_len++] = new_samples[new_pos++];
+	}
+}
+
+
+/**
+ * @brief	Returns rank scaled to the number of collected samples while window is not full.
+ */
+static inline uint16_t rank_filter_current_rank(RankFilter_t *filter, uint16_t rank)
+{
+	if(filter->initialized || filter->window_size == 1)
+	{
+		return rank;
+	}
+
+	uint32_t count = FIFO_get_data_count(&filter->fifo);
+	return (uint32_t)rank * (count - 1) / (filter->window_size - 1);
+}
+
+
+/**
+ * @brief	Inserts sample into not yet full sorted window and outputs sample of proportional rank.
+ * 				Filter becomes initialized when window is full.
+ * @note	Time complexity is O(count).
+ *
+ * @param	filter	-	rank filter handle
+ * @param	new_sample	-	new raw sample
+ * @param	y	-	pointer to where filtered sample will be written. Can be NULL.
+ *
+ * @return	Filter error status
+ */
+static FilterStatus_t rank_filter_warmup_sample(RankFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t *sorted_window = filter->sorted_window;
+	uint16_t count = FIFO_get_data_count(fifo_ptr);
+	uint16_t pos = count;
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	while(pos > 0 && sorted_window[pos-1] > new_sample)
+	{
+		pos--;
+	}
+
+	memmove(sorted_window+pos+1, sorted_window+pos, (count - pos)*sizeof *sorted_window);
+	sorted_window[pos] = new_sample;
+
+	if(count + 1 == filter->window_size)
+	{
+		filter->initialized = 1;
+		filter->growing = 0;
+	}
+
+	if(y != NULL)
+	{
+		*y = sorted_window[rank_filter_current_rank(filter, filter->rank)];
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief 	Removes last sample from sorted window and inserts new sample keeping window sorted.
+ * @note	Time complexity is O(window_size).
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	window length
+ * @param	last_sample		-	sample to be removed. Must be present in the window.
+ * @param	new_sample		-	sample to be inserted
+ * @param	removed_pos		-	position of removed sample before update. Can be NULL.
+ * @param	inserted_pos	-	position of inserted sample after update. Can be NULL.
+ */
+static inline void rank_filter_window_replace(int16_t *sorted_window, uint16_t window_size,
+		int16_t last_sample, int16_t new_sample, uint16_t *removed_pos, uint16_t *inserted_pos)
+{
+	uint16_t item_size = sizeof(new_sample);
+
+	int32_t last_sample_rank = -1;
+	int32_t new_sample_rank = -1;
+	int32_t new_sample_rank_shift = 1;
+
+	uint32_t i;
+
+	/* Determine last and new sample ranks */
+	for(i=0; i<window_size; i++)
+	{
+		if(sorted_window[i] == last_sample && last_sample_rank == -1)
+		{
+			last_sample_rank = i;
+		}
+
+		if(sorted_window[i] >= new_sample && new_sample_rank == -1)
+		{
+			new_sample_rank = i;
+		}
+
+		if(last_sample_rank != -1 && new_sample_rank != -1)
+		{
+			break;
+		}
+	}
+
+	if(new_sample_rank == -1)
+	{
+		new_sample_rank = window_size - 1;
+		new_sample_rank_shift = 0;
+	}
+
+	/* We remove last sample and insert new sample at its' position */
+	uint32_t bytes_to_move = 0;
+	if(last_sample_rank < new_sample_rank)
+	{
+		bytes_to_move = (new_sample_rank - last_sample_rank)*item_size;
+		memmove(sorted_window+last_sample_rank, sorted_window+last_sample_rank+1, bytes_to_move);
+
+		new_sample_rank -= new_sample_rank_shift;
+		sorted_window[new_sample_rank] = new_sample;
+
+	}
+	else if(last_sample_rank > new_sample_rank)
+	{
+		bytes_to_move = (last_sample_rank - new_sample_rank)*item_size;
+		memmove(sorted_window+new_sample_rank+1, sorted_window+new_sample_rank, bytes_to_move);
+
+		sorted_window[new_sample_rank] = new_sample;
+	}
+	else // equal
+	{
+		sorted_window[last_sample_rank] = new_sample;
+	}
+
+	if(removed_pos != NULL)
+	{
+		*removed_pos = last_sample_rank;
+	}
+
+	if(inserted_pos != NULL)
+	{
+		*inserted_pos = new_sample_rank;
+	}
+
+	FILTER_STATS_RANK_SCAN((i < window_size) ? i + 1 : window_size, bytes_to_move);
+}
+
+
+/**
+ * @brief 	Removes last sample from sorted window and inserts new sample keeping window sorted.
+ * 				Both positions are found with binary search.
+ * @note	Time complexity is O(log(window_size)) comparisons plus memmove of samples between positions.
+ *
+ * @param	sorted_window	-	sorted window
+ * @param	window_size		-	window length
+ * @param	last_sample		-	sample to be removed. Must be present in the window.
+ * @param	new_sample		-	sample to be inserted
+ */
+static inline void rank_filter_window_replace_bsearch(int16_t *sorted_window, uint16_t window_size,
+		int16_t last_sample, int16_t new_sample)
+{
+	uint16_t removed = rank_filter_lower_bound(sorted_window, 0, window_size, last_sample);
+	uint16_t inserted;
+	uint32_t bytes_to_move;
+
+	if(new_sample >= last_sample)
+	{
+		/* Samples between removed and inserted positions move one step down */
+		inserted = rank_filter_lower_bound(sorted_window, removed + 1, window_size, new_sample) - 1;
+		bytes_to_move = (inserted - removed)*sizeof *sorted_window;
+		memmove(sorted_window+removed, sorted_window+removed+1, bytes_to_move);
+	}
+	else
+	{
+		inserted = rank_filter_lower_bound(sorted_window, 0, removed, new_sample);
+		bytes_to_move = (removed - inserted)*sizeof *sorted_window;
+		memmove(sorted_window+inserted+1, sorted_window+inserted, bytes_to_move);
+	}
+
+	sorted_window[inserted] = new_sample;
+
+	FILTER_STATS_RANK_SCAN(0, bytes_to_move);
+}
+
+
+/**
+ * @brief	Returns position of the first sample of sorted_window[begin .. end) not less than sample,
+ * 				end if there is no such sample.
+ */
+static inline uint16_t rank_filter_lower_bound(const int16_t *sorted_window, uint16_t begin, uint16_t end,
+		int16_t sample)
+{
+	while(begin < end)
+	{
+		uint16_t mid = begin + (end - begin) / 2;
+
+		if(sorted_window[mid] < sample)
+		{
+			begin = mid + 1;
+		}
+		else
+		{
+			end = mid;
+		}
+	}
+
+	return begin;
+}
+
+
+/**
+ * @brief 	Rank filtering of a simple buffer with sorting network.
+ * @note	Sorts SORT_NETWORK_LANES windows at once. The last block of windows may overlap previous one.
+ *
+ * @param	network		-	sorting network of window size
+ * @param	data		-	data to be filtered
+ * @param	filtered_len	-	number of outputs
+ * @param	rank		-	filter rank
+ * @param	y			-	pointer where output data will be stored
+ */
+static void rank_filter_sequence_network(const SortNetwork_t *network, int16_t *data, uint16_t filtered_len,
+		uint16_t rank, int16_t *y)
+{
+	int16_t lanes[SORT_NETWORK_MAX_SIZE][SORT_NETWORK_LANES];
+	uint16_t window_size = network->size;
+	uint32_t i = 0;
+
+	while(filtered_len >= SORT_NETWORK_LANES && i < filtered_len)
+	{
+		uint32_t base = (i + SORT_NETWORK_LANES <= filtered_len) ? i : (uint32_t)filtered_len - SORT_NETWORK_LANES;
+
+		for(uint32_t k=0; k<window_size; k++)
+		{
+			for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+			{
+				lanes[k][l] = data[base + k + l];
+			}
+		}
+
+		sort_network_sort_lanes(network, lanes);
+
+		for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+		{
+			y[base + l] = lanes[rank][l];
+		}
+
+		i = base + SORT_NETWORK_LANES;
+	}
+
+	/* Sequences shorter than one block */
+	for(; i<filtered_len; i++)
+	{
+		int16_t window[SORT_NETWORK_MAX_SIZE];
+
+		memcpy(window, data+i, window_size*sizeof *window);
+		sort_network_sort(network, window);
+
+		y[i] = window[rank];
+	}
+}
+
+
+/**
+ * @brief	Rank filters output rows [row_begin, row_end) of 2D frame with column histograms.
+ * @note	Histograms are allocated per band, so bands can be processed in parallel.
+ */
+static FilterStatus_t rank_filter_2d_band(RankFilter2d_t *config, uint32_t row_begin, uint32_t row_end)
+{
+	const uint32_t coarse_bins = config->coarse_bins;
+	const uint32_t fine_bins = coarse_bins << config->fine_bits;
+	const uint16_t kernel_width = config->kernel_width;
+	const uint16_t kernel_height = config->kernel_height;
+	const uint16_t width = config->width;
+
+	config->column_coarse = _malloc(config->columns * coarse_bins * sizeof *config->column_coarse);
+	config->column_fine = _malloc(config->columns * fine_bins * sizeof *config->column_fine);
+	config->kernel_coarse = _malloc(coarse_bins * sizeof *config->kernel_coarse);
+	config->kernel_fine = _malloc(fine_bins * sizeof *config->kernel_fine);
+	config->fine_synced = _malloc(coarse_bins * sizeof *config->fine_synced);
+
+	FilterStatus_t status = FilterError;
+
+	if(config->column_coarse != NULL && config->column_fine != NULL && config->kernel_coarse != NULL
+			&& config->kernel_fine != NULL && config->fine_synced != NULL)
+	{
+		memset(config->column_coarse, 0, config->columns * coarse_bins * sizeof *config->column_coarse);
+		memset(config->column_fine, 0, config->columns * fine_bins * sizeof *config->column_fine);
+
+		uint16_t strip_y_width = config->columns - kernel_width + 1;
+
+		for(uint32_t x0=0; x0<config->y_width; x0+=strip_y_width)
+		{
+			const int16_t *strip = config->frame + x0;
+			uint16_t strip_columns = (width - x0 < config->columns) ? width - x0 : config->columns;
+
+			for(uint32_t r=row_begin; r<row_begin+kernel_height; r++)
+			{
+				for(uint16_t c=0; c<strip_columns; c++)
+				{
+					rank_filter_2d_update_column(config, c, strip[r*width + c], 1);
+				}
+			}
+
+			for(uint32_t r=row_begin; r<row_end; r++)
+			{
+				if(r != row_begin)
+				{
+					for(uint16_t c=0; c<strip_columns; c++)
+					{
+						rank_filter_2d_update_column(config, c, strip[(r-1)*width + c], -1);
+						rank_filter_2d_update_column(config, c, strip[(r+kernel_height-1)*width + c], 1);
+					}
+				}
+
+				rank_filter_2d_row(config, strip_columns - kernel_width + 1, config->y + r*config->y_width + x0);
+			}
+
+			/* Remove the last window so histograms are empty for the next strip */
+			for(uint32_t r=row_end-1; r<row_end-1+kernel_height; r++)
+			{
+				for(uint16_t c=0; c<strip_columns; c++)
+				{
+					rank_filter_2d_update_column(config, c, strip[r*width + c], -1);
+				}
+			}
+		}
+
+		status = FilterOK;
+	}
+
+	_free(config->column_coarse);
+	_free(config->column_fine);
+	_free(config->kernel_coarse);
+	_free(config->kernel_fine);
+	_free(config->fine_synced);
+
+	return status;
+}
+
+
+/**
+ * @brief	Rank filters output rows [row_begin, row_end) of 2D frame with sorted window.
+ * @note	Used when column histograms of frame range are too large. Window walks the band in
+ * 				serpentine order, so every step replaces one sorted column or one row of kernel in one pass.
+ * 				Time complexity is O(kernel_width * kernel_height) per output.
+ */
+static FilterStatus_t rank_filter_2d_band_direct(const RankFilter2d_t *config, uint32_t row_begin, uint32_t row_end)
+{
+	const uint16_t kernel_width = config->kernel_width;
+	const uint16_t kernel_height = config->kernel_height;
+	const uint16_t width = config->width;
+	const uint16_t y_width = config->y_width;
+	const uint32_t area = (uint32_t)kernel_width * kernel_height;
+	const int16_t *frame = config->frame;
+
+	/* Sorted frame columns of kernel_height samples, kernel window and rows leaving and entering it */
+	int16_t *columns = _malloc((size_t)width * kernel_height * sizeof *columns);
+	int16_t *window = _malloc((size_t)area * sizeof *window);
+	int16_t *merged = _malloc((size_t)area * sizeof *merged);
+	int16_t *last_row = _malloc(kernel_width * sizeof *last_row);
+	int16_t *new_row = _malloc(kernel_width * sizeof *new_row);
+
+	FilterStatus_t status = FilterError;
+
+	if(columns != NULL && window != NULL && merged != NULL && last_row != NULL && new_row != NULL)
+	{
+		uint16_t x = 0;
+		int8_t step = 1;
+
+		for(uint16_t c=0; c<width; c++)
+		{
+			int16_t *column = &columns[(size_t)c * kernel_height];
+
+			for(uint16_t k=0; k<kernel_height; k++)
+			{
+				column[k] = frame[(size_t)(row_begin + k) * width + c];
+			}
+
+			qsort(column, kernel_height, sizeof *column, filter_sort_cmp);
+		}
+
+		memcpy(window, columns, (size_t)area * sizeof *window);
+		qsort(window, area, sizeof *window, filter_sort_cmp);
+
+		for(uint32_t r=row_begin; r<row_end; r++)
+		{
+			if(r != row_begin)
+			{
+				const int16_t *leaving = &frame[(size_t)(r - 1) * width];
+				const int16_t *entering = &frame[(size_t)(r + kernel_height - 1) * width];
+				uint16_t removed_pos, inserted_pos;
+
+				for(uint16_t c=0; c<width; c++)
+				{
+					rank_filter_window_update(&columns[(size_t)c * kernel_height], kernel_height, leaving[c],
+							entering[c], &removed_pos, &inserted_pos);
+				}
+
+				/* Move window one row down where it stopped */
+				memcpy(last_row, leaving + x, kernel_width * sizeof *last_row);
+				memcpy(new_row, entering + x, kernel_width * sizeof *new_row);
+				qsort(last_row, kernel_width, sizeof *last_row, filter_sort_cmp);
+				qsort(new_row, kernel_width, sizeof *new_row, filter_sort_cmp);
+
+				rank_filter_window_merge(window, area, last_row, new_row, kernel_width, merged);
+
+				int16_t *swap = window;
+				window = merged;
+				merged = swap;
+			}
+
+			config->y[r * y_width + x] = window[config->rank];
+
+			for(uint16_t n=1; n<y_width; n++)
+			{
+				uint16_t leaving = (step > 0) ? x : x + kernel_width - 1;
+				uint16_t entering = (step > 0) ? x + kernel_width : x - 1;
+
+				rank_filter_window_merge(window, area, &columns[(size_t)leaving * kernel_height],
+						&columns[(size_t)entering * kernel_height], kernel_height, merged);
+
+				int16_t *swap = window;
+				window = merged;
+				merged = swap;
+
+				x += step;
+				config->y[r * y_width + x] = window[config->rank];
+			}
+
+			step = -step;
+		}
+
+		status = FilterOK;
+	}
+
+	_free(columns);
+	_free(window);
+	_free(merged);
+	_free(last_row);
+	_free(new_row);
+
+	return status;
+}
+
+
+/**
+ * @brief	Adds sample to (delta = 1) or removes it from (delta = -1) column histograms.
+ */
+static inline void rank_filter_2d_update_column(RankFilter2d_t *config, uint16_t column, int16_t sample, int16_t delta)
+{
+	uint32_t value = (int32_t)sample - config->offset;
+	uint32_t fine_bins = config->coarse_bins << config->fine_bits;
+
+	config->column_coarse[column*config->coarse_bins + (value >> config->fine_bits)] += delta;
+	config->column_fine[column*fine_bins + value] += delta;
+}
+
+
+/**
+ * @brief	Computes one output row of a strip from column histograms.
+ *
+ * @param	config	-	band configuration with up to date column histograms
+ * @param	y_len	-	number of outputs in strip row
+ * @param	y		-	output
+ */
+static void rank_filter_2d_row(RankFilter2d_t *config, uint16_t y_len, int16_t *y)
+{
+	const uint32_t coarse_bins = config->coarse_bins;
+	const uint8_t fine_bits = config->fine_bits;
+	const uint32_t fine_num = 1u << fine_bits;
+	const uint32_t fine_bins = coarse_bins << fine_bits;
+	const uint16_t kernel_width = config->kernel_width;
+
+	const uint16_t *column_coarse = config->column_coarse;
+	const uint16_t *column_fine = config->column_fine;
+	uint32_t *kernel_coarse = config->kernel_coarse;
+	uint32_t *kernel_fine = config->kernel_fine;
+	int32_t *fine_synced = config->fine_synced;
+
+	memset(kernel_coarse, 0, coarse_bins * sizeof *kernel_coarse);
+
+	for(uint16_t k=0; k<kernel_width; k++)
+	{
+		for(uint32_t b=0; b<coarse_bins; b++)
+		{
+			kernel_coarse[b] += column_coarse[k*coarse_bins + b];
+		}
+	}
+
+	for(uint32_t b=0; b<coarse_bins; b++)
+	{
+		fine_synced[b] = -1;
+	}
+
+	for(int32_t x=0; x<y_len; x++)
+	{
+		if(x != 0)
+		{
+			const uint16_t *entering = column_coarse + (x+kernel_width-1)*coarse_bins;
+			const uint16_t *leaving = column_coarse + (x-1)*coarse_bins;
+
+			for(uint32_t b=0; b<coarse_bins; b++)
+			{
+				kernel_coarse[b] += entering[b] - leaving[b];
+			}
+		}
+
+		/* Coarse bin of the rank */
+		uint32_t remaining = config->rank;
+		uint32_t coarse = 0;
+
+		while(kernel_coarse[coarse] <= remaining)
+		{
+			remaining -= kernel_coarse[coarse++];
+		}
+
+		/* Bring fine histogram of this bin up to date */
+		uint32_t *fine = kernel_fine + (coarse << fine_bits);
+
+		if(fine_synced[coarse] < 0 || x - fine_synced[coarse] >= kernel_width)
+		{
+			memset(fine, 0, fine_num * sizeof *fine);
+
+			for(int32_t k=x; k<x+kernel_width; k++)
+			{
+				const uint16_t *column = column_fine + k*fine_bins + (coarse << fine_bits);
+
+				for(uint32_t f=0; f<fine_num; f++)
+				{
+					fine[f] += column[f];
+				}
+			}
+		}
+		else
+		{
+			for(int32_t s=fine_synced[coarse]+1; s<=x; s++)
+			{
+				const uint16_t *entering = column_fine + (s+kernel_width-1)*fine_bins + (coarse << fine_bits);
+				const uint16_t *leaving = column_fine + (s-1)*fine_bins + (coarse << fine_bits);
+
+				for(uint32_t f=0; f<fine_num; f++)
+				{
+					fine[f] += entering[f] - leaving[f];
+				}
+			}
+		}
+
+		fine_synced[coarse] = x;
+
+		uint32_t f = 0;
+
+		while(fine[f] <= remaining)
+		{
+			remaining -= fine[f++];
+		}
+
+		y[x] = config->offset + (int32_t)((coarse << fine_bits) + f);
+	}
 }
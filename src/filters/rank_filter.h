@@ -17,24 +17,85 @@ extern "C" {
 #endif
 
 
+/**
+ * Maximum size of column histograms of one band of 2D rank filter in bytes. If histograms
+ * of a strip of 2 * kernel_width - 1 columns do not fit, windows are sorted directly.
+ */
+#define RANK_FILTER_2D_HIST_BUDGET  (512u * 1024u)
+
+
+/**
+ * Sorted window update of rank_filter_filter_sample(...) and rank_filter_filter_block(...):
+ *      LinearScan      -   one forward scan finds both positions, cheap for small windows
+ *      BinarySearch    -   positions are found with binary search, only memmove is linear
+ * Both give identical output.
+ */
+typedef enum {RankFilterLinearScan=0, RankFilterBinarySearch} RankFilterBackend_t;
+
+
 typedef struct rank_filter {
 	int16_t 	*sorted_window;
+	uint16_t	buffer_size;
 	uint16_t 	window_size;
 	uint16_t	rank;
 
+	/* Ranks of multi rank filter */
+	const uint16_t	*ranks;
+	uint16_t	ranks_num;
+
 	uint8_t 	initialized;
+	uint8_t		warmup;
+	uint8_t		growing;
+
+	RankFilterBackend_t	backend;
+
+	/* Decimated rank filter. Window updates between outputs are batched. */
+	uint16_t	decimation;
+	uint16_t	batch_len;
+	int16_t		*batch;
 
 	FIFO_t      fifo;
 } RankFilter_t;
 
 
 FilterStatus_t  rank_filter_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size, uint16_t rank);
+FilterStatus_t  rank_filter_init_capacity(RankFilter_t *rank_filter, int16_t *buffer, uint16_t buffer_size,
+        uint16_t window_size, uint16_t rank);
+FilterStatus_t  rank_filter_resize(RankFilter_t *rank_filter, uint16_t window_size);
+FilterStatus_t  rank_filter_set_rank(RankFilter_t *rank_filter, uint16_t rank);
+void            rank_filter_set_backend(RankFilter_t *rank_filter, RankFilterBackend_t backend);
+FilterStatus_t  rank_filter_replace_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *last_sample,
+        uint16_t *removed_pos, uint16_t *inserted_pos);
+void            rank_filter_window_update(int16_t *sorted_window, uint16_t window_size, int16_t last_sample,
+        int16_t new_sample, uint16_t *removed_pos, uint16_t *inserted_pos);
 FilterStatus_t  rank_filter_fill_buffer(RankFilter_t *rf, int16_t *samples, int16_t *y);
 FilterStatus_t  rank_filter_filter_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  rank_filter_multi_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size,
+        const uint16_t *ranks, uint16_t ranks_num);
+FilterStatus_t  rank_filter_multi_fill_buffer(RankFilter_t *rf, int16_t *samples, int16_t *y);
+FilterStatus_t  rank_filter_multi_filter_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  rank_filter_filter_block(RankFilter_t *rank_filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
+FilterStatus_t  rank_filter_decimated_init(RankFilter_t *rank_filter, int16_t *buffer, uint16_t window_size,
+        uint16_t rank, uint16_t decimation);
+FilterStatus_t  rank_filter_decimated_filter_sample(RankFilter_t *rank_filter, int16_t new_sample, int16_t *y,
+        uint8_t *ready);
+FilterStatus_t  rank_filter_decimated_filter_block(RankFilter_t *rank_filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
 FilterStatus_t  rank_filter_filter_sequence(int16_t *data, int16_t data_size, uint16_t window_size,
         uint16_t rank, int16_t *y, uint16_t *y_len);
+FilterStatus_t  rank_filter_filter_sequence_padded(int16_t *data, uint16_t data_size, uint16_t window_size,
+        uint16_t rank, const FilterEdgeConfig_t *edge, int16_t *y);
+FilterStatus_t  rank_filter_filter_2d(const int16_t *frame, uint16_t width, uint16_t height,
+        uint16_t kernel_width, uint16_t kernel_height, uint32_t rank, int16_t *y);
 FilterStatus_t  rank_filter_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len);
 void            rank_filter_flush(RankFilter_t *rank_filter);
+void            rank_filter_deinit(RankFilter_t *rank_filter);
+void            rank_filter_set_warmup(RankFilter_t *rank_filter, uint8_t enable);
+uint32_t        rank_filter_get_state_size(RankFilter_t *rank_filter);
+FilterStatus_t  rank_filter_save_state(RankFilter_t *rank_filter, uint8_t *buf, uint32_t buf_size,
+        uint32_t *state_size);
+FilterStatus_t  rank_filter_restore_state(RankFilter_t *rank_filter, const uint8_t *buf, uint32_t buf_size);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,315 @@
+/*
+ * resampler.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Prepare Q15 low pass prototype filter for sample rate up * fs, i.e. with
+ *              resampler_design_lowpass(...).
+ *      2. Call resampler_init(...) on your resampler handle with rate ratio, prototype and downstream FIFO.
+ *              FIFO items must be int16 samples.
+ *      3. Call resampler_filter_block(...) on blocks of input samples. Output samples are written into
+ *              downstream FIFO, which is then read by the next filter. Size the FIFO with
+ *              resampler_get_max_output_len(...) or create it with FIFO_LOOP flag.
+ *      4. Call resampler_deinit(...) to release resampler memory.
+ *
+ *      If you need to reset resampler i.e. pause:
+ *          Call resampler_flush(...)
+ *
+ *  Output rate is input rate * up / down. Samples before the first input are zeros, so output starts
+ *  with the first input sample and is delayed by (taps_num - 1) / 2 samples of rate up * fs.
+ *
+ *   Algorithm:
+ *      Polyphase rational resampler. Output m is sample m * down of the signal upsampled by up with zeros
+ *      and filtered by the prototype h.
+ *      1. Only every up-th tap hits a nonzero sample, so output m is an inner product of
+ *              phase p = (m * down) mod up taps h[p], h[p + up], ... with the last taps_per_phase input samples
+ *              ending at input (m * down) / up.
+ *      2. Phases are stored reversed so the inner product runs forward over both arrays. It is a plain
+ *              int16 multiply-accumulate loop which compiler turns into SIMD multiply-add instructions.
+ *      3. Input is copied in chunks after taps_per_phase - 1 history samples, so windows are contiguous
+ *              and need no wrap-around. Only produced outputs are computed, skipped ones cost nothing.
+ *      4. Sums of int16 products are kept in filter_acc_t. With 32 bits accumulator sum of absolute
+ *              coefficients of every phase must be below 65536, define FILTER_WIDE_ACCUMULATOR otherwise.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "resampler.h"
+#include "filter_stats.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline int16_t resampler_inner_product(const int16_t *taps, const int16_t *x, uint16_t len);
+static uint32_t resampler_get_output_len(Resampler_t *resampler, uint32_t data_len);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes resampler
+ * @param	resampler	-	resampler handle
+ * @param	up			-	interpolation factor
+ * @param	down		-	decimation factor
+ * @param	coeffs		-	Q15 low pass prototype for sample rate up * fs. Its DC gain must be up.
+ * @param	taps_num	-	number of prototype coefficients
+ * @param	output		-	downstream FIFO of int16 samples
+ *
+ * @return	Filter status
+ */
+FilterStatus_t resampler_init(Resampler_t *resampler, uint16_t up, uint16_t down, const int16_t *coeffs,
+		uint16_t taps_num, FIFO_t *output)
+{
+	if(up == 0 || down == 0 || taps_num == 0 || output == NULL || output->item_size != sizeof(int16_t))
+	{
+		return FilterError;
+	}
+
+	const uint16_t taps_per_phase = (taps_num + up - 1) / up;
+
+	resampler->up = up;
+	resampler->down = down;
+	resampler->taps_per_phase = taps_per_phase;
+	resampler->output = output;
+
+	resampler->bank = _malloc((uint32_t)up * taps_per_phase * sizeof *resampler->bank);
+	resampler->history = _malloc((taps_per_phase - 1 + RESAMPLER_CHUNK) * sizeof *resampler->history);
+
+	if(resampler->bank == NULL || resampler->history == NULL)
+	{
+		resampler_deinit(resampler);
+		return FilterError;
+	}
+
+	for(uint32_t phase=0; phase<up; phase++)
+	{
+		int16_t *taps = &resampler->bank[phase * taps_per_phase];
+
+		for(uint32_t i=0; i<taps_per_phase; i++)
+		{
+			uint32_t tap = phase + (taps_per_phase - 1 - i) * up;
+
+			taps[i] = (tap < taps_num) ? coeffs[tap] : 0;
+		}
+	}
+
+	resampler_flush(resampler);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Designs Blackman windowed sinc low pass prototype for resampler.
+ * @note	Cutoff is 0.9 of the lower of input and output Nyquist frequencies. Taps per phase
+ * 				taps_num / up set transition width, 8..32 are common.
+ *
+ * @param	up			-	interpolation factor
+ * @param	down		-	decimation factor
+ * @param	taps_num	-	number of coefficients
+ * @param	coeffs		-	Q15 coefficients with DC gain up
+ *
+ * @return	Filter status
+ */
+FilterStatus_t resampler_design_lowpass(uint16_t up, uint16_t down, uint16_t taps_num, int16_t *coeffs)
+{
+	if(up == 0 || down == 0 || taps_num == 0)
+	{
+		return FilterError;
+	}
+
+	/* Cycles per sample of rate up * fs */
+	const double cutoff = 0.45 / ((up > down) ? up : down);
+	const double center = (taps_num - 1) / 2.0;
+
+	for(uint32_t i=0; i<taps_num; i++)
+	{
+		double t = i - center;
+		double sinc = (t == 0) ? 1.0 : sin(2.0 * FILTER_PI * cutoff * t) / (2.0 * FILTER_PI * cutoff * t);
+		double window = 1.0;
+
+		if(taps_num > 1)
+		{
+			double a = 2.0 * FILTER_PI * i / (taps_num - 1);
+			window = 0.42 - 0.5 * cos(a) + 0.08 * cos(2 * a);
+		}
+
+		long tap = lround(32768.0 * up * 2.0 * cutoff * sinc * window);
+
+		coeffs[i] = (tap > INT16_MAX) ? INT16_MAX : ((tap < INT16_MIN) ? INT16_MIN : tap);
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Returns the largest number of output samples produced from data_len input samples.
+ */
+uint32_t resampler_get_max_output_len(Resampler_t *resampler, uint32_t data_len)
+{
+	return ((uint64_t)data_len * resampler->up + resampler->down - 1) / resampler->down;
+}
+
+
+/**
+ * @brief       Resamples block of samples into downstream FIFO keeping resampler state between calls.
+ *
+ * @param[in]   resampler   -   resampler handle
+ * @param[in]   data        -   new input samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y_len       -   number of samples written into downstream FIFO.
+ *
+ * @return      Filter error status. If downstream FIFO without FIFO_LOOP flag has no room for all outputs
+ *                  of the block, error is returned before any input is consumed, so the same block can be
+ *                  fed again after downstream filter reads FIFO.
+ */
+FilterStatus_t resampler_filter_block(Resampler_t *resampler, const int16_t *data, uint16_t data_len,
+		uint32_t *y_len)
+{
+	const uint16_t up = resampler->up;
+	const uint16_t down = resampler->down;
+	const uint16_t taps_per_phase = resampler->taps_per_phase;
+	const uint16_t history_len = taps_per_phase - 1;
+
+	int16_t *history = resampler->history;
+	uint32_t phase = resampler->phase;
+	uint32_t next_input = resampler->next_input;
+
+	int16_t batch[RESAMPLER_OUTPUT_BATCH];
+	uint16_t batch_len = 0;
+	uint16_t written = 0;
+	uint32_t produced = 0;
+	FilterStatus_t status = FilterOK;
+
+	*y_len = 0;
+
+	if(!(resampler->output->fifo8.flags & FIFO_LOOP)
+			&& resampler_get_output_len(resampler, data_len) > FIFO_get_free_space(resampler->output))
+	{
+		return FilterError;
+	}
+
+	while(data_len != 0 && status == FilterOK)
+	{
+		const uint16_t len = (data_len < RESAMPLER_CHUNK) ? data_len : RESAMPLER_CHUNK;
+		const uint32_t end = history_len + len;
+
+		memcpy(&history[history_len], data, len * sizeof *history);
+
+		while(next_input < end)
+		{
+			batch[batch_len++] = resampler_inner_product(&resampler->bank[phase * taps_per_phase],
+					&history[next_input - history_len], taps_per_phase);
+
+			if(batch_len == RESAMPLER_OUTPUT_BATCH)
+			{
+				status = (FILTER_STATS_FIFO(FIFO_write(resampler->output, batch, batch_len, &written)) == FIFO_OK)
+						? FilterOK : FilterError;
+				produced += written;
+				batch_len = 0;
+
+				if(status != FilterOK)
+				{
+					break;
+				}
+			}
+
+			phase += down;
+			next_input += phase / up;
+			phase %= up;
+		}
+
+		memmove(history, &history[len], history_len * sizeof *history);
+		next_input -= len;
+
+		data += len;
+		data_len -= len;
+	}
+
+	if(batch_len != 0 && status == FilterOK)
+	{
+		status = (FILTER_STATS_FIFO(FIFO_write(resampler->output, batch, batch_len, &written)) == FIFO_OK)
+				? FilterOK : FilterError;
+		produced += written;
+	}
+
+	resampler->phase = phase;
+	resampler->next_input = next_input;
+
+	*y_len = produced;
+
+	return status;
+}
+
+
+void resampler_flush(Resampler_t *resampler)
+{
+	memset(resampler->history, 0, (resampler->taps_per_phase - 1) * sizeof *resampler->history);
+
+	resampler->phase = 0;
+	resampler->next_input = resampler->taps_per_phase - 1;
+}
+
+
+void resampler_deinit(Resampler_t *resampler)
+{
+	_free(resampler->bank);
+	_free(resampler->history);
+
+	resampler->bank = NULL;
+	resampler->history = NULL;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Returns Q15 inner product of taps and samples rounded and saturated to int16.
+ */
+static inline int16_t resampler_inner_product(const int16_t *taps, const int16_t *x, uint16_t len)
+{
+	filter_acc_t acc = 0;
+
+	for(uint16_t i=0; i<len; i++)
+	{
+		acc += (int32_t)taps[i] * x[i];
+	}
+
+	int32_t sample = (int32_t)((acc + (1 << 14)) >> 15);
+
+	if(sample > INT16_MAX)
+	{
+		sample = INT16_MAX;
+	}
+	else if(sample < INT16_MIN)
+	{
+		sample = INT16_MIN;
+	}
+
+	return sample;
+}
+
+
+/**
+ * @brief	Returns exact number of output samples produced from the next data_len input samples.
+ * @note	Output m is computed when input next_input + (phase + m * down) / up arrives.
+ */
+static uint32_t resampler_get_output_len(Resampler_t *resampler, uint32_t data_len)
+{
+	const uint64_t end = (uint64_t)resampler->taps_per_phase - 1 + data_len;
+
+	if(resampler->next_input >= end)
+	{
+		return 0;
+	}
+
+	uint64_t inputs = end - resampler->next_input;
+
+	return (inputs * resampler->up - resampler->phase + resampler->down - 1) / resampler->down;
+}
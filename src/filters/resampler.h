@@ -0,0 +1,67 @@
+/*
+ * resampler.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_RESAMPLER_H_
+#define SRC_MOD_FILTERS_RESAMPLER_H_
+
+#include "filter.h"
+#include "fifo/FIFO.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Input samples processed per pass over the history buffer
+ */
+#define RESAMPLER_CHUNK		256
+
+/**
+ * Output samples collected before one write into downstream FIFO
+ */
+#define RESAMPLER_OUTPUT_BATCH	64
+
+
+typedef struct resampler {
+
+	/* Rate is changed by up / down */
+	uint16_t	up;
+	uint16_t	down;
+
+	/* Polyphase bank, up phases of taps_per_phase Q15 coefficients each, stored in reversed order */
+	uint16_t	taps_per_phase;
+	int16_t		*bank;
+
+	/* taps_per_phase - 1 previous samples followed by the current chunk */
+	int16_t		*history;
+
+	/* Phase and history position of the next output */
+	uint16_t	phase;
+	uint32_t	next_input;
+
+	/* Downstream FIFO of int16 samples */
+	FIFO_t		*output;
+
+} Resampler_t;
+
+
+FilterStatus_t  resampler_init(Resampler_t *resampler, uint16_t up, uint16_t down, const int16_t *coeffs,
+        uint16_t taps_num, FIFO_t *output);
+FilterStatus_t  resampler_design_lowpass(uint16_t up, uint16_t down, uint16_t taps_num, int16_t *coeffs);
+uint32_t        resampler_get_max_output_len(Resampler_t *resampler, uint32_t data_len);
+FilterStatus_t  resampler_filter_block(Resampler_t *resampler, const int16_t *data, uint16_t data_len,
+        uint32_t *y_len);
+void            resampler_flush(Resampler_t *resampler);
+void            resampler_deinit(Resampler_t *resampler);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_RESAMPLER_H_ */
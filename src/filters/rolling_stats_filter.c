@@ -0,0 +1,402 @@
+/*
+ * rolling_stats_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call rolling_stats_init(...) on your filter handle
+ *      2. Call rolling_stats_fill_buffer(...) when you collected enough samples(equal to window size)
+ *              to compute the first output.
+ *      3. Call rolling_stats_filter_sample(...) on each new sample.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          4.1 Call rolling_stats_flush(...)
+ *
+ *      After that you have to fill buffer again with:
+ *          4.2 rolling_stats_fill_buffer(...) before sampling.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with rolling_stats_filter_block(...).
+ *  It collects the first window itself and outputs one item per input sample after that.
+ *
+ *  Call rolling_stats_deinit(...) to release filter memory.
+ *
+ *  You can also process prepared sequence with rolling_stats_filter_sequence(...).
+ *
+ *  Every output item holds mean, population variance, minimum and maximum of the window. Mean and
+ *  variance are rounded towards zero.
+ *
+ *   Algorithm:
+ *      1. One window FIFO holds samples. Sum and sum of squares are updated with the new and the oldest
+ *              sample. Both are exact integers, so variance (n * S2 - S^2) / n^2 does not drift.
+ *      2. Minimum and maximum are fronts of two monotonic deques of (index, value) items. The new sample
+ *              pops all the items it dominates from the back, items older than window are popped
+ *              from the front. Amortized cost is O(1) per sample.
+ *      3. Sequence API finds minimum and maximum with van Herk/Gil-Werman algorithm instead of deques.
+ *              Input is split into blocks of window size, window is a suffix of one block and a prefix
+ *              of the next one. It costs three branch free comparisons per sample.
+ */
+
+
+#include <stdlib.h>
+
+#include "rolling_stats_filter.h"
+#include "filter_stats.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static void rolling_stats_add_sample(RollingStatsFilter_t *filter, int16_t new_sample);
+static inline void rolling_stats_deque_push(RollingStatsDeque_t *deque, uint16_t window_size, uint32_t index,
+		int16_t value, uint8_t is_max);
+static inline void rolling_stats_output(filter_acc_t sum, int64_t sum_squares, uint16_t window_size,
+		int16_t min, int16_t max, RollingStatsOutput_t *y);
+static inline void rolling_stats_get_output(RollingStatsFilter_t *filter, RollingStatsOutput_t *y);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes rolling statistics filter
+ * @param	filter		-	filter handle
+ * @param 	buffer		-	buffer with incoming data. Length of buffer must match window size.
+ * @param	window_size	-	filter window size
+ *
+ * @return	Filter status
+ */
+FilterStatus_t rolling_stats_init(RollingStatsFilter_t *filter, int16_t *buffer, uint16_t window_size)
+{
+	if(window_size == 0)
+	{
+		return FilterError;
+	}
+
+	filter->window_size = window_size;
+
+	filter->min_deque.items = _malloc(window_size * sizeof *filter->min_deque.items);
+	filter->max_deque.items = _malloc(window_size * sizeof *filter->max_deque.items);
+
+	if(filter->min_deque.items == NULL || filter->max_deque.items == NULL)
+	{
+		rolling_stats_deinit(filter);
+		return FilterError;
+	}
+
+	FIFO_init(&filter->fifo, (uint8_t*)buffer, window_size, sizeof(*buffer), FIFO_LOOP);
+	rolling_stats_flush(filter);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Fill filter buffer for the first time
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   samples -   samples to be written. Length must match filter window size
+ * @param[out]  y       -   pointer where statistics will be stored.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rolling_stats_fill_buffer(RollingStatsFilter_t *filter, int16_t *samples, RollingStatsOutput_t *y)
+{
+	if(filter->initialized)
+	{
+		return FilterError;
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_write(&filter->fifo, samples, filter->window_size, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	for(uint16_t i=0; i<filter->window_size; i++)
+	{
+		rolling_stats_add_sample(filter, samples[i]);
+	}
+
+	filter->initialized = 1;
+	rolling_stats_get_output(filter, y);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	    Computes statistics of the next window.
+ *
+ * @param[in]	filter	    -   filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	        -	pointer to where statistics will be written.
+ *
+ * @return	    Filter error status
+ */
+FilterStatus_t rolling_stats_filter_sample(RollingStatsFilter_t *filter, int16_t new_sample, RollingStatsOutput_t *y)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t last_sample;
+
+	if(!filter->initialized)
+	{
+		return FilterError;
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_sample, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	filter->sum -= last_sample;
+	filter->sum_squares -= (int32_t)last_sample * last_sample;
+
+	rolling_stats_add_sample(filter, new_sample);
+	rolling_stats_get_output(filter, y);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Processes block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with rolling_stats_fill_buffer. While the first window is not
+ *                  collected input samples produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for statistics. Must hold data_len items.
+ * @param[out]  y_len       -   number of produced items.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rolling_stats_filter_block(RollingStatsFilter_t *filter, int16_t *data, uint16_t data_len,
+		RollingStatsOutput_t *y, uint16_t *y_len)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	uint16_t produced = 0;
+	uint16_t i = 0;
+
+	/* Collect the first window */
+	while(i < data_len && !filter->initialized)
+	{
+		if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &data[i], 1, NULL)) != FIFO_OK)
+		{
+			return FilterError;
+		}
+
+		rolling_stats_add_sample(filter, data[i++]);
+
+		if(FIFO_get_data_count(fifo_ptr) == filter->window_size)
+		{
+			filter->initialized = 1;
+			rolling_stats_get_output(filter, &y[produced++]);
+		}
+	}
+
+	for(; i<data_len; i++)
+	{
+		if(rolling_stats_filter_sample(filter, data[i], &y[produced++]) != FilterOK)
+		{
+			return FilterError;
+		}
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Computes rolling statistics of a simple buffer in one pass.
+ *
+ * @param[in]   data        -   data to be processed
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   window size
+ * @param[out]  y           -   pointer where statistics will be stored.
+ * @param[out]  y_len       -   output length
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t rolling_stats_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+		RollingStatsOutput_t *y, uint16_t *y_len)
+{
+	if(window_size == 0 || window_size > data_size)
+	{
+		return FilterError;
+	}
+
+	uint16_t filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+
+	/* Suffix extrema of the current block */
+	int16_t suffix_min[window_size];
+	int16_t suffix_max[window_size];
+
+	filter_acc_t sum = 0;
+	int64_t sum_squares = 0;
+
+	for(uint16_t i=0; i<window_size-1; i++)
+	{
+		sum += data[i];
+		sum_squares += (int32_t)data[i] * data[i];
+	}
+
+	for(uint32_t block=0; block<filtered_len; block+=window_size)
+	{
+		uint32_t outputs = (filtered_len - block < window_size) ? filtered_len - block : window_size;
+
+		int16_t min = INT16_MAX;
+		int16_t max = INT16_MIN;
+
+		for(uint32_t j=window_size; j-->0;)
+		{
+			int16_t x = data[block + j];
+
+			min = (x < min) ? x : min;
+			max = (x > max) ? x : max;
+
+			suffix_min[j] = min;
+			suffix_max[j] = max;
+		}
+
+		/* Prefix extrema of the next block */
+		int16_t prefix_min = INT16_MAX;
+		int16_t prefix_max = INT16_MIN;
+
+		for(uint32_t j=0; j<outputs; j++)
+		{
+			uint32_t i = block + j;
+			int16_t new_sample = data[i + window_size - 1];
+
+			if(j != 0)
+			{
+				prefix_min = (new_sample < prefix_min) ? new_sample : prefix_min;
+				prefix_max = (new_sample > prefix_max) ? new_sample : prefix_max;
+			}
+
+			sum += new_sample;
+			sum_squares += (int32_t)new_sample * new_sample;
+
+			rolling_stats_output(sum, sum_squares, window_size,
+					(suffix_min[j] < prefix_min) ? suffix_min[j] : prefix_min,
+					(suffix_max[j] > prefix_max) ? suffix_max[j] : prefix_max, &y[i]);
+
+			sum -= data[i];
+			sum_squares -= (int32_t)data[i] * data[i];
+		}
+	}
+
+	*y_len = filtered_len;
+
+	return FilterOK;
+}
+
+
+void rolling_stats_flush(RollingStatsFilter_t *filter)
+{
+	FIFO_flush(&filter->fifo);
+
+	filter->sum = 0;
+	filter->sum_squares = 0;
+	filter->index = 0;
+	filter->initialized = 0;
+
+	filter->min_deque.head = 0;
+	filter->min_deque.count = 0;
+	filter->max_deque.head = 0;
+	filter->max_deque.count = 0;
+}
+
+
+void rolling_stats_deinit(RollingStatsFilter_t *filter)
+{
+	_free(filter->min_deque.items);
+	_free(filter->max_deque.items);
+
+	filter->min_deque.items = NULL;
+	filter->max_deque.items = NULL;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Adds sample to sums and deques. Sample leaving the window must be already subtracted from sums.
+ */
+static void rolling_stats_add_sample(RollingStatsFilter_t *filter, int16_t new_sample)
+{
+	filter->sum += new_sample;
+	filter->sum_squares += (int32_t)new_sample * new_sample;
+
+	rolling_stats_deque_push(&filter->min_deque, filter->window_size, filter->index, new_sample, 0);
+	rolling_stats_deque_push(&filter->max_deque, filter->window_size, filter->index, new_sample, 1);
+
+	filter->index++;
+}
+
+
+/**
+ * @brief	Pushes sample into monotonic deque.
+ * @note	Items out of window are popped from the front, items dominated by the new sample are popped from
+ * 				the back. Deque never holds more than window_size items.
+ *
+ * @param	deque		-	deque
+ * @param	window_size	-	window size, also deque capacity
+ * @param	index		-	index of the new sample
+ * @param	value		-	new sample
+ * @param	is_max		-	1 for maximum deque, 0 for minimum one
+ */
+static inline void rolling_stats_deque_push(RollingStatsDeque_t *deque, uint16_t window_size, uint32_t index,
+		int16_t value, uint8_t is_max)
+{
+	RollingStatsDequeItem_t *items = deque->items;
+
+	if(deque->count != 0 && (uint32_t)(index - items[deque->head].index) >= window_size)
+	{
+		deque->head = (deque->head + 1 == window_size) ? 0 : deque->head + 1;
+		deque->count--;
+	}
+
+	while(deque->count != 0)
+	{
+		uint32_t tail = deque->head + deque->count - 1;
+		int16_t back = items[(tail >= window_size) ? tail - window_size : tail].value;
+
+		if(is_max ? (back > value) : (back < value))
+		{
+			break;
+		}
+
+		deque->count--;
+	}
+
+	uint32_t pos = deque->head + deque->count;
+
+	items[(pos >= window_size) ? pos - window_size : pos] = (RollingStatsDequeItem_t){index, value};
+	deque->count++;
+}
+
+
+static inline void rolling_stats_output(filter_acc_t sum, int64_t sum_squares, uint16_t window_size,
+		int16_t min, int16_t max, RollingStatsOutput_t *y)
+{
+	const int64_t n = window_size;
+
+	y->mean = sum / (filter_acc_t)window_size;
+	y->variance = (n * sum_squares - (int64_t)sum * sum) / (n * n);
+	y->min = min;
+	y->max = max;
+}
+
+
+static inline void rolling_stats_get_output(RollingStatsFilter_t *filter, RollingStatsOutput_t *y)
+{
+	rolling_stats_output(filter->sum, filter->sum_squares, filter->window_size,
+			filter->min_deque.items[filter->min_deque.head].value,
+			filter->max_deque.items[filter->max_deque.head].value, y);
+}
@@ -0,0 +1,79 @@
+/*
+ * rolling_stats_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_ROLLING_STATS_FILTER_H_
+#define SRC_MOD_FILTERS_ROLLING_STATS_FILTER_H_
+
+#include "filter.h"
+#include "fifo/FIFO.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct rolling_stats_output {
+	int16_t		mean;
+	int16_t		min;
+	int16_t		max;
+
+	/* Population variance, squared sample units */
+	uint32_t	variance;
+} RollingStatsOutput_t;
+
+
+typedef struct rolling_stats_deque_item {
+	uint32_t	index;
+	int16_t		value;
+} RollingStatsDequeItem_t;
+
+
+/**
+ * Monotonic deque, the front item is the extremum of the window
+ */
+typedef struct rolling_stats_deque {
+	RollingStatsDequeItem_t	*items;
+	uint16_t				head;
+	uint16_t				count;
+} RollingStatsDeque_t;
+
+
+typedef struct rolling_stats_filter {
+
+	uint16_t			window_size;
+
+	filter_acc_t		sum;
+	int64_t				sum_squares;
+
+	RollingStatsDeque_t	min_deque;
+	RollingStatsDeque_t	max_deque;
+
+	/* Index of the next sample */
+	uint32_t			index;
+	uint8_t				initialized;
+
+	FIFO_t				fifo;
+
+} RollingStatsFilter_t;
+
+
+FilterStatus_t  rolling_stats_init(RollingStatsFilter_t *filter, int16_t *buffer, uint16_t window_size);
+FilterStatus_t  rolling_stats_fill_buffer(RollingStatsFilter_t *filter, int16_t *samples, RollingStatsOutput_t *y);
+FilterStatus_t  rolling_stats_filter_sample(RollingStatsFilter_t *filter, int16_t new_sample, RollingStatsOutput_t *y);
+FilterStatus_t  rolling_stats_filter_block(RollingStatsFilter_t *filter, int16_t *data, uint16_t data_len,
+        RollingStatsOutput_t *y, uint16_t *y_len);
+FilterStatus_t  rolling_stats_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+        RollingStatsOutput_t *y, uint16_t *y_len);
+void            rolling_stats_flush(RollingStatsFilter_t *filter);
+void            rolling_stats_deinit(RollingStatsFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_ROLLING_STATS_FILTER_H_ */
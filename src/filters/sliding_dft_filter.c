@@ -0,0 +1,510 @@
+/*
+ * sliding_dft_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call sliding_dft_init(...) on your filter handle with window size, number of channels and list of
+ *              tracked bins. Type selects fixed point or float arithmetic.
+ *      2. Call sliding_dft_filter_sample(...) (sliding_dft_filter_sample_f(...) for float type) on each new frame
+ *              or feed blocks of interleaved frames with sliding_dft_filter_block(...) / _block_f(...).
+ *      3. Call sliding_dft_deinit(...) to release filter memory.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          Call sliding_dft_flush(...)
+ *
+ *  Frame is one sample of every channel. Output is produced once the first window is collected, one item per
+ *  bin and channel: y[bin * channels + channel]. Bin k of window x[0..N-1] (x[0] is the oldest sample) is
+ *  sum of x[i] * exp(-j * 2 * pi * k * i / N), in sample units.
+ *
+ *   Algorithm:
+ *      1. Filter keeps window sums with absolute phase S_k = sum of x[n] * exp(-j * 2 * pi * k * n / N) over the
+ *              last N samples. Expiring sample had the same twiddle, so each sample costs one complex
+ *              multiply-add per bin: S_k += (x_new - x_old) * exp(-j * 2 * pi * k * n / N).
+ *      2. Bin output is S_k rotated by exp(j * 2 * pi * k * (n + 1) / N), i.e. to the phase of the oldest sample.
+ *              Rotation is applied to output only, state is never multiplied, so recursion does not
+ *              accumulate twiddle error.
+ *      3. Fixed point variant adds and later subtracts exactly the same integer products, state is exact and
+ *              never drifts. Twiddles are Q15.
+ *      4. Float variant state accumulates rounding error. With resync enabled (default) a shadow sum of new
+ *              samples only is kept, after every N samples it equals the window sum and replaces the state.
+ *      5. Channels share twiddles, inner loops run over channels, so multi channel blocks vectorize.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sliding_dft_filter.h"
+#include "filter_stats.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static FilterStatus_t sliding_dft_push_frame(SlidingDftFilter_t *filter, const int16_t *frame, int32_t *delta);
+static inline void sliding_dft_advance_phase(SlidingDftFilter_t *filter);
+static inline int32_t sliding_dft_round_q30(int64_t value);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes sliding DFT filter
+ * @param	filter		-	filter handle
+ * @param	type		-	fixed point or float arithmetic
+ * @param	buffer		-	window buffer of window_size * channels samples
+ * @param	window_size	-	DFT length
+ * @param	channels	-	number of channels. Window of all channels must fit 65535 bytes.
+ * @param	bins		-	tracked bins, each less than window_size. Array is not copied and must outlive filter.
+ * @param	bins_num	-	number of tracked bins
+ *
+ * @return	Filter status
+ */
+FilterStatus_t sliding_dft_init(SlidingDftFilter_t *filter, SlidingDftType_t type, int16_t *buffer,
+		uint16_t window_size, uint16_t channels, const uint16_t *bins, uint16_t bins_num)
+{
+	if(window_size == 0 || channels == 0 || bins_num == 0
+			|| (uint32_t)window_size * channels * sizeof(*buffer) > UINT16_MAX)
+	{
+		return FilterError;
+	}
+
+	for(uint16_t b=0; b<bins_num; b++)
+	{
+		if(bins[b] >= window_size)
+		{
+			return FilterError;
+		}
+	}
+
+	memset(filter, 0, sizeof *filter);
+
+	filter->type = type;
+	filter->window_size = window_size;
+	filter->channels = channels;
+	filter->bins = bins;
+	filter->bins_num = bins_num;
+	filter->resync_enabled = 1;
+
+	const uint32_t state_len = (uint32_t)bins_num * channels;
+	uint8_t allocated;
+
+	filter->phase = _malloc(bins_num * sizeof *filter->phase);
+
+	if(type == SlidingDftFixed)
+	{
+		filter->cos_q15 = _malloc(window_size * sizeof *filter->cos_q15);
+		filter->sin_q15 = _malloc(window_size * sizeof *filter->sin_q15);
+		filter->acc_re = _malloc(state_len * sizeof *filter->acc_re);
+		filter->acc_im = _malloc(state_len * sizeof *filter->acc_im);
+
+		allocated = filter->cos_q15 && filter->sin_q15 && filter->acc_re && filter->acc_im;
+	}
+	else
+	{
+		filter->cos_f = _malloc(window_size * sizeof *filter->cos_f);
+		filter->sin_f = _malloc(window_size * sizeof *filter->sin_f);
+		filter->acc_re_f = _malloc(state_len * sizeof *filter->acc_re_f);
+		filter->acc_im_f = _malloc(state_len * sizeof *filter->acc_im_f);
+		filter->shadow_re = _malloc(state_len * sizeof *filter->shadow_re);
+		filter->shadow_im = _malloc(state_len * sizeof *filter->shadow_im);
+
+		allocated = filter->cos_f && filter->sin_f && filter->acc_re_f && filter->acc_im_f
+				&& filter->shadow_re && filter->shadow_im;
+	}
+
+	if(!allocated || filter->phase == NULL)
+	{
+		sliding_dft_deinit(filter);
+		return FilterError;
+	}
+
+	for(uint32_t i=0; i<window_size; i++)
+	{
+		double angle = 2.0 * FILTER_PI * i / window_size;
+
+		if(type == SlidingDftFixed)
+		{
+			filter->cos_q15[i] = (int16_t)lround(32767.0 * cos(angle));
+			filter->sin_q15[i] = (int16_t)lround(32767.0 * sin(angle));
+		}
+		else
+		{
+			filter->cos_f[i] = (float)cos(angle);
+			filter->sin_f[i] = (float)sin(angle);
+		}
+	}
+
+	FIFO_init(&filter->fifo, (uint8_t*)buffer, window_size, channels * sizeof(*buffer), FIFO_LOOP);
+	sliding_dft_flush(filter);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Processes one frame, fixed point type.
+ *
+ * @param[in]	    filter	-	filter handle
+ * @param[in]       frame   -   one sample of every channel
+ * @param[out]  	y	    -	bins_num * channels bins. Written only if ready.
+ * @param[out]  	ready	-	set to 1 when window is collected and y is written.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t sliding_dft_filter_sample(SlidingDftFilter_t *filter, const int16_t *frame, SlidingDftBin_t *y,
+		uint8_t *ready)
+{
+	const uint16_t channels = filter->channels;
+	int32_t delta[channels];
+
+	if(filter->type != SlidingDftFixed || sliding_dft_push_frame(filter, frame, delta) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	for(uint16_t b=0; b<filter->bins_num; b++)
+	{
+		const int64_t c = filter->cos_q15[filter->phase[b]];
+		const int64_t s = filter->sin_q15[filter->phase[b]];
+
+		int64_t *re = &filter->acc_re[b * channels];
+		int64_t *im = &filter->acc_im[b * channels];
+
+		for(uint16_t ch=0; ch<channels; ch++)
+		{
+			re[ch] += delta[ch] * c;
+			im[ch] -= delta[ch] * s;
+		}
+	}
+
+	sliding_dft_advance_phase(filter);
+
+	*ready = filter->initialized;
+	if(!filter->initialized)
+	{
+		return FilterOK;
+	}
+
+	for(uint16_t b=0; b<filter->bins_num; b++)
+	{
+		const int64_t c = filter->cos_q15[filter->phase[b]];
+		const int64_t s = filter->sin_q15[filter->phase[b]];
+
+		const int64_t *re = &filter->acc_re[b * channels];
+		const int64_t *im = &filter->acc_im[b * channels];
+		SlidingDftBin_t *out = &y[b * channels];
+
+		for(uint16_t ch=0; ch<channels; ch++)
+		{
+			out[ch].re = sliding_dft_round_q30(re[ch] * c - im[ch] * s);
+			out[ch].im = sliding_dft_round_q30(re[ch] * s + im[ch] * c);
+		}
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Processes one frame, float type.
+ *
+ * @param[in]	    filter	-	filter handle
+ * @param[in]       frame   -   one sample of every channel
+ * @param[out]  	y	    -	bins_num * channels bins. Written only if ready.
+ * @param[out]  	ready	-	set to 1 when window is collected and y is written.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t sliding_dft_filter_sample_f(SlidingDftFilter_t *filter, const int16_t *frame, SlidingDftBinF_t *y,
+		uint8_t *ready)
+{
+	const uint16_t channels = filter->channels;
+	int32_t delta[channels];
+
+	if(filter->type != SlidingDftFloat || sliding_dft_push_frame(filter, frame, delta) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	const uint8_t resync = filter->resync_enabled && (filter->resync_pos + 1 == filter->window_size);
+
+	for(uint16_t b=0; b<filter->bins_num; b++)
+	{
+		const float c = filter->cos_f[filter->phase[b]];
+		const float s = filter->sin_f[filter->phase[b]];
+
+		float *re = &filter->acc_re_f[b * channels];
+		float *im = &filter->acc_im_f[b * channels];
+
+		for(uint16_t ch=0; ch<channels; ch++)
+		{
+			re[ch] += delta[ch] * c;
+			im[ch] -= delta[ch] * s;
+		}
+
+		if(filter->resync_enabled)
+		{
+			float *shadow_re = &filter->shadow_re[b * channels];
+			float *shadow_im = &filter->shadow_im[b * channels];
+
+			for(uint16_t ch=0; ch<channels; ch++)
+			{
+				shadow_re[ch] += frame[ch] * c;
+				shadow_im[ch] -= frame[ch] * s;
+			}
+
+			/* Shadow holds exactly the last window_size samples */
+			if(resync)
+			{
+				memcpy(re, shadow_re, channels * sizeof *re);
+				memcpy(im, shadow_im, channels * sizeof *im);
+				memset(shadow_re, 0, channels * sizeof *shadow_re);
+				memset(shadow_im, 0, channels * sizeof *shadow_im);
+			}
+		}
+	}
+
+	if(filter->resync_enabled)
+	{
+		filter->resync_pos = resync ? 0 : filter->resync_pos + 1;
+		filter->resync_count += resync;
+	}
+
+	sliding_dft_advance_phase(filter);
+
+	*ready = filter->initialized;
+	if(!filter->initialized)
+	{
+		return FilterOK;
+	}
+
+	for(uint16_t b=0; b<filter->bins_num; b++)
+	{
+		const float c = filter->cos_f[filter->phase[b]];
+		const float s = filter->sin_f[filter->phase[b]];
+
+		const float *re = &filter->acc_re_f[b * channels];
+		const float *im = &filter->acc_im_f[b * channels];
+		SlidingDftBinF_t *out = &y[b * channels];
+
+		for(uint16_t ch=0; ch<channels; ch++)
+		{
+			out[ch].re = re[ch] * c - im[ch] * s;
+			out[ch].im = re[ch] * s + im[ch] * c;
+		}
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Processes block of interleaved frames, fixed point type.
+ * @note        While the first window is not collected input frames produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   frames      -   frames_num * channels interleaved samples
+ * @param[in]   frames_num  -   number of frames
+ * @param[out]  y           -   bins_num * channels bins per produced frame. Must hold frames_num frames.
+ * @param[out]  y_len       -   number of produced frames.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t sliding_dft_filter_block(SlidingDftFilter_t *filter, const int16_t *frames, uint16_t frames_num,
+		SlidingDftBin_t *y, uint16_t *y_len)
+{
+	const uint32_t frame_bins = (uint32_t)filter->bins_num * filter->channels;
+	uint16_t produced = 0;
+	uint8_t ready;
+
+	for(uint16_t i=0; i<frames_num; i++)
+	{
+		if(sliding_dft_filter_sample(filter, &frames[i * filter->channels], &y[produced * frame_bins], &ready)
+				!= FilterOK)
+		{
+			return FilterError;
+		}
+
+		produced += ready;
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Processes block of interleaved frames, float type. See sliding_dft_filter_block(...).
+ */
+FilterStatus_t sliding_dft_filter_block_f(SlidingDftFilter_t *filter, const int16_t *frames, uint16_t frames_num,
+		SlidingDftBinF_t *y, uint16_t *y_len)
+{
+	const uint32_t frame_bins = (uint32_t)filter->bins_num * filter->channels;
+	uint16_t produced = 0;
+	uint8_t ready;
+
+	for(uint16_t i=0; i<frames_num; i++)
+	{
+		if(sliding_dft_filter_sample_f(filter, &frames[i * filter->channels], &y[produced * frame_bins], &ready)
+				!= FilterOK)
+		{
+			return FilterError;
+		}
+
+		produced += ready;
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Enables or disables shadow resync of float variant. Fixed point variant is exact and ignores it.
+ * @note	Resync is enabled after init. Shadow sum starts from the next window boundary after enabling.
+ */
+void sliding_dft_set_resync(SlidingDftFilter_t *filter, uint8_t enable)
+{
+	if(filter->type != SlidingDftFloat || filter->resync_enabled == !!enable)
+	{
+		return;
+	}
+
+	filter->resync_enabled = !!enable;
+	filter->resync_pos = 0;
+
+	uint32_t state_len = (uint32_t)filter->bins_num * filter->channels;
+	memset(filter->shadow_re, 0, state_len * sizeof *filter->shadow_re);
+	memset(filter->shadow_im, 0, state_len * sizeof *filter->shadow_im);
+
+	/* Shadow must cover a whole window, so it starts with the window itself */
+	if(enable)
+	{
+		filter->resync_pos = FIFO_get_data_count(&filter->fifo) % filter->window_size;
+
+		if(filter->resync_pos != 0)
+		{
+			memcpy(filter->shadow_re, filter->acc_re_f, state_len * sizeof *filter->shadow_re);
+			memcpy(filter->shadow_im, filter->acc_im_f, state_len * sizeof *filter->shadow_im);
+		}
+	}
+}
+
+
+uint32_t sliding_dft_get_resync_count(SlidingDftFilter_t *filter)
+{
+	return filter->resync_count;
+}
+
+
+void sliding_dft_flush(SlidingDftFilter_t *filter)
+{
+	const uint32_t state_len = (uint32_t)filter->bins_num * filter->channels;
+
+	FIFO_flush(&filter->fifo);
+
+	if(filter->type == SlidingDftFixed)
+	{
+		memset(filter->acc_re, 0, state_len * sizeof *filter->acc_re);
+		memset(filter->acc_im, 0, state_len * sizeof *filter->acc_im);
+	}
+	else
+	{
+		memset(filter->acc_re_f, 0, state_len * sizeof *filter->acc_re_f);
+		memset(filter->acc_im_f, 0, state_len * sizeof *filter->acc_im_f);
+		memset(filter->shadow_re, 0, state_len * sizeof *filter->shadow_re);
+		memset(filter->shadow_im, 0, state_len * sizeof *filter->shadow_im);
+	}
+
+	memset(filter->phase, 0, filter->bins_num * sizeof *filter->phase);
+
+	filter->resync_pos = 0;
+	filter->initialized = 0;
+}
+
+
+void sliding_dft_deinit(SlidingDftFilter_t *filter)
+{
+	_free(filter->phase);
+	_free(filter->cos_q15);
+	_free(filter->sin_q15);
+	_free(filter->cos_f);
+	_free(filter->sin_f);
+	_free(filter->acc_re);
+	_free(filter->acc_im);
+	_free(filter->acc_re_f);
+	_free(filter->acc_im_f);
+	_free(filter->shadow_re);
+	_free(filter->shadow_im);
+
+	memset(filter, 0, sizeof *filter);
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Replaces the oldest frame of window with the new one.
+ *
+ * @param	filter	-	filter handle
+ * @param	frame	-	new frame
+ * @param	delta	-	new minus expiring sample of every channel. Expiring sample is 0 until window is full.
+ *
+ * @return	Filter error status
+ */
+static FilterStatus_t sliding_dft_push_frame(SlidingDftFilter_t *filter, const int16_t *frame, int32_t *delta)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	int16_t last_frame[filter->channels];
+
+	if(FIFO_get_data_count(fifo_ptr) == filter->window_size)
+	{
+		if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, last_frame, 1, NULL)) != FIFO_OK)
+		{
+			return FilterError;
+		}
+	}
+	else
+	{
+		memset(last_frame, 0, sizeof last_frame);
+	}
+
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, (void*)frame, 1, NULL)) != FIFO_OK)
+	{
+		return FilterError;
+	}
+
+	for(uint16_t ch=0; ch<filter->channels; ch++)
+	{
+		delta[ch] = (int32_t)frame[ch] - last_frame[ch];
+	}
+
+	filter->initialized = (FIFO_get_data_count(fifo_ptr) == filter->window_size);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Moves twiddle index of every bin to the next sample.
+ */
+static inline void sliding_dft_advance_phase(SlidingDftFilter_t *filter)
+{
+	for(uint16_t b=0; b<filter->bins_num; b++)
+	{
+		uint32_t phase = filter->phase[b] + filter->bins[b];
+
+		filter->phase[b] = (phase >= filter->window_size) ? phase - filter->window_size : phase;
+	}
+}
+
+
+static inline int32_t sliding_dft_round_q30(int64_t value)
+{
+	return (int32_t)((value + (1ll << 29)) >> 30);
+}
@@ -0,0 +1,96 @@
+/*
+ * sliding_dft_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_SLIDING_DFT_FILTER_H_
+#define SRC_MOD_FILTERS_SLIDING_DFT_FILTER_H_
+
+#include "filter.h"
+#include "fifo/FIFO.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef enum {SlidingDftFixed=0, SlidingDftFloat} SlidingDftType_t;
+
+
+/**
+ * Bin value in sample units, i.e. DC bin of constant x is window_size * x
+ */
+typedef struct sliding_dft_bin {
+	int32_t		re;
+	int32_t		im;
+} SlidingDftBin_t;
+
+
+typedef struct sliding_dft_bin_f {
+	float		re;
+	float		im;
+} SlidingDftBinF_t;
+
+
+typedef struct sliding_dft_filter {
+
+	SlidingDftType_t	type;
+	uint16_t			window_size;
+	uint16_t			channels;
+
+	const uint16_t		*bins;
+	uint16_t			bins_num;
+
+	/* Twiddle index of every bin for the next sample, k * n mod window_size */
+	uint16_t			*phase;
+
+	/* cos and sin of 2 * pi * i / window_size, Q15 or float */
+	int16_t				*cos_q15;
+	int16_t				*sin_q15;
+	float				*cos_f;
+	float				*sin_f;
+
+	/* Window sums with absolute phase, bins_num * channels items each. Q15 or float. */
+	int64_t				*acc_re;
+	int64_t				*acc_im;
+	float				*acc_re_f;
+	float				*acc_im_f;
+
+	/* Float variant resync */
+	uint8_t				resync_enabled;
+	uint16_t			resync_pos;
+	uint32_t			resync_count;
+	float				*shadow_re;
+	float				*shadow_im;
+
+	uint8_t				initialized;
+
+	/* Window of frames, one frame is one sample of every channel */
+	FIFO_t				fifo;
+
+} SlidingDftFilter_t;
+
+
+FilterStatus_t  sliding_dft_init(SlidingDftFilter_t *filter, SlidingDftType_t type, int16_t *buffer,
+        uint16_t window_size, uint16_t channels, const uint16_t *bins, uint16_t bins_num);
+FilterStatus_t  sliding_dft_filter_sample(SlidingDftFilter_t *filter, const int16_t *frame, SlidingDftBin_t *y,
+        uint8_t *ready);
+FilterStatus_t  sliding_dft_filter_sample_f(SlidingDftFilter_t *filter, const int16_t *frame, SlidingDftBinF_t *y,
+        uint8_t *ready);
+FilterStatus_t  sliding_dft_filter_block(SlidingDftFilter_t *filter, const int16_t *frames, uint16_t frames_num,
+        SlidingDftBin_t *y, uint16_t *y_len);
+FilterStatus_t  sliding_dft_filter_block_f(SlidingDftFilter_t *filter, const int16_t *frames, uint16_t frames_num,
+        SlidingDftBinF_t *y, uint16_t *y_len);
+void            sliding_dft_set_resync(SlidingDftFilter_t *filter, uint8_t enable);
+uint32_t        sliding_dft_get_resync_count(SlidingDftFilter_t *filter);
+void            sliding_dft_flush(SlidingDftFilter_t *filter);
+void            sliding_dft_deinit(SlidingDftFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_SLIDING_DFT_FILTER_H_ */
@@ -0,0 +1,227 @@
+/*
+ * sort_network.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Branchless sorting networks. Optimal ones for small odd sizes and Batcher odd-even merge sort for any size.
+ *
+ *  USAGE:
+ *      1. Get network with sort_network_get(...). NULL is returned if there is no network of given size.
+ *          Or generate one of any size with sort_network_init_batcher(...) and release it with
+ *          sort_network_deinit(...) when it is not needed.
+ *      2. Put i-th item of every sequence into lanes[i][lane] and call sort_network_sort_lanes(...).
+ *          After that lanes[r][lane] holds item with rank r of every sequence.
+ *
+ *      Single sequence can be sorted with sort_network_sort(...).
+ *
+ *  Batcher network:
+ *      Odd-even merge sort of the next power of two size with comparators touching items past size removed.
+ *      Removed items may be thought of as +infinity which never move, so the rest is still sorted.
+ *      Network has about size * log2(size)^2 / 4 comparators.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sort_network.h"
+
+
+#define SORT_NETWORK_MIN(a, b)  (((a) < (b)) ? (a) : (b))
+#define SORT_NETWORK_MAX(a, b)  (((a) < (b)) ? (b) : (a))
+
+
+/* Optimal size networks */
+static const uint16_t sort_network_3[][2] = {
+        {1,2}, {0,2}, {0,1}
+};
+
+static const uint16_t sort_network_5[][2] = {
+        {0,1}, {3,4}, {2,4}, {2,3}, {0,3}, {0,2}, {1,4}, {1,3}, {1,2}
+};
+
+static const uint16_t sort_network_7[][2] = {
+        {0,6}, {2,3}, {4,5}, {0,2}, {1,4}, {3,6}, {0,1}, {2,5},
+        {3,4}, {1,2}, {4,6}, {2,3}, {4,5}, {1,2}, {3,4}, {5,6}
+};
+
+static const uint16_t sort_network_9[][2] = {
+        {0,3}, {1,7}, {2,5}, {4,8}, {0,7}, {2,4}, {3,8}, {5,6}, {0,2},
+        {1,3}, {4,5}, {7,8}, {1,4}, {3,6}, {5,7}, {0,1}, {2,4}, {3,5},
+        {6,8}, {2,3}, {4,5}, {6,7}, {1,2}, {3,4}, {5,6}
+};
+
+
+#define SORT_NETWORK_DEF(n)     {sort_network_##n, sizeof(sort_network_##n) / sizeof(sort_network_##n[0]), n}
+
+static const SortNetwork_t sort_networks[] = {
+        SORT_NETWORK_DEF(3),
+        SORT_NETWORK_DEF(5),
+        SORT_NETWORK_DEF(7),
+        SORT_NETWORK_DEF(9)
+};
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static uint32_t sort_network_batcher_comparators(uint16_t size, uint16_t (*comparators)[2]);
+static inline void sort_network_compare_lanes(int16_t * restrict a, int16_t * restrict b);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief       Returns sorting network of given size.
+ *
+ * @param[in]   size    -   number of items to be sorted
+ *
+ * @return      Network or NULL if there is no network of this size.
+ */
+const SortNetwork_t *sort_network_get(uint16_t size)
+{
+    for(uint32_t i=0; i<sizeof(sort_networks)/sizeof(sort_networks[0]); i++)
+    {
+        if(sort_networks[i].size == size)
+        {
+            return &sort_networks[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief       Generates Batcher odd-even merge sort network of any size.
+ *
+ * @param[out]  network -   network handle
+ * @param[in]   size    -   number of items to be sorted
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t sort_network_init_batcher(SortNetwork_t *network, uint16_t size)
+{
+    uint32_t comparators_num = sort_network_batcher_comparators(size, NULL);
+    uint16_t (*comparators)[2] = NULL;
+
+    if(comparators_num != 0)
+    {
+        comparators = _malloc(comparators_num * sizeof *comparators);
+        if(comparators == NULL)
+        {
+            return FilterError;
+        }
+
+        sort_network_batcher_comparators(size, comparators);
+    }
+
+    network->comparators = (const uint16_t (*)[2])comparators;
+    network->comparators_num = comparators_num;
+    network->size = size;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Releases network generated with sort_network_init_batcher(...).
+ */
+void sort_network_deinit(SortNetwork_t *network)
+{
+    _free((void*)network->comparators);
+
+    network->comparators = NULL;
+    network->comparators_num = 0;
+}
+
+
+/**
+ * @brief       Sorts SORT_NETWORK_LANES sequences at once.
+ *
+ * @param[in]   network -   sorting network
+ * @param[in]   lanes   -   lanes[i][l] is the i-th item of sequence l. Must have network->size rows.
+ */
+void sort_network_sort_lanes(const SortNetwork_t *network, int16_t lanes[][SORT_NETWORK_LANES])
+{
+    for(uint32_t c=0; c<network->comparators_num; c++)
+    {
+        sort_network_compare_lanes(lanes[network->comparators[c][0]], lanes[network->comparators[c][1]]);
+    }
+}
+
+
+/**
+ * @brief       Sorts one sequence in place.
+ *
+ * @param[in]   network -   sorting network
+ * @param[in]   data    -   sequence of network->size items
+ */
+void sort_network_sort(const SortNetwork_t *network, int16_t *data)
+{
+    for(uint32_t c=0; c<network->comparators_num; c++)
+    {
+        int16_t a = data[network->comparators[c][0]];
+        int16_t b = data[network->comparators[c][1]];
+
+        data[network->comparators[c][0]] = SORT_NETWORK_MIN(a, b);
+        data[network->comparators[c][1]] = SORT_NETWORK_MAX(a, b);
+    }
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief       Walks Batcher odd-even merge sort comparators of given size.
+ *
+ * @param[in]   size        -   number of items to be sorted
+ * @param[out]  comparators -   where comparators are written. NULL to count them only.
+ *
+ * @return      Number of comparators
+ */
+static uint32_t sort_network_batcher_comparators(uint16_t size, uint16_t (*comparators)[2])
+{
+    uint32_t num = 0;
+
+    /* Merges sorted runs of p items into runs of 2p, k is comparator distance within the merge */
+    for(uint32_t p=1; p<size; p<<=1)
+    {
+        for(uint32_t k=p; k>=1; k>>=1)
+        {
+            for(uint32_t j=k%p; j+k<size; j+=2*k)
+            {
+                for(uint32_t i=0; i<k && i+j+k<size; i++)
+                {
+                    /* Only items of the same run pair are compared */
+                    if((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                    {
+                        if(comparators != NULL)
+                        {
+                            comparators[num][0] = i + j;
+                            comparators[num][1] = i + j + k;
+                        }
+
+                        num++;
+                    }
+                }
+            }
+        }
+    }
+
+    return num;
+}
+
+
+/**
+ * @brief       Comparator applied to all lanes. Rows never alias so loop is vectorized.
+ */
+static inline void sort_network_compare_lanes(int16_t * restrict a, int16_t * restrict b)
+{
+    for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+    {
+        int16_t lo = SORT_NETWORK_MIN(a[l], b[l]);
+        int16_t hi = SORT_NETWORK_MAX(a[l], b[l]);
+
+        a[l] = lo;
+        b[l] = hi;
+    }
+}
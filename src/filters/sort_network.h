@@ -0,0 +1,50 @@
+/*
+ * sort_network.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_SORT_NETWORK_H_
+#define SRC_MOD_FILTERS_SORT_NETWORK_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Number of independent sequences sorted at once. Every comparator is applied to all lanes
+ * with min/max which compiler turns into SIMD instructions.
+ */
+#define SORT_NETWORK_LANES      16
+
+/**
+ * The largest size with known network. Larger networks are generated with sort_network_init_batcher
+ */
+#define SORT_NETWORK_MAX_SIZE   9
+
+
+typedef struct sort_network {
+    const uint16_t  (*comparators)[2];
+    uint32_t        comparators_num;
+    uint16_t        size;
+} SortNetwork_t;
+
+
+const SortNetwork_t *sort_network_get(uint16_t size);
+FilterStatus_t  sort_network_init_batcher(SortNetwork_t *network, uint16_t size);
+void            sort_network_deinit(SortNetwork_t *network);
+void            sort_network_sort_lanes(const SortNetwork_t *network, int16_t lanes[][SORT_NETWORK_LANES]);
+void            sort_network_sort(const SortNetwork_t *network, int16_t *data);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_SORT_NETWORK_H_ */
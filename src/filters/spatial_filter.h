@@ -0,0 +1,35 @@
+/*
+ * spatial_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_SPATIAL_FILTER_H_
+#define SRC_MOD_FILTERS_SPATIAL_FILTER_H_
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * The largest number of channels sorted with generated Batcher network. Its comparators take about 94 KB,
+ * larger frames are sorted with qsort.
+ */
+#define SPATIAL_FILTER_NETWORK_MAX_CHANNELS		1024
+
+
+FilterStatus_t  spatial_filter_rank(const int16_t *frames, uint32_t frames_num, uint16_t channels, uint16_t rank,
+        int16_t *y);
+FilterStatus_t  spatial_filter_median(const int16_t *frames, uint32_t frames_num, uint16_t channels, int16_t *y);
+FilterStatus_t  spatial_filter_mean(const int16_t *frames, uint32_t frames_num, uint16_t channels, int16_t *y);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_SPATIAL_FILTER_H_ */
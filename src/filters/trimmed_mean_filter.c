@@ -0,0 +1,324 @@
+/*
+ * trimmed_mean_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call trimmed_mean_init(...) on your filter handle
+ *      2. Call trimmed_mean_fill_buffer(...) when you collected enough samples(equal to window size)
+ *              to compute the first sample.
+ *      3. Call trimmed_mean_filter_sample(...) on each new sample.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          4.1 Call trimmed_mean_flush(...)
+ *
+ *      After that you have to fill buffer again with:
+ *          4.2 trimmed_mean_fill_buffer(...) before sampling.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with trimmed_mean_filter_block(...).
+ *  It collects the first window itself and outputs one sample per input sample after that.
+ *
+ *  You can also filter prepared sequence with trimmed_mean_filter_sequence(...).
+ *
+ *  Trim 0 gives moving average, trim (window_size - 1) / 2 with odd window gives median.
+ *
+ *   Algorithm:
+ *      1. Sorted window is maintained by rank filter.
+ *      2. Filter keeps sum of sorted window samples with ranks [trim, window_size - trim - 1].
+ *      3. Rank filter reports position p the old sample was removed from and position q the new sample
+ *              was inserted to. Samples between p and q shift by one, so at most one sample crosses
+ *              each trim boundary. Central sum is corrected by those samples only.
+ *      4. Returns central sum divided by window_size - 2 * trim.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "trimmed_mean_filter.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static void trimmed_mean_compute_central_sum(TrimmedMeanFilter_t *filter);
+static inline filter_acc_t trimmed_mean_central_delta(const int16_t *sorted_window, uint16_t low, uint16_t high,
+		int16_t last_sample, int16_t new_sample, uint16_t removed_pos, uint16_t inserted_pos);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes trimmed mean filter
+ * @param	filter		-	filter handle
+ * @param 	buffer		-	buffer with incoming data. Length of buffer must match window size.
+ * @param	window_size	-	filter window size
+ * @param	trim		-	number of samples trimmed from each side of sorted window.
+ * 							Must be less than window_size / 2.
+ *
+ * @return	Filter status
+ */
+FilterStatus_t trimmed_mean_init(TrimmedMeanFilter_t *filter, int16_t *buffer, uint16_t window_size, uint16_t trim)
+{
+	if(2*(uint32_t)trim >= window_size)
+	{
+		return FilterError;
+	}
+
+	filter->trim = trim;
+	filter->central_sum = 0;
+
+	return rank_filter_init(&filter->rank_filter, buffer, window_size, trim);
+}
+
+
+/**
+ * @brief       Fill filter buffer for the first time
+ *
+ * @param[in]   filter  -   filter handle
+ * @param[in]   samples -   samples to be written. Length must match filter window size
+ * @param[out]  y       -   pointer where sample will be stored.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t trimmed_mean_fill_buffer(TrimmedMeanFilter_t *filter, int16_t *samples, int16_t *y)
+{
+	if(rank_filter_fill_buffer(&filter->rank_filter, samples, NULL) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	trimmed_mean_compute_central_sum(filter);
+	*y = filter->central_sum / (filter_acc_t)(filter->rank_filter.window_size - 2*filter->trim);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	    Computes the next filtered sample.
+ * @note	    Costs one rank filter update and O(1) on top of it.
+ *
+ * @param[in]	filter	    -   filter handle
+ * @param[in]   new_sample  -   new sample to be written
+ * @param[out]	y	        -	pointer to where filtered sample will be written.
+ *
+ * @return	    Filter error status
+ */
+FilterStatus_t trimmed_mean_filter_sample(TrimmedMeanFilter_t *filter, int16_t new_sample, int16_t *y)
+{
+	RankFilter_t *rank_filter = &filter->rank_filter;
+	uint16_t window_size = rank_filter->window_size;
+	uint16_t trim = filter->trim;
+
+	int16_t last_sample;
+	uint16_t removed_pos, inserted_pos;
+
+	if(rank_filter_replace_sample(rank_filter, new_sample, &last_sample, &removed_pos, &inserted_pos) != FilterOK)
+	{
+		return FilterError;
+	}
+
+	filter->central_sum += trimmed_mean_central_delta(rank_filter->sorted_window, trim, window_size - trim - 1,
+			last_sample, new_sample, removed_pos, inserted_pos);
+
+	*y = filter->central_sum / (filter_acc_t)(window_size - 2*trim);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with trimmed_mean_fill_buffer. While the first window is not
+ *                  collected input samples produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t trimmed_mean_filter_block(TrimmedMeanFilter_t *filter, int16_t *data, uint16_t data_len,
+		int16_t *y, uint16_t *y_len)
+{
+	RankFilter_t *rank_filter = &filter->rank_filter;
+	uint16_t produced = 0;
+	uint16_t i = 0;
+
+	/* Collect the first window */
+	while(i < data_len && !rank_filter->initialized)
+	{
+		int16_t rank_sample;
+		uint16_t rank_len;
+
+		if(rank_filter_filter_block(rank_filter, &data[i++], 1, &rank_sample, &rank_len) != FilterOK)
+		{
+			return FilterError;
+		}
+
+		if(rank_len != 0)
+		{
+			trimmed_mean_compute_central_sum(filter);
+			y[produced++] = filter->central_sum / (filter_acc_t)(rank_filter->window_size - 2*filter->trim);
+		}
+	}
+
+	for(; i<data_len; i++)
+	{
+		if(trimmed_mean_filter_sample(filter, data[i], &y[produced++]) != FilterOK)
+		{
+			return FilterError;
+		}
+	}
+
+	*y_len = produced;
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Performs trimmed mean filtering of a simple buffer.
+ *
+ * @param[in]   data        -   data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   filter window size
+ * @param[in]   trim        -   number of samples trimmed from each side of sorted window
+ * @param[out]  y           -   pointer where output data will be stored.
+ * @param[out]  y_len       -   output data length
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t trimmed_mean_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+		uint16_t trim, int16_t *y, uint16_t *y_len)
+{
+	if(2*(uint32_t)trim >= window_size || window_size > data_size)
+	{
+		return FilterError;
+	}
+
+	const uint16_t low = trim;
+	const uint16_t high = window_size - trim - 1;
+	const filter_acc_t central_size = window_size - 2*trim;
+
+	uint16_t filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+	int16_t sorted_window[window_size];
+	filter_acc_t central_sum = 0;
+
+	memcpy(sorted_window, data, window_size * sizeof *data);
+	qsort(sorted_window, window_size, sizeof *sorted_window, filter_sort_cmp);
+
+	for(uint16_t r=low; r<=high; r++)
+	{
+		central_sum += sorted_window[r];
+	}
+
+	y[0] = central_sum / central_size;
+
+	for(uint16_t i=1; i<filtered_len; i++)
+	{
+		int16_t last_sample = data[i-1];
+		int16_t new_sample = data[i+window_size-1];
+		uint16_t removed_pos, inserted_pos;
+
+		rank_filter_window_update(sorted_window, window_size, last_sample, new_sample, &removed_pos, &inserted_pos);
+
+		central_sum += trimmed_mean_central_delta(sorted_window, low, high, last_sample, new_sample,
+				removed_pos, inserted_pos);
+		y[i] = central_sum / central_size;
+	}
+
+	*y_len = filtered_len;
+
+	return FilterOK;
+}
+
+
+void trimmed_mean_flush(TrimmedMeanFilter_t *filter)
+{
+	rank_filter_flush(&filter->rank_filter);
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Sums central ranks of freshly sorted window.
+ */
+static void trimmed_mean_compute_central_sum(TrimmedMeanFilter_t *filter)
+{
+	const int16_t *sorted_window = filter->rank_filter.sorted_window;
+	uint16_t high = filter->rank_filter.window_size - filter->trim - 1;
+	filter_acc_t sum = 0;
+
+	for(uint16_t r=filter->trim; r<=high; r++)
+	{
+		sum += sorted_window[r];
+	}
+
+	filter->central_sum = sum;
+}
+
+
+/**
+ * @brief	Returns change of sum of ranks [low, high] after one sorted window update.
+ * @note	Before update samples were a[], after update they are b[]. If p < q then b[i] = a[i+1] for p <= i < q,
+ * 				if p > q then b[i] = a[i-1] for q < i <= p. Sum of shifted samples inside of [low, high]
+ * 				telescopes, so only samples at the range edges are needed. They are taken from b[] or
+ * 				are the removed sample itself.
+ *
+ * @param	sorted_window	-	window after update
+ * @param	low				-	the lowest central rank
+ * @param	high			-	the highest central rank
+ * @param	last_sample		-	removed sample
+ * @param	new_sample		-	inserted sample
+ * @param	removed_pos		-	position p of removed sample before update
+ * @param	inserted_pos	-	position q of inserted sample after update
+ *
+ * @return	Central sum change
+ */
+static inline filter_acc_t trimmed_mean_central_delta(const int16_t *sorted_window, uint16_t low, uint16_t high,
+		int16_t last_sample, int16_t new_sample, uint16_t removed_pos, uint16_t inserted_pos)
+{
+	filter_acc_t leaving;
+
+	if(removed_pos < inserted_pos)
+	{
+		if(inserted_pos < low)
+		{
+			return 0;
+		}
+
+		/* Sample leaving central range through its low edge */
+		leaving = (removed_pos >= low) ? last_sample : sorted_window[low-1];
+
+		if(inserted_pos <= high)
+		{
+			return (filter_acc_t)new_sample - leaving;
+		}
+
+		return (removed_pos <= high) ? (filter_acc_t)sorted_window[high] - leaving : 0;
+	}
+	else if(removed_pos > inserted_pos)
+	{
+		if(inserted_pos > high)
+		{
+			return 0;
+		}
+
+		/* Sample leaving central range through its high edge */
+		leaving = (removed_pos <= high) ? last_sample : sorted_window[high+1];
+
+		if(inserted_pos >= low)
+		{
+			return (filter_acc_t)new_sample - leaving;
+		}
+
+		return (removed_pos >= low) ? (filter_acc_t)sorted_window[low] - leaving : 0;
+	}
+
+	return (removed_pos >= low && removed_pos <= high) ? (filter_acc_t)new_sample - last_sample : 0;
+}
@@ -0,0 +1,44 @@
+/*
+ * trimmed_mean_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_TRIMMED_MEAN_FILTER_H_
+#define SRC_MOD_FILTERS_TRIMMED_MEAN_FILTER_H_
+
+#include "filter.h"
+#include "rank_filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct trimmed_mean_filter {
+
+	RankFilter_t		rank_filter;
+
+	/* Number of samples trimmed from each side of sorted window */
+	uint16_t			trim;
+	filter_acc_t		central_sum;
+
+} TrimmedMeanFilter_t;
+
+
+FilterStatus_t  trimmed_mean_init(TrimmedMeanFilter_t *filter, int16_t *buffer, uint16_t window_size, uint16_t trim);
+FilterStatus_t  trimmed_mean_fill_buffer(TrimmedMeanFilter_t *filter, int16_t *samples, int16_t *y);
+FilterStatus_t  trimmed_mean_filter_sample(TrimmedMeanFilter_t *filter, int16_t new_sample, int16_t *y);
+FilterStatus_t  trimmed_mean_filter_block(TrimmedMeanFilter_t *filter, int16_t *data, uint16_t data_len,
+        int16_t *y, uint16_t *y_len);
+FilterStatus_t  trimmed_mean_filter_sequence(int16_t *data, uint16_t data_size, uint16_t window_size,
+        uint16_t trim, int16_t *y, uint16_t *y_len);
+void            trimmed_mean_flush(TrimmedMeanFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_TRIMMED_MEAN_FILTER_H_ */
@@ -0,0 +1,274 @@
+/*
+ * wavelet_index.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Allocate (or map) wavelet_index_get_blob_size(...) bytes, 8 bytes aligned.
+ *      2. Call wavelet_index_build(...) on stored data. Index does not reference data after that.
+ *      3. Query k-th smallest sample of any range [begin, end) with wavelet_index_range_quantile(...).
+ *              Median of the range is k = (end - begin - 1) / 2.
+ *
+ *  Blob is position independent and holds the whole index. It can be written to a file as is and later
+ *  memory mapped and passed to wavelet_index_attach(...), which only checks header and sets pointers.
+ *  Blob uses native byte order.
+ *
+ *   Algorithm:
+ *      Wavelet matrix over 16 bit keys. Sample x is stored as key x ^ 0x8000, so keys have the same order.
+ *      1. Level l holds bit (15 - l) of every key. Keys are then stably partitioned by that bit, zeros first,
+ *              and the next level is built over the partitioned sequence. Build costs O(n * 16).
+ *      2. Rank of ones before any position costs one lookup of cumulative count and one popcount.
+ *      3. Query descends 16 levels. At each level range is mapped to zeros or ones partition depending on
+ *              whether k is less than number of zeros in range. Query costs O(16) ranks.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wavelet_index.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static inline uint32_t wavelet_index_level_size(uint32_t words_num);
+static void wavelet_index_set_pointers(WaveletIndex_t *index, const void *blob);
+static inline uint32_t wavelet_index_rank1(const WaveletIndex_t *index, uint32_t level, uint32_t pos);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief	Returns size of index blob for data_size samples in bytes.
+ */
+uint32_t wavelet_index_get_blob_size(uint32_t data_size)
+{
+	uint32_t words_num = (data_size + 63) / 64;
+
+	return sizeof(WaveletIndexHeader_t) + WAVELET_INDEX_LEVELS * wavelet_index_level_size(words_num);
+}
+
+
+/**
+ * @brief 	Builds index into blob
+ *
+ * @param	index		-	index handle
+ * @param	data		-	indexed data
+ * @param	data_size	-	data length, up to WAVELET_INDEX_MAX_DATA_SIZE
+ * @param	blob		-	index storage, 8 bytes aligned
+ * @param	blob_size	-	storage size. Must be at least wavelet_index_get_blob_size(data_size).
+ *
+ * @return	Filter status
+ */
+FilterStatus_t wavelet_index_build(WaveletIndex_t *index, const int16_t *data, uint32_t data_size,
+		void *blob, uint32_t blob_size)
+{
+	if(data_size > WAVELET_INDEX_MAX_DATA_SIZE || blob_size < wavelet_index_get_blob_size(data_size)
+			|| ((uintptr_t)blob & 7) != 0)
+	{
+		return FilterError;
+	}
+
+	uint16_t *keys = _malloc(data_size * sizeof *keys + 1);
+	uint16_t *partitioned = _malloc(data_size * sizeof *partitioned + 1);
+
+	if(keys == NULL || partitioned == NULL)
+	{
+		_free(keys);
+		_free(partitioned);
+		return FilterError;
+	}
+
+	for(uint32_t i=0; i<data_size; i++)
+	{
+		keys[i] = (uint16_t)data[i] ^ 0x8000u;
+	}
+
+	WaveletIndexHeader_t *header = blob;
+
+	header->magic = WAVELET_INDEX_MAGIC;
+	header->version = WAVELET_INDEX_VERSION;
+	header->levels = WAVELET_INDEX_LEVELS;
+	header->data_size = data_size;
+	header->words_num = (data_size + 63) / 64;
+
+	wavelet_index_set_pointers(index, blob);
+
+	for(uint32_t level=0; level<WAVELET_INDEX_LEVELS; level++)
+	{
+		const uint32_t bit = WAVELET_INDEX_LEVELS - 1 - level;
+
+		uint64_t *bits = (uint64_t*)index->bits[level];
+		uint32_t *ranks = (uint32_t*)index->ranks[level];
+
+		memset(bits, 0, header->words_num * sizeof *bits);
+
+		uint32_t zeros = 0;
+		for(uint32_t i=0; i<data_size; i++)
+		{
+			bits[i / 64] |= (uint64_t)((keys[i] >> bit) & 1u) << (i % 64);
+			zeros += ((keys[i] >> bit) & 1u) ^ 1u;
+		}
+
+		ranks[0] = 0;
+		for(uint32_t w=0; w<header->words_num; w++)
+		{
+			ranks[w+1] = ranks[w] + __builtin_popcountll(bits[w]);
+		}
+
+		header->zeros[level] = zeros;
+
+		/* Stable partition, zeros first */
+		uint32_t zeros_pos = 0;
+		uint32_t ones_pos = zeros;
+
+		for(uint32_t i=0; i<data_size; i++)
+		{
+			if((keys[i] >> bit) & 1u)
+			{
+				partitioned[ones_pos++] = keys[i];
+			}
+			else
+			{
+				partitioned[zeros_pos++] = keys[i];
+			}
+		}
+
+		uint16_t *tmp = keys;
+		keys = partitioned;
+		partitioned = tmp;
+	}
+
+	_free(keys);
+	_free(partitioned);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief 	Attaches index to existing blob, i.e. memory mapped file.
+ *
+ * @param	index		-	index handle
+ * @param	blob		-	blob built by wavelet_index_build(...), 8 bytes aligned
+ * @param	blob_size	-	blob size
+ *
+ * @return	Filter status
+ */
+FilterStatus_t wavelet_index_attach(WaveletIndex_t *index, const void *blob, uint32_t blob_size)
+{
+	const WaveletIndexHeader_t *header = blob;
+
+	if(blob_size < sizeof *header || ((uintptr_t)blob & 7) != 0)
+	{
+		return FilterError;
+	}
+
+	if(header->magic != WAVELET_INDEX_MAGIC || header->version != WAVELET_INDEX_VERSION
+			|| header->levels != WAVELET_INDEX_LEVELS || header->data_size > WAVELET_INDEX_MAX_DATA_SIZE
+			|| header->words_num != (header->data_size + 63) / 64
+			|| blob_size < wavelet_index_get_blob_size(header->data_size))
+	{
+		return FilterError;
+	}
+
+	wavelet_index_set_pointers(index, blob);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Returns k-th smallest sample of data[begin .. end)
+ *
+ * @param[in]   index   -   index handle
+ * @param[in]   begin   -   the first sample of range
+ * @param[in]   end     -   sample after the last one of range
+ * @param[in]   k       -   rank, 0 is minimum. Must be less than range length.
+ * @param[out]  y       -   found sample
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t wavelet_index_range_quantile(const WaveletIndex_t *index, uint32_t begin, uint32_t end,
+		uint32_t k, int16_t *y)
+{
+	if(begin >= end || end > index->header->data_size || k >= end - begin)
+	{
+		return FilterError;
+	}
+
+	uint32_t key = 0;
+
+	for(uint32_t level=0; level<WAVELET_INDEX_LEVELS; level++)
+	{
+		uint32_t ones_begin = wavelet_index_rank1(index, level, begin);
+		uint32_t ones_end = wavelet_index_rank1(index, level, end);
+		uint32_t zeros_in_range = (end - begin) - (ones_end - ones_begin);
+
+		if(k < zeros_in_range)
+		{
+			begin -= ones_begin;
+			end -= ones_end;
+		}
+		else
+		{
+			k -= zeros_in_range;
+			key |= 1u << (WAVELET_INDEX_LEVELS - 1 - level);
+
+			begin = index->header->zeros[level] + ones_begin;
+			end = index->header->zeros[level] + ones_end;
+		}
+	}
+
+	*y = (int16_t)(key ^ 0x8000u);
+
+	return FilterOK;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Level is words_num bitvector words and words_num + 1 cumulative counts padded to 8 bytes.
+ */
+static inline uint32_t wavelet_index_level_size(uint32_t words_num)
+{
+	return words_num * sizeof(uint64_t) + (((words_num + 1) * sizeof(uint32_t) + 7) & ~7u);
+}
+
+
+static void wavelet_index_set_pointers(WaveletIndex_t *index, const void *blob)
+{
+	const WaveletIndexHeader_t *header = blob;
+	const uint8_t *level_ptr = (const uint8_t*)blob + sizeof *header;
+	const uint32_t level_size = wavelet_index_level_size(header->words_num);
+
+	index->header = header;
+
+	for(uint32_t level=0; level<WAVELET_INDEX_LEVELS; level++)
+	{
+		index->bits[level] = (const uint64_t*)level_ptr;
+		index->ranks[level] = (const uint32_t*)(level_ptr + header->words_num * sizeof(uint64_t));
+
+		level_ptr += level_size;
+	}
+}
+
+
+/**
+ * @brief	Returns number of ones of level before position pos.
+ */
+static inline uint32_t wavelet_index_rank1(const WaveletIndex_t *index, uint32_t level, uint32_t pos)
+{
+	uint32_t word = pos / 64;
+	uint32_t offset = pos % 64;
+	uint32_t rank = index->ranks[level][word];
+
+	if(offset != 0)
+	{
+		rank += __builtin_popcountll(index->bits[level][word] & ((1ull << offset) - 1));
+	}
+
+	return rank;
+}
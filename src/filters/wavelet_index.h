@@ -0,0 +1,66 @@
+/*
+ * wavelet_index.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_WAVELET_INDEX_H_
+#define SRC_MOD_FILTERS_WAVELET_INDEX_H_
+
+#include "filter.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define WAVELET_INDEX_MAGIC     0x58494D57u     /* "WMIX" */
+#define WAVELET_INDEX_VERSION   1
+#define WAVELET_INDEX_LEVELS    16
+
+/**
+ * Keeps blob size within 32 bits
+ */
+#define WAVELET_INDEX_MAX_DATA_SIZE     (1u << 30)
+
+
+/**
+ * Blob header. Levels follow it, every level is a bitvector of 64 bit words and
+ * cumulative number of ones before every word.
+ */
+typedef struct wavelet_index_header {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	levels;
+	uint32_t	data_size;
+	uint32_t	words_num;
+
+	/* Number of zero bits of every level */
+	uint32_t	zeros[WAVELET_INDEX_LEVELS];
+} WaveletIndexHeader_t;
+
+
+typedef struct wavelet_index {
+
+	const WaveletIndexHeader_t	*header;
+
+	const uint64_t	*bits[WAVELET_INDEX_LEVELS];
+	const uint32_t	*ranks[WAVELET_INDEX_LEVELS];
+
+} WaveletIndex_t;
+
+
+uint32_t        wavelet_index_get_blob_size(uint32_t data_size);
+FilterStatus_t  wavelet_index_build(WaveletIndex_t *index, const int16_t *data, uint32_t data_size,
+        void *blob, uint32_t blob_size);
+FilterStatus_t  wavelet_index_attach(WaveletIndex_t *index, const void *blob, uint32_t blob_size);
+FilterStatus_t  wavelet_index_range_quantile(const WaveletIndex_t *index, uint32_t begin, uint32_t end,
+        uint32_t k, int16_t *y);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_WAVELET_INDEX_H_ */
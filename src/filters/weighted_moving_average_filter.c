@@ -0,0 +1,453 @@
+/*
+ * weighted_moving_average_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *
+ *  USAGE:
+ *      1. Call weighted_moving_avg_init(...) on your filter handle
+ *      2. Call weighted_moving_avg_fill_buffer(...) when you collected enough samples(equal to window size)
+ *              to compute the first sample.
+ *      3. Call weighted_moving_avg_filter_sample(...) on each new sample.
+ *
+ *      If you need to reset filter i.e. pause:
+ *          4.1 Call weighted_moving_avg_flush(...)
+ *
+ *      After that you have to fill buffer again with:
+ *          4.2 weighted_moving_avg_fill_buffer(...) before sampling.
+ *
+ *  Instead of 2 and 3 you can feed blocks of samples with weighted_moving_avg_filter_block(...).
+ *  It collects the first window itself and outputs one sample per input sample after that.
+ *
+ *  You can also filter prepared sequence with weighted_moving_avg_filter_sequence(...).
+ *
+ *   Algorithm:
+ *      Linearly weighted average. The oldest sample has weight 1 and the newest one has weight N.
+ *      1. Keeps plain sum S and weighted sum W of the window.
+ *      2. On each sample: W += N * x_new - S, then S += x_new - x_old.
+ *      3. Returns W divided by N * (N + 1) / 2. In case of HighPass filter returns the new sample
+ *              minus low pass sample.
+ *      4. Block path reads samples leaving the window from FIFO in chunks of WEIGHTED_MOVING_AVG_CHUNK,
+ *              takes the rest of them from the block itself and writes the newest window_size samples back.
+ *      5. Block and sequence kernel runs both sums over a chunk first and stores W, then divides the chunk
+ *              in a separate loop. Outputs do not depend on each other, so that loop is vectorized. Division
+ *              is an exact biased multiplication by 1 / norm in double, see weighted_moving_avg_quotient.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "weighted_moving_average_filter.h"
+#include "filter_stats.h"
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static FilterStatus_t weighted_moving_avg_compute_first_output(WeightedMovingAverageFilter_t *filter, int16_t *y);
+static void weighted_moving_avg_kernel(const int16_t *old_x, const int16_t *new_x, uint32_t len,
+		uint16_t window_size, FilterType_t ftype, filter_acc_t *sum, int64_t *weighted_sum, int16_t *y);
+static inline void weighted_moving_avg_divide(const double *weighted, const int16_t *current, uint32_t len,
+		double norm_inv, FilterType_t ftype, int16_t *y);
+static inline int16_t weighted_moving_avg_quotient(double weighted_sum, double norm_inv);
+static inline int16_t weighted_moving_avg_output(int16_t current_sample, int64_t weighted_sum, int64_t norm,
+		FilterType_t ftype);
+
+
+/**************************** PUBLIC API ****************************/
+
+/**
+ * @brief 	Initializes weighted moving average filter
+ * @param	filter		-	filter handle
+ * @param	ftype		-	low pass or high pass
+ * @param	buffer		-	buffer which contains data.
+ * @param   window_size -   window size. Buffer length must match window size
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t weighted_moving_avg_init(WeightedMovingAverageFilter_t *filter, FilterType_t ftype,
+		int16_t *buffer, uint16_t window_size)
+{
+	if(window_size == 0)
+	{
+		return FilterError;
+	}
+
+	filter->type = ftype;
+	filter->window_size = window_size;
+
+	filter->sum = 0;
+	filter->weighted_sum = 0;
+	filter->initialized = 0;
+
+	FIFO_init(&filter->fifo, (uint8_t*)buffer, window_size, sizeof(*buffer), FIFO_LOOP);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief       Fill buffer with initial samples.
+ *
+ * @param[in]   filter  -   pointer to filter handle
+ * @param[in]   data    -   pointer to data to copy. Length of data must be the same as filter window size.
+ * @param[out]  y       -   pointer where computed sample will be stored.
+ *
+ * @return      Filter  error status
+ */
+FilterStatus_t weighted_moving_avg_fill_buffer(WeightedMovingAverageFilter_t *filter, int16_t *data, int16_t *y)
+{
+    if(filter->initialized)
+    {
+        return FilterError;
+    }
+
+    if(FILTER_STATS_FIFO(FIFO_write(&filter->fifo, data, filter->window_size, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    return weighted_moving_avg_compute_first_output(filter, y);
+}
+
+
+/**
+ * @brief	Produces one output sample.
+ *
+ * @param[in]	    filter	-	filter handle
+ * @param[in]       new_sample  -   new raw sample.
+ * @param[out]  	y	-	variable where sample will be saved.
+ *
+ * @return  Filter error status
+ */
+FilterStatus_t weighted_moving_avg_filter_sample(WeightedMovingAverageFilter_t *filter, int16_t new_sample,
+		int16_t *y)
+{
+    FIFO_t *fifo_ptr = &filter->fifo;
+    int16_t last_x;
+
+    if(!filter->initialized)
+    {
+        return FilterError;
+    }
+
+    if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, &last_x, 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &new_sample, 1, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    weighted_moving_avg_kernel(&last_x, &new_sample, 1, filter->window_size, filter->type,
+            &filter->sum, &filter->weighted_sum, y);
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief       Filters block of samples keeping filter state between calls.
+ * @note        Filter does not need to be filled with weighted_moving_avg_fill_buffer. While the first window
+ *                  is not collected input samples produce no output.
+ *
+ * @param[in]   filter      -   filter handle
+ * @param[in]   data        -   new raw samples
+ * @param[in]   data_len    -   number of new samples
+ * @param[out]  y           -   buffer for filtered samples. Must hold data_len samples.
+ * @param[out]  y_len       -   number of produced samples.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t weighted_moving_avg_filter_block(WeightedMovingAverageFilter_t *filter, int16_t *data,
+		uint16_t data_len, int16_t *y, uint16_t *y_len)
+{
+    FIFO_t *fifo_ptr = &filter->fifo;
+    uint16_t produced = 0;
+    uint16_t i = 0;
+
+    /* Collect the first window */
+    while(i < data_len && !filter->initialized)
+    {
+        if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &data[i++], 1, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        if(FIFO_get_data_count(fifo_ptr) == filter->window_size)
+        {
+            if(weighted_moving_avg_compute_first_output(filter, &y[produced++]) != FilterOK)
+            {
+                return FilterError;
+            }
+        }
+    }
+
+    if(i == data_len)
+    {
+        *y_len = produced;
+        return FilterOK;
+    }
+
+    /* Samples leaving the window are in FIFO for the first window_size new samples, then in data itself */
+    const uint16_t window_size = filter->window_size;
+    const uint16_t from_fifo = (data_len - i < window_size) ? data_len - i : window_size;
+    const uint16_t tail = data_len - from_fifo;
+    int16_t expiring[WEIGHTED_MOVING_AVG_CHUNK];
+
+    for(uint16_t done=0; done<from_fifo; )
+    {
+        uint16_t len = (from_fifo - done < WEIGHTED_MOVING_AVG_CHUNK) ? from_fifo - done : WEIGHTED_MOVING_AVG_CHUNK;
+
+        if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, expiring, len, NULL)) != FIFO_OK)
+        {
+            return FilterError;
+        }
+
+        weighted_moving_avg_kernel(expiring, &data[i], len, window_size, filter->type,
+                &filter->sum, &filter->weighted_sum, &y[produced]);
+
+        i += len;
+        done += len;
+        produced += len;
+    }
+
+    weighted_moving_avg_kernel(&data[i - window_size], &data[i], data_len - i, window_size, filter->type,
+            &filter->sum, &filter->weighted_sum, &y[produced]);
+    produced += data_len - i;
+
+    /* The newest samples replace the ones read above */
+    if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, &data[tail], from_fifo, NULL)) != FIFO_OK)
+    {
+        return FilterError;
+    }
+
+    *y_len = produced;
+
+    return FilterOK;
+}
+
+
+/**
+ * @brief	Produces filtered sequence from simple buffer
+ *
+ * @param[in]	data	    -	data to be filtered
+ * @param[in]   data_size   -   data length
+ * @param[in]   window_size -   window size
+ * @param[out]	y	        -	buffer to save filtered data into.
+ * @param[out]	y_data_len	- 	output sequence length. You can predict it with
+ * 									weighted_moving_avg_get_output_data_len.
+ *
+ * @return      Filter error status
+ */
+FilterStatus_t weighted_moving_avg_filter_sequence(int16_t *data, uint16_t data_size,
+        uint16_t window_size, int16_t *y, uint16_t *y_data_len)
+{
+    if(window_size == 0 || window_size > data_size)
+    {
+        return FilterError;
+    }
+
+    uint32_t filtered_len = filter_windowed_get_expected_output_len(data_size, window_size);
+    const int64_t n = window_size;
+
+    filter_acc_t sum = 0;
+    int64_t weighted_sum = 0;
+
+    /* Computing the first output item */
+    for(uint32_t i=0; i<window_size; i++)
+    {
+        sum += (filter_acc_t)data[i];
+        weighted_sum += (int64_t)(i + 1) * data[i];
+    }
+
+    y[0] = weighted_moving_avg_output(data[window_size-1], weighted_sum, n * (n + 1) / 2, FilterLowPass);
+
+    /* Recursive part */
+    weighted_moving_avg_kernel(data, data + window_size, filtered_len - 1, window_size, FilterLowPass,
+            &sum, &weighted_sum, y + 1);
+
+    *y_data_len = filtered_len;
+
+    return FilterOK;
+}
+
+
+FilterStatus_t weighted_moving_avg_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len)
+{
+    if(window_size > data_size)
+    {
+        return FilterError;
+    }
+
+	*y_len = filter_windowed_get_expected_output_len(data_size, window_size);
+
+	return FilterOK;
+}
+
+
+void weighted_moving_avg_flush(WeightedMovingAverageFilter_t *filter)
+{
+    FIFO_flush(&filter->fifo);
+    filter->initialized = 0;
+}
+
+
+
+/**************************** PRIVATE API ****************************/
+
+/**
+ * @brief	Computes both sums from collected window and the first output sample.
+ * @param	filter	-	filter handle
+ * @param	y		-	variable where sample will be saved.
+ * @return	Filter error status
+ */
+static FilterStatus_t weighted_moving_avg_compute_first_output(WeightedMovingAverageFilter_t *filter, int16_t *y)
+{
+	FIFO_t *fifo_ptr = &filter->fifo;
+	uint16_t window_size = filter->window_size;
+	const int64_t n = window_size;
+
+	filter_acc_t sum = 0;
+	int64_t weighted_sum = 0;
+
+	int16_t buf[window_size];
+	if(FILTER_STATS_FIFO(FIFO_read(fifo_ptr, buf, window_size, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	/**
+	 * Write the same data again for future usage
+	 */
+	if(FILTER_STATS_FIFO(FIFO_write(fifo_ptr, buf, window_size, NULL)) != FIFO_OK)
+	{
+	    return FilterError;
+	}
+
+	for(uint32_t i=0; i<window_size; i++)
+	{
+		sum += (filter_acc_t)buf[i];
+		weighted_sum += (int64_t)(i + 1) * buf[i];
+	}
+
+	filter->sum = sum;
+	filter->weighted_sum = weighted_sum;
+	filter->initialized = 1;
+
+	*y = weighted_moving_avg_output(buf[window_size-1], weighted_sum, n * (n + 1) / 2, filter->type);
+
+	return FilterOK;
+}
+
+
+/**
+ * @brief	Slides window over len samples.
+ * @note	Sums are updated serially and W is stored per chunk as double, then outputs of the chunk are computed
+ * 				independently of each other in vectorizable loops.
+ *
+ * @param	old_x			-	samples leaving the window
+ * @param	new_x			-	samples entering the window
+ * @param	len				-	number of samples
+ * @param	window_size		-	window size
+ * @param	ftype			-	filter type
+ * @param	sum				-	plain sum of the window. Updated.
+ * @param	weighted_sum	-	weighted sum of the window. Updated.
+ * @param	y				-	output samples
+ */
+static void weighted_moving_avg_kernel(const int16_t *old_x, const int16_t *new_x, uint32_t len,
+		uint16_t window_size, FilterType_t ftype, filter_acc_t *sum, int64_t *weighted_sum, int16_t *y)
+{
+	const int64_t n = window_size;
+	const double norm_inv = 1.0 / (double)(n * (n + 1) / 2);
+
+	filter_acc_t s = *sum;
+	int64_t ws = *weighted_sum;
+	double weighted[WEIGHTED_MOVING_AVG_CHUNK];
+	int16_t current[WEIGHTED_MOVING_AVG_CHUNK];
+
+	for(uint32_t begin=0; begin<len; begin+=WEIGHTED_MOVING_AVG_CHUNK)
+	{
+		const uint32_t chunk = (len - begin < WEIGHTED_MOVING_AVG_CHUNK) ? len - begin : WEIGHTED_MOVING_AVG_CHUNK;
+		const int16_t *chunk_old = old_x + begin;
+		const int16_t *chunk_new = new_x + begin;
+
+		for(uint32_t i=0; i<chunk; i++)
+		{
+			/* Every sample in the window loses one weight unit, the new one gets N */
+			ws += n * chunk_new[i] - s;
+			s += (filter_acc_t)chunk_new[i] - (filter_acc_t)chunk_old[i];
+
+			weighted[i] = (double)ws;
+			current[i] = chunk_new[i];
+		}
+
+		/* Full chunks get a fixed trip count, which is what compiler needs to vectorize at -O2 */
+		if(chunk == WEIGHTED_MOVING_AVG_CHUNK)
+		{
+			weighted_moving_avg_divide(weighted, current, WEIGHTED_MOVING_AVG_CHUNK, norm_inv, ftype, y + begin);
+		}
+		else
+		{
+			weighted_moving_avg_divide(weighted, current, chunk, norm_inv, ftype, y + begin);
+		}
+	}
+
+	*sum = s;
+	*weighted_sum = ws;
+}
+
+
+/**
+ * @brief	Computes outputs from stored weighted sums.
+ *
+ * @param	weighted	-	weighted sums
+ * @param	current		-	samples entered the window with each weighted sum
+ * @param	len			-	number of outputs
+ * @param	norm_inv	-	1 / (N * (N + 1) / 2)
+ * @param	ftype		-	filter type
+ * @param	y			-	output samples
+ */
+static inline void weighted_moving_avg_divide(const double *weighted, const int16_t *current, uint32_t len,
+		double norm_inv, FilterType_t ftype, int16_t *y)
+{
+	for(uint32_t i=0; i<len; i++)
+	{
+		y[i] = weighted_moving_avg_quotient(weighted[i], norm_inv);
+	}
+
+	if(ftype == FilterHighPass)
+	{
+		for(uint32_t i=0; i<len; i++)
+		{
+			y[i] = current[i] - y[i];
+		}
+	}
+}
+
+
+/**
+ * @brief	Returns weighted_sum / norm rounded toward zero without 64 bit integer division.
+ * @note	Exact for N < 65536: |weighted_sum| < 2^47 is exact in double and norm < 2^31, so the product is
+ * 				within 2^-36 of the true quotient, while a fractional quotient is at least 1 / norm > 2^-31
+ * 				away from an integer. Bias of 2^-34 away from zero keeps integer quotients from truncating down.
+ */
+static inline int16_t weighted_moving_avg_quotient(double weighted_sum, double norm_inv)
+{
+	return (int16_t)(weighted_sum * norm_inv + copysign(0x1p-34, weighted_sum));
+}
+
+
+static inline int16_t weighted_moving_avg_output(int16_t current_sample, int64_t weighted_sum, int64_t norm,
+		FilterType_t ftype)
+{
+	int16_t sample = weighted_sum / norm;
+
+	if(ftype == FilterHighPass)
+	{
+		sample = current_sample - sample;
+	}
+
+	return sample;
+}
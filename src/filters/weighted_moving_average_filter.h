@@ -0,0 +1,56 @@
+/*
+ * weighted_moving_average_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SRC_MOD_FILTERS_WEIGHTED_MOVING_AVERAGE_FILTER_H_
+#define SRC_MOD_FILTERS_WEIGHTED_MOVING_AVERAGE_FILTER_H_
+
+#include "filter.h"
+#include "fifo/FIFO.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Samples leaving the window read from FIFO at once by weighted_moving_avg_filter_block and outputs
+ * computed per vectorized pass of the kernel
+ */
+#define WEIGHTED_MOVING_AVG_CHUNK	256
+
+
+typedef struct weighted_moving_average_filter {
+
+	uint16_t 			window_size;
+	filter_acc_t		sum;
+	int64_t				weighted_sum;
+	uint8_t				initialized;
+
+	FilterType_t		type;
+	FIFO_t              fifo;
+
+} WeightedMovingAverageFilter_t;
+
+
+FilterStatus_t  weighted_moving_avg_init(WeightedMovingAverageFilter_t *filter, FilterType_t ftype,
+        int16_t *buffer, uint16_t window_size);
+FilterStatus_t  weighted_moving_avg_fill_buffer(WeightedMovingAverageFilter_t *filter, int16_t *data, int16_t *y);
+FilterStatus_t  weighted_moving_avg_filter_sample(WeightedMovingAverageFilter_t *filter, int16_t new_sample,
+        int16_t *y);
+FilterStatus_t  weighted_moving_avg_filter_block(WeightedMovingAverageFilter_t *filter, int16_t *data,
+        uint16_t data_len, int16_t *y, uint16_t *y_len);
+FilterStatus_t  weighted_moving_avg_filter_sequence(int16_t *data, uint16_t data_size,
+        uint16_t window_size, int16_t *y, uint16_t *y_data_len);
+FilterStatus_t  weighted_moving_avg_get_output_data_len(uint16_t data_size, uint16_t window_size, uint16_t *y_len);
+void            weighted_moving_avg_flush(WeightedMovingAverageFilter_t *filter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_MOD_FILTERS_WEIGHTED_MOVING_AVERAGE_FILTER_H_ */
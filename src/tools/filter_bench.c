@@ -0,0 +1,532 @@
+/*
+ * filter_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Performance gate for filter hot paths.
+ *
+ *  USAGE:
+ *      filter_bench [-c cpu] [-r repetitions] [-t tolerance] [-T p99_tolerance] [-o results.json] [-b baseline.json]
+ *
+ *      Runs the fixed set of microbenchmarks below on the same pseudo random input and reports median
+ *      and 99th percentile of ns/sample over all repetitions as JSON (to stdout if -o is not given).
+ *
+ *          -c cpu          -   CPU to pin to, the current one by default
+ *          -r repetitions  -   timed repetitions of every benchmark, 201 by default
+ *          -t tolerance    -   allowed median slowdown against baseline in percents, 10 by default
+ *          -T tolerance    -   allowed p99 slowdown against baseline in percents, 30 by default
+ *          -b baseline     -   baseline JSON written earlier with -o
+ *
+ *      With baseline every benchmark present in it is tracked. Exit status is 2 if any tracked benchmark
+ *      regressed, 1 on errors and 0 otherwise. Benchmarks missing from baseline are reported as untracked.
+ *
+ *      Baseline is machine specific. After intended performance change or on a new machine regenerate it:
+ *          filter_bench -o src/tools/filter_bench_baseline.json
+ *
+ *  Every repetition initializes filter, fills its buffer and filters BENCH_INPUT_LEN samples, so all
+ *  repetitions do the same work. Input fits L1 cache and BENCH_WARMUP_REPS untimed repetitions run
+ *  before timing to warm caches and branch predictors.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../filters/filter.h"
+#include "../filters/fifo/FIFO.h"
+#include "../filters/moving_average_filter.h"
+#include "../filters/rank_filter.h"
+#include "../filters/hampel_filter.h"
+
+
+#define BENCH_INPUT_LEN         4096
+#define BENCH_MAX_WINDOW        64
+#define BENCH_WARMUP_REPS       20
+#define BENCH_DEFAULT_REPS      201
+#define BENCH_MAX_REPS          10001
+#define BENCH_SEED              0x2545F491u
+
+
+typedef int (*BenchFunc_t)(const int16_t *input, uint16_t len, int16_t *output);
+
+
+typedef struct bench {
+    const char      *name;
+    BenchFunc_t     func;
+} Bench_t;
+
+
+typedef struct bench_result {
+    double          median;
+    double          p99;
+
+    /* Baseline values, negative if benchmark is untracked */
+    double          base_median;
+    double          base_p99;
+} BenchResult_t;
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static int bench_fifo_write_read(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_moving_avg_sample_w16(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_moving_avg_block_w64(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_rank_sample(const int16_t *input, uint16_t len, int16_t *output, uint16_t window_size);
+static int bench_rank_sample_w5(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_rank_sample_w63(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_rank_sequence_w9(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_hampel_sample_w15(const int16_t *input, uint16_t len, int16_t *output);
+static int bench_run(const Bench_t *bench, const int16_t *input, uint32_t reps, double *samples,
+        BenchResult_t *result);
+static int bench_pin_cpu(int cpu);
+static char *bench_read_file(const char *path);
+static int bench_baseline_lookup(const char *baseline, const char *name, double *median, double *p99);
+static void bench_write_json(FILE *out, const BenchResult_t *results);
+static int cmp_double(const void *pdata1, const void *pdata2);
+static void usage(void);
+
+
+static const Bench_t benches[] = {
+    {"fifo_write_read",         bench_fifo_write_read},
+    {"moving_avg_sample_w16",   bench_moving_avg_sample_w16},
+    {"moving_avg_block_w64",    bench_moving_avg_block_w64},
+    {"rank_sample_w5",          bench_rank_sample_w5},
+    {"rank_sample_w63",         bench_rank_sample_w63},
+    {"rank_sequence_w9",        bench_rank_sequence_w9},
+    {"hampel_sample_w15",       bench_hampel_sample_w15},
+};
+
+#define BENCH_NUM       (sizeof benches / sizeof benches[0])
+
+
+
+int main(int argc, char **argv)
+{
+    const char *output_path = NULL;
+    const char *baseline_path = NULL;
+    int cpu = sched_getcpu();
+    uint32_t reps = BENCH_DEFAULT_REPS;
+    double tolerance = 10.0;
+    double p99_tolerance = 30.0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "c:r:t:T:o:b:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'c':   cpu = atoi(optarg);                         break;
+        case 'r':   reps = strtoul(optarg, NULL, 0);            break;
+        case 't':   tolerance = strtod(optarg, NULL);           break;
+        case 'T':   p99_tolerance = strtod(optarg, NULL);       break;
+        case 'o':   output_path = optarg;                       break;
+        case 'b':   baseline_path = optarg;                     break;
+        default:    usage();                                    return 1;
+        }
+    }
+
+    if(optind != argc || reps == 0 || reps > BENCH_MAX_REPS || tolerance < 0 || p99_tolerance < 0)
+    {
+        usage();
+        return 1;
+    }
+
+    if(bench_pin_cpu(cpu) != 0)
+    {
+        fprintf(stderr, "Can not pin to CPU %d: %s\n", cpu, strerror(errno));
+        return 1;
+    }
+
+    char *baseline = NULL;
+    if(baseline_path != NULL && (baseline = bench_read_file(baseline_path)) == NULL)
+    {
+        fprintf(stderr, "Can not read %s: %s\n", baseline_path, strerror(errno));
+        return 1;
+    }
+
+    /* Deterministic input, the same for every benchmark and every run */
+    static int16_t input[BENCH_INPUT_LEN];
+    uint32_t state = BENCH_SEED;
+
+    for(uint32_t i=0; i<BENCH_INPUT_LEN; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        input[i] = (int16_t)(state >> 16);
+    }
+
+    static double samples[BENCH_MAX_REPS];
+    BenchResult_t results[BENCH_NUM];
+    int regressed = 0;
+
+    for(uint32_t b=0; b<BENCH_NUM; b++)
+    {
+        BenchResult_t *result = &results[b];
+
+        if(bench_run(&benches[b], input, reps, samples, result) != 0)
+        {
+            fprintf(stderr, "Benchmark %s failed\n", benches[b].name);
+            return 1;
+        }
+
+        if(baseline == NULL || bench_baseline_lookup(baseline, benches[b].name,
+                &result->base_median, &result->base_p99) != 0)
+        {
+            result->base_median = -1;
+            result->base_p99 = -1;
+
+            if(baseline != NULL)
+            {
+                fprintf(stderr, "%-24s untracked\n", benches[b].name);
+            }
+
+            continue;
+        }
+
+        int slow = result->median > result->base_median * (1.0 + tolerance / 100.0);
+        int slow_tail = result->p99 > result->base_p99 * (1.0 + p99_tolerance / 100.0);
+
+        fprintf(stderr, "%-24s median %8.2f (base %8.2f)  p99 %8.2f (base %8.2f)  %s\n", benches[b].name,
+                result->median, result->base_median, result->p99, result->base_p99,
+                (slow || slow_tail) ? "REGRESSED" : "ok");
+
+        regressed |= slow || slow_tail;
+    }
+
+    free(baseline);
+
+    FILE *out = stdout;
+    if(output_path != NULL && (out = fopen(output_path, "w")) == NULL)
+    {
+        fprintf(stderr, "Can not open %s: %s\n", output_path, strerror(errno));
+        return 1;
+    }
+
+    bench_write_json(out, results);
+
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+
+    return regressed ? 2 : 0;
+}
+
+
+
+/**
+ * @brief       One item in, one item out of a looped FIFO the way filters use it.
+ */
+static int bench_fifo_write_read(const int16_t *input, uint16_t len, int16_t *output)
+{
+    int16_t buffer[BENCH_MAX_WINDOW];
+    FIFO_t fifo;
+
+    FIFO_init(&fifo, (uint8_t*)buffer, BENCH_MAX_WINDOW, sizeof *buffer, FIFO_LOOP);
+
+    if(FIFO_write(&fifo, (void*)input, BENCH_MAX_WINDOW, NULL) != FIFO_OK)
+    {
+        return -1;
+    }
+
+    for(uint16_t i=BENCH_MAX_WINDOW; i<len; i++)
+    {
+        int16_t sample = input[i];
+
+        if(FIFO_read(&fifo, &output[i], 1, NULL) != FIFO_OK || FIFO_write(&fifo, &sample, 1, NULL) != FIFO_OK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+static int bench_moving_avg_sample_w16(const int16_t *input, uint16_t len, int16_t *output)
+{
+    const uint16_t window_size = 16;
+
+    int16_t buffer[window_size];
+    MovingAverageFilter_t filter;
+
+    if(moving_avg_init(&filter, FilterLowPass, buffer, window_size) != FilterOK
+            || moving_avg_fill_buffer(&filter, (int16_t*)input, &output[0]) != FilterOK)
+    {
+        return -1;
+    }
+
+    for(uint16_t i=window_size; i<len; i++)
+    {
+        if(moving_avg_filter_sample(&filter, input[i], &output[i]) != FilterOK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+static int bench_moving_avg_block_w64(const int16_t *input, uint16_t len, int16_t *output)
+{
+    const uint16_t window_size = 64;
+
+    int16_t buffer[window_size];
+    MovingAverageFilter_t filter;
+    uint16_t y_len;
+
+    if(moving_avg_init(&filter, FilterLowPass, buffer, window_size) != FilterOK)
+    {
+        return -1;
+    }
+
+    return (moving_avg_filter_block(&filter, (int16_t*)input, len, output, &y_len) == FilterOK) ? 0 : -1;
+}
+
+
+static int bench_rank_sample(const int16_t *input, uint16_t len, int16_t *output, uint16_t window_size)
+{
+    int16_t buffer[window_size];
+    RankFilter_t filter;
+
+    if(rank_filter_init(&filter, buffer, window_size, window_size / 2) != FilterOK
+            || rank_filter_fill_buffer(&filter, (int16_t*)input, &output[0]) != FilterOK)
+    {
+        return -1;
+    }
+
+    for(uint16_t i=window_size; i<len; i++)
+    {
+        if(rank_filter_filter_sample(&filter, input[i], &output[i]) != FilterOK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+static int bench_rank_sample_w5(const int16_t *input, uint16_t len, int16_t *output)
+{
+    return bench_rank_sample(input, len, output, 5);
+}
+
+
+static int bench_rank_sample_w63(const int16_t *input, uint16_t len, int16_t *output)
+{
+    return bench_rank_sample(input, len, output, 63);
+}
+
+
+static int bench_rank_sequence_w9(const int16_t *input, uint16_t len, int16_t *output)
+{
+    uint16_t y_len;
+
+    return (rank_filter_filter_sequence((int16_t*)input, len, 9, 4, output, &y_len) == FilterOK) ? 0 : -1;
+}
+
+
+static int bench_hampel_sample_w15(const int16_t *input, uint16_t len, int16_t *output)
+{
+    const uint16_t window_size = 15;
+
+    int16_t buffer[window_size];
+    HampelFilter_t filter;
+
+    if(hampel_init(&filter, buffer, window_size, HAMPEL_DEFAULT_THRESHOLD_Q8) != FilterOK
+            || hampel_fill_buffer(&filter, (int16_t*)input, &output[0], NULL) != FilterOK)
+    {
+        return -1;
+    }
+
+    for(uint16_t i=window_size; i<len; i++)
+    {
+        if(hampel_filter_sample(&filter, input[i], &output[i], NULL) != FilterOK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief       Runs warm up and timed repetitions of benchmark.
+ *
+ * @param[in]   bench   -   benchmark
+ * @param[in]   input   -   BENCH_INPUT_LEN input samples
+ * @param[in]   reps    -   number of timed repetitions
+ * @param[out]  samples -   scratch for ns/sample of every repetition
+ * @param[out]  result  -   median and p99 ns/sample
+ *
+ * @return      0 on success
+ */
+static int bench_run(const Bench_t *bench, const int16_t *input, uint32_t reps, double *samples,
+        BenchResult_t *result)
+{
+    static int16_t output[BENCH_INPUT_LEN];
+
+    for(uint32_t r=0; r<BENCH_WARMUP_REPS; r++)
+    {
+        if(bench->func(input, BENCH_INPUT_LEN, output) != 0)
+        {
+            return -1;
+        }
+    }
+
+    for(uint32_t r=0; r<reps; r++)
+    {
+        struct timespec start, stop;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        if(bench->func(input, BENCH_INPUT_LEN, output) != 0)
+        {
+            return -1;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        samples[r] = ((stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec)) / BENCH_INPUT_LEN;
+    }
+
+    qsort(samples, reps, sizeof *samples, cmp_double);
+
+    result->median = samples[reps / 2];
+    result->p99 = samples[(reps * 99 + 99) / 100 - 1];
+
+    return 0;
+}
+
+
+static int bench_pin_cpu(int cpu)
+{
+    cpu_set_t set;
+
+    if(cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return sched_setaffinity(0, sizeof set, &set);
+}
+
+
+/**
+ * @brief       Reads the whole file into zero terminated string.
+ * @return      String to be freed or NULL on error
+ */
+static char *bench_read_file(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        return NULL;
+    }
+
+    char *data = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    for(;;)
+    {
+        if(capacity - size < 4096)
+        {
+            capacity = capacity * 2 + 4096;
+
+            char *grown = realloc(data, capacity);
+            if(grown == NULL)
+            {
+                free(data);
+                fclose(file);
+                return NULL;
+            }
+
+            data = grown;
+        }
+
+        size_t read = fread(data + size, 1, capacity - size - 1, file);
+        size += read;
+
+        if(read == 0)
+        {
+            break;
+        }
+    }
+
+    fclose(file);
+    data[size] = '\0';
+
+    return data;
+}
+
+
+/**
+ * @brief       Finds benchmark entry in baseline JSON written by bench_write_json.
+ * @return      0 if benchmark is found
+ */
+static int bench_baseline_lookup(const char *baseline, const char *name, double *median, double *p99)
+{
+    char key[128];
+    snprintf(key, sizeof key, "\"name\": \"%s\"", name);
+
+    const char *entry = strstr(baseline, key);
+    if(entry == NULL)
+    {
+        return -1;
+    }
+
+    const char *end = strchr(entry, '}');
+    const char *pmedian = strstr(entry, "\"median\":");
+    const char *pp99 = strstr(entry, "\"p99\":");
+
+    if(end == NULL || pmedian == NULL || pp99 == NULL || pmedian > end || pp99 > end)
+    {
+        return -1;
+    }
+
+    *median = strtod(pmedian + strlen("\"median\":"), NULL);
+    *p99 = strtod(pp99 + strlen("\"p99\":"), NULL);
+
+    return (*median > 0 && *p99 > 0) ? 0 : -1;
+}
+
+
+static void bench_write_json(FILE *out, const BenchResult_t *results)
+{
+    fprintf(out, "{\n    \"unit\": \"ns/sample\",\n    \"input_len\": %u,\n    \"benchmarks\": [\n", BENCH_INPUT_LEN);
+
+    for(uint32_t b=0; b<BENCH_NUM; b++)
+    {
+        fprintf(out, "        {\"name\": \"%s\", \"median\": %.3f, \"p99\": %.3f}%s\n", benches[b].name,
+                results[b].median, results[b].p99, (b + 1 < BENCH_NUM) ? "," : "");
+    }
+
+    fprintf(out, "    ]\n}\n");
+}
+
+
+static int cmp_double(const void *pdata1, const void *pdata2)
+{
+    double a = *(const double*)pdata1;
+    double b = *(const double*)pdata2;
+
+    return (a > b) - (a < b);
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: filter_bench [-c cpu] [-r repetitions] [-t tolerance] [-T p99_tolerance] "
+            "[-o results.json] [-b baseline.json]\n");
+}
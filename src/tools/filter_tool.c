@@ -0,0 +1,529 @@
+/*
+ * filter_tool.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Streaming filtering of raw captures.
+ *
+ *  USAGE:
+ *      filter_tool [-c channels] [-b block_frames] -i input.raw -o output.raw stage [stage ...]
+ *
+ *      Input is raw native endian int16 samples, channels are interleaved.
+ *      Stages are applied to every channel in given order:
+ *          avg:W       -   moving average low pass with window W
+ *          hp:W        -   moving average high pass with window W
+ *          rank:W:R    -   rank filter with window W and rank R
+ *
+ *      Every stage drops W-1 first frames, output is interleaved the same way as input.
+ *
+ *  Input is memory mapped by fixed size regions which are released after processing, so memory usage
+ *  does not depend on file size. Every channel has its own filter pipeline which processes
+ *  de-interleaved blocks of FILTER_PIPELINE_BLOCK_SIZE frames. Output is written by a separate thread
+ *  from two swapped buffers.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../filters/filter.h"
+#include "../filters/moving_average_filter.h"
+#include "../filters/rank_filter.h"
+#include "../filters/filter_pipeline.h"
+
+
+#define TOOL_MAX_STAGES         FILTER_PIPELINE_MAX_STAGES
+#define TOOL_MAX_CHANNELS       256
+#define TOOL_DEFAULT_BLOCK      65536
+#define TOOL_MAP_REGION_SIZE    (64u << 20)
+
+
+typedef enum {StageMovingAverage, StageRank} StageKind_t;
+
+
+typedef struct tool_stage_config {
+    StageKind_t     kind;
+    FilterType_t    ftype;
+    uint16_t        window_size;
+    uint16_t        rank;
+} StageConfig_t;
+
+
+typedef struct tool_stage {
+    MovingAverageFilter_t   average;
+    RankFilter_t            rank_filter;
+
+    int16_t                 *buffer;
+} Stage_t;
+
+
+typedef struct tool_channel {
+    FilterPipeline_t        pipeline;
+    Stage_t                 stages[TOOL_MAX_STAGES];
+} Channel_t;
+
+
+typedef struct tool_writer {
+    int             fd;
+    int16_t         *buffers[2];
+    size_t          lens[2];
+    int             pending;
+    int             busy;
+    int             stop;
+    int             error;
+
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+} Writer_t;
+
+
+/****** STATIC FUNCTION PROTOTYPES ********/
+static int parse_stage(const char *arg, StageConfig_t *config);
+static int channel_init(Channel_t *channel, const StageConfig_t *configs, uint32_t stages_num);
+static int writer_start(Writer_t *writer, int fd, size_t buffer_items);
+static int16_t *writer_swap(Writer_t *writer, int16_t *full, size_t len);
+static int writer_stop(Writer_t *writer, int16_t *last, size_t len);
+static void *writer_thread(void *arg);
+static void usage(void);
+
+
+
+int main(int argc, char **argv)
+{
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    uint32_t channels = 1;
+    uint32_t block_frames = TOOL_DEFAULT_BLOCK;
+
+    StageConfig_t configs[TOOL_MAX_STAGES];
+    uint32_t stages_num = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "c:b:i:o:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'c':   channels = strtoul(optarg, NULL, 0);        break;
+        case 'b':   block_frames = strtoul(optarg, NULL, 0);    break;
+        case 'i':   input_path = optarg;                        break;
+        case 'o':   output_path = optarg;                       break;
+        default:    usage();                                    return 1;
+        }
+    }
+
+    for(int i=optind; i<argc; i++)
+    {
+        if(stages_num == TOOL_MAX_STAGES || parse_stage(argv[i], &configs[stages_num]) != 0)
+        {
+            fprintf(stderr, "Bad stage: %s\n", argv[i]);
+            return 1;
+        }
+
+        stages_num++;
+    }
+
+    if(input_path == NULL || output_path == NULL || stages_num == 0
+            || channels == 0 || channels > TOOL_MAX_CHANNELS || block_frames == 0)
+    {
+        usage();
+        return 1;
+    }
+
+    if(block_frames < FILTER_PIPELINE_BLOCK_SIZE)
+    {
+        block_frames = FILTER_PIPELINE_BLOCK_SIZE;
+    }
+
+    Channel_t *channels_state = calloc(channels, sizeof *channels_state);
+    if(channels_state == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for(uint32_t ch=0; ch<channels; ch++)
+    {
+        if(channel_init(&channels_state[ch], configs, stages_num) != 0)
+        {
+            fprintf(stderr, "Can not initialize channel %u\n", ch);
+            return 1;
+        }
+    }
+
+    int in_fd = open(input_path, O_RDONLY);
+    if(in_fd < 0)
+    {
+        fprintf(stderr, "Can not open %s: %s\n", input_path, strerror(errno));
+        return 1;
+    }
+
+    int out_fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(out_fd < 0)
+    {
+        fprintf(stderr, "Can not open %s: %s\n", output_path, strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    if(fstat(in_fd, &st) != 0)
+    {
+        fprintf(stderr, "Can not stat %s: %s\n", input_path, strerror(errno));
+        return 1;
+    }
+
+    size_t frame_bytes = channels * sizeof(int16_t);
+    size_t block_items = (size_t)block_frames * channels;
+    uint64_t frames_total = (uint64_t)st.st_size / frame_bytes;
+
+    Writer_t writer;
+    if(writer_start(&writer, out_fd, block_items) != 0)
+    {
+        fprintf(stderr, "Can not start writer\n");
+        return 1;
+    }
+
+    int16_t *out = writer.buffers[0];
+    size_t out_len = 0;
+
+    /**
+     * Map region size is a multiple of both page and frame sizes
+     */
+    uint64_t region_unit = (uint64_t)sysconf(_SC_PAGESIZE) * frame_bytes;
+    uint64_t region_size = (TOOL_MAP_REGION_SIZE / region_unit + 1) * region_unit;
+    uint64_t offset = 0;
+    uint64_t data_size = frames_total * frame_bytes;
+
+    while(offset < data_size)
+    {
+        size_t map_len = (data_size - offset < region_size) ? (size_t)(data_size - offset) : (size_t)region_size;
+
+        int16_t *region = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, in_fd, (off_t)offset);
+        if(region == MAP_FAILED)
+        {
+            fprintf(stderr, "mmap failed: %s\n", strerror(errno));
+            return 1;
+        }
+
+        madvise(region, map_len, MADV_SEQUENTIAL);
+
+        size_t region_frames = map_len / frame_bytes;
+
+        for(size_t frame=0; frame<region_frames; frame+=FILTER_PIPELINE_BLOCK_SIZE)
+        {
+            int16_t channel_in[FILTER_PIPELINE_BLOCK_SIZE];
+            int16_t channel_out[FILTER_PIPELINE_BLOCK_SIZE];
+
+            const int16_t *in = region + frame*channels;
+            uint32_t frames = (region_frames - frame < FILTER_PIPELINE_BLOCK_SIZE) ?
+                    region_frames - frame : FILTER_PIPELINE_BLOCK_SIZE;
+
+            if(out_len + frames*channels > block_items)
+            {
+                out = writer_swap(&writer, out, out_len);
+                out_len = 0;
+
+                if(out == NULL)
+                {
+                    fprintf(stderr, "Write failed\n");
+                    return 1;
+                }
+            }
+
+            /* All channels have the same delay so they produce the same number of frames */
+            uint32_t produced = 0;
+
+            for(uint32_t ch=0; ch<channels; ch++)
+            {
+                for(uint32_t i=0; i<frames; i++)
+                {
+                    channel_in[i] = in[i*channels + ch];
+                }
+
+                if(filter_pipeline_filter_block(&channels_state[ch].pipeline, channel_in, frames,
+                        channel_out, &produced) != FilterOK)
+                {
+                    fprintf(stderr, "Filtering failed\n");
+                    return 1;
+                }
+
+                for(uint32_t i=0; i<produced; i++)
+                {
+                    out[out_len + i*channels + ch] = channel_out[i];
+                }
+            }
+
+            out_len += produced*channels;
+        }
+
+        munmap(region, map_len);
+        offset += map_len;
+    }
+
+    if(writer_stop(&writer, out, out_len) != 0)
+    {
+        fprintf(stderr, "Write failed\n");
+        return 1;
+    }
+
+    close(in_fd);
+    close(out_fd);
+
+    return 0;
+}
+
+
+
+/**
+ * @brief       Parses stage description.
+ * @return      0 on success
+ */
+static int parse_stage(const char *arg, StageConfig_t *config)
+{
+    unsigned int window_size, rank;
+
+    if(sscanf(arg, "avg:%u", &window_size) == 1)
+    {
+        config->kind = StageMovingAverage;
+        config->ftype = FilterLowPass;
+        config->rank = 0;
+    }
+    else if(sscanf(arg, "hp:%u", &window_size) == 1)
+    {
+        config->kind = StageMovingAverage;
+        config->ftype = FilterHighPass;
+        config->rank = 0;
+    }
+    else if(sscanf(arg, "rank:%u:%u", &window_size, &rank) == 2)
+    {
+        config->kind = StageRank;
+        config->ftype = FilterLowPass;
+
+        if(rank >= window_size)
+        {
+            return -1;
+        }
+
+        config->rank = rank;
+    }
+    else
+    {
+        return -1;
+    }
+
+    if(window_size == 0 || window_size > UINT16_MAX)
+    {
+        return -1;
+    }
+
+    config->window_size = window_size;
+    return 0;
+}
+
+
+/**
+ * @brief       Initializes filters of channel and chains them into pipeline.
+ * @return      0 on success
+ */
+static int channel_init(Channel_t *channel, const StageConfig_t *configs, uint32_t stages_num)
+{
+    FilterStatus_t status;
+
+    filter_pipeline_init(&channel->pipeline);
+
+    for(uint32_t s=0; s<stages_num; s++)
+    {
+        const StageConfig_t *config = &configs[s];
+        Stage_t *stage = &channel->stages[s];
+
+        stage->buffer = malloc(config->window_size * sizeof *stage->buffer);
+        if(stage->buffer == NULL)
+        {
+            return -1;
+        }
+
+        if(config->kind == StageMovingAverage)
+        {
+            status = moving_avg_init(&stage->average, config->ftype, stage->buffer, config->window_size);
+
+            if(status == FilterOK)
+            {
+                status = filter_pipeline_add_moving_avg(&channel->pipeline, &stage->average);
+            }
+        }
+        else
+        {
+            status = rank_filter_init(&stage->rank_filter, stage->buffer, config->window_size, config->rank);
+
+            if(status == FilterOK)
+            {
+                status = filter_pipeline_add_rank(&channel->pipeline, &stage->rank_filter);
+            }
+        }
+
+        if(status != FilterOK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief       Allocates two output buffers and starts writer thread.
+ * @return      0 on success
+ */
+static int writer_start(Writer_t *writer, int fd, size_t buffer_items)
+{
+    writer->fd = fd;
+    writer->pending = -1;
+    writer->busy = 0;
+    writer->stop = 0;
+    writer->error = 0;
+
+    for(int i=0; i<2; i++)
+    {
+        writer->buffers[i] = malloc(buffer_items * sizeof(int16_t));
+        writer->lens[i] = 0;
+
+        if(writer->buffers[i] == NULL)
+        {
+            return -1;
+        }
+    }
+
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+
+    return pthread_create(&writer->thread, NULL, writer_thread, writer);
+}
+
+
+/**
+ * @brief       Hands full buffer to writer thread.
+ * @return      Buffer to be filled next or NULL on write error.
+ */
+static int16_t *writer_swap(Writer_t *writer, int16_t *full, size_t len)
+{
+    int idx = (full == writer->buffers[0]) ? 0 : 1;
+
+    pthread_mutex_lock(&writer->lock);
+
+    /* Wait until the other buffer is written */
+    while(writer->pending != -1 || writer->busy)
+    {
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+
+    writer->lens[idx] = len;
+    writer->pending = idx;
+
+    int error = writer->error;
+
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+
+    return error ? NULL : writer->buffers[idx ^ 1];
+}
+
+
+/**
+ * @brief       Writes the last buffer and stops writer thread.
+ * @return      0 on success
+ */
+static int writer_stop(Writer_t *writer, int16_t *last, size_t len)
+{
+    if(len != 0 && writer_swap(writer, last, len) == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    writer->stop = 1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+
+    pthread_join(writer->thread, NULL);
+
+    free(writer->buffers[0]);
+    free(writer->buffers[1]);
+
+    return writer->error ? -1 : 0;
+}
+
+
+static void *writer_thread(void *arg)
+{
+    Writer_t *writer = arg;
+
+    pthread_mutex_lock(&writer->lock);
+
+    for(;;)
+    {
+        while(writer->pending == -1 && !writer->stop)
+        {
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+
+        if(writer->pending == -1)
+        {
+            break;
+        }
+
+        int idx = writer->pending;
+        writer->pending = -1;
+        writer->busy = 1;
+        pthread_mutex_unlock(&writer->lock);
+
+        const uint8_t *data = (const uint8_t*)writer->buffers[idx];
+        size_t left = writer->lens[idx] * sizeof(int16_t);
+        int error = 0;
+
+        while(left != 0)
+        {
+            ssize_t written = write(writer->fd, data, left);
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+
+                error = 1;
+                break;
+            }
+
+            data += written;
+            left -= written;
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        writer->busy = 0;
+        writer->error |= error;
+        pthread_cond_broadcast(&writer->cond);
+    }
+
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: filter_tool [-c channels] [-b block_frames] -i input.raw -o output.raw stage [stage ...]\n"
+            "Stages:\n"
+            "    avg:W       moving average low pass\n"
+            "    hp:W        moving average high pass\n"
+            "    rank:W:R    rank filter\n");
+}